@@ -35,6 +35,12 @@ namespace {
         "-O3"
     };
 
+    // Release build with debug and trace logging compiled out
+    std::vector<std::string> final_cflags {
+        "-O3",
+        "-DLOG_DISABLE_DEBUG"
+    };
+
     std::vector<std::string> debug_cflags {
         "-O0",
         "-ggdb"
@@ -79,6 +85,9 @@ namespace {
         case gorc::build_type::release:
             return release_cflags;
 
+        case gorc::build_type::final:
+            return final_cflags;
+
         case gorc::build_type::debug:
             return debug_cflags;
 
@@ -6,6 +6,7 @@ namespace {
 
     std::unordered_map<std::string, gorc::build_type> bt_map {
         { "release", gorc::build_type::release },
+        { "final", gorc::build_type::final },
         { "debug", gorc::build_type::debug },
         { "coverage", gorc::build_type::coverage }
     };
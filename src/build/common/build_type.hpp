@@ -6,6 +6,7 @@ namespace gorc {
 
     enum class build_type {
         release,
+        final,
         debug,
         coverage
     };
@@ -30,6 +30,17 @@ void gorc::client::application::startup(event_bus& eventbus, content_manager& co
 
     register_verbs();
 
+    components.fused_cog_tier = !no_fused_cog_tier;
+    components.compiler.set_precompile_threads(cog_compile_threads);
+    if(!cog_cache_directory.empty()) {
+        components.script_cache = std::make_unique<cog::script_cache>(cog_cache_directory);
+        components.compiler.set_cache(components.script_cache.get());
+    }
+    components.profile_cogs = profile_cogs;
+    if(worker_threads != 1) {
+        components.workers = std::make_unique<worker_pool>(worker_threads);
+    }
+
     views.set_layer(view_layer::clear_screen, clear_view);
 
     // HACK: Set current episode to The Force Within.
@@ -78,6 +89,11 @@ void gorc::client::application::create_options(options &opts)
 {
     opts.insert(make_value_option("episode", input_episodename));
     opts.insert(make_value_option("level", input_levelname));
+    opts.insert(make_switch_option("no-fused-cog-tier", no_fused_cog_tier));
+    opts.insert(make_value_option("cog-compile-threads", cog_compile_threads, size_t(0)));
+    opts.insert(make_value_option("cog-cache", cog_cache_directory));
+    opts.insert(make_switch_option("profile-cogs", profile_cogs));
+    opts.insert(make_value_option("worker-threads", worker_threads, size_t(1)));
 
     opts.emplace_constraint<required_option>(std::vector<std::string>{ "episode", "level" });
     return;
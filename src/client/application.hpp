@@ -34,6 +34,11 @@ private:
 public:
     std::string input_episodename;
     std::string input_levelname;
+    bool no_fused_cog_tier = false;
+    size_t cog_compile_threads = 0;
+    std::string cog_cache_directory;
+    bool profile_cogs = false;
+    size_t worker_threads = 1;
 
     jk_virtual_file_system& virtual_filesystem;
 
@@ -2,11 +2,14 @@
 
 #include "utility/service_registry.hpp"
 #include "jk/cog/compiler/compiler.hpp"
+#include "jk/cog/compiler/script_cache.hpp"
 #include "jk/cog/script/constant_table.hpp"
 #include "jk/cog/script/verb_table.hpp"
+#include "jk/cog/vm/profiler.hpp"
 #include "libold/content/master_colormap.hpp"
 #include "content/loader_registry.hpp"
 #include "ecs/component_registry.hpp"
+#include "utility/worker_pool.hpp"
 #include <memory>
 
 namespace gorc {
@@ -22,8 +25,20 @@ public:
     component_registry<thing_id> components;
     cog::constant_table constants;
     cog::verb_table verbs;
+
+    // Reported when the level presenter is destroyed, so declared before it
+    bool profile_cogs = false;
+    cog::profiler cog_profiler;
+
+    // Shared by the level's aspects. Null when the level is updated on one thread.
+    std::unique_ptr<worker_pool> workers;
+
     std::unique_ptr<gorc::game::world::level_presenter> current_level_presenter;
     cog::compiler compiler;
+
+    // Null unless compiled scripts are cached on disk
+    std::unique_ptr<cog::script_cache> script_cache;
+    bool fused_cog_tier = true;
     content::master_colormap colormap;
 
     level_state(service_registry const &parent_services);
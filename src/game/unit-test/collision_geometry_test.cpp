@@ -0,0 +1,176 @@
+#include "test/test.hpp"
+#include "mock_level.hpp"
+#include "game/world/physics/collision_geometry.hpp"
+#include "game/world/physics/query.hpp"
+
+using namespace gorc;
+using namespace gorc::game::world::physics;
+
+namespace {
+
+    // Grid points, including points on sector faces and edges.
+    std::vector<vector<3>> make_points()
+    {
+        std::vector<vector<3>> points;
+        for(int x = -1; x <= 9; ++x) {
+            for(int y = -1; y <= 5; ++y) {
+                for(int z = -1; z <= 5; ++z) {
+                    points.push_back(make_vector(static_cast<float>(x) * 0.5f,
+                                                 static_cast<float>(y) * 0.5f,
+                                                 static_cast<float>(z) * 0.5f));
+                }
+            }
+        }
+
+        return points;
+    }
+
+    std::vector<segment> make_segments()
+    {
+        auto points = make_points();
+        auto center = make_vector(1.0f, 1.0f, 1.0f);
+
+        std::vector<segment> segments;
+        for(size_t i = 0; i < points.size(); ++i) {
+            segments.emplace_back(center, points[i]);
+            segments.emplace_back(points[i], points[(i * 7 + 3) % points.size()]);
+        }
+
+        return segments;
+    }
+
+    void push_contact(std::vector<float> &out, maybe<vector<3>> const &contact)
+    {
+        out.push_back(contact.has_value() ? 1.0f : 0.0f);
+        maybe_if(contact, [&](vector<3> const &p) {
+                out.push_back(get<0>(p));
+                out.push_back(get<1>(p));
+                out.push_back(get<2>(p));
+            });
+    }
+
+    // The packed query may skip surfaces farther than max_dist, so only contacts within
+    // max_dist are compared.
+    maybe<vector<3>> within(vector<3> const &origin, float max_dist, maybe<vector<3>> const &contact)
+    {
+        return maybe_if_else(contact, [&](vector<3> const &p) -> maybe<vector<3>> {
+                if(length(p - origin) <= max_dist) {
+                    return p;
+                }
+
+                return nothing;
+            },
+            [] { return maybe<vector<3>>(); });
+    }
+
+    class collision_geometry_fixture : public test::fixture {
+    public:
+        mock_level level;
+        collision_geometry geometry;
+
+        collision_geometry_fixture()
+            : level(2, 2.0f)
+            , geometry(level)
+        {
+            return;
+        }
+    };
+
+}
+
+begin_suite_fixture(collision_geometry_test, collision_geometry_fixture);
+
+test_case(point_inside_surface_matches_query)
+{
+    std::vector<bool> expected, actual;
+    for(auto const &point : make_points()) {
+        for(size_t i = 0; i < level.surfaces.size(); ++i) {
+            expected.push_back(point_inside_surface(point, level, level.surfaces[i]));
+            actual.push_back(geometry.point_inside_surface(static_cast<int>(i), point));
+        }
+    }
+
+    assert_eq(actual, expected);
+}
+
+test_case(closest_point_matches_query)
+{
+    std::vector<float> expected, actual;
+    for(auto const &point : make_points()) {
+        for(size_t i = 0; i < level.surfaces.size(); ++i) {
+            push_contact(expected, within(point, 0.75f,
+                    bounded_closest_point_on_surface(point, level, level.surfaces[i], 0.75f)));
+            push_contact(actual, within(point, 0.75f,
+                    geometry.bounded_closest_point_on_surface(static_cast<int>(i), point, 0.75f)));
+        }
+    }
+
+    assert_eq(actual, expected);
+}
+
+test_case(segment_intersection_matches_query)
+{
+    std::vector<float> expected, actual;
+    for(auto const &seg : make_segments()) {
+        for(size_t i = 0; i < level.surfaces.size(); ++i) {
+            push_contact(expected, segment_surface_intersection_point(seg, level, level.surfaces[i]));
+            push_contact(actual, geometry.segment_surface_intersection_point(static_cast<int>(i), seg));
+        }
+    }
+
+    assert_eq(actual, expected);
+}
+
+test_case(batched_intersections_match_single)
+{
+    auto segments = make_segments();
+
+    segment_batch batch;
+    for(auto const &seg : segments) {
+        batch.push_back(seg);
+    }
+
+    std::vector<float> u;
+    std::vector<float> expected, actual;
+    for(size_t i = 0; i < level.surfaces.size(); ++i) {
+        geometry.segment_surface_intersections(static_cast<int>(i), batch, u);
+        assert_eq(u.size(), segments.size());
+
+        for(size_t k = 0; k < segments.size(); ++k) {
+            push_contact(expected, geometry.segment_surface_intersection_point(static_cast<int>(i), segments[k]));
+
+            maybe<vector<3>> batched;
+            if(u[k] >= 0.0f) {
+                batched = lerp(std::get<0>(segments[k]), std::get<1>(segments[k]), u[k]);
+            }
+
+            push_contact(actual, batched);
+        }
+    }
+
+    assert_eq(actual, expected);
+}
+
+test_case(surface_without_vertices)
+{
+    level.surfaces.emplace_back();
+    level.surfaces.back().normal = make_vector(0.0f, 0.0f, 1.0f);
+    collision_geometry degenerate_geometry(level);
+    int surface = static_cast<int>(level.surfaces.size() - 1);
+
+    auto seg = segment(make_vector(1.0f, 1.0f, 1.0f), make_vector(1.0f, 1.0f, -1.0f));
+    segment_batch batch;
+    batch.push_back(seg);
+    std::vector<float> u;
+    degenerate_geometry.segment_surface_intersections(surface, batch, u);
+
+    assert_true(!degenerate_geometry.point_inside_surface(surface, make_vector(1.0f, 1.0f, 0.0f)));
+    assert_true(!degenerate_geometry.bounded_closest_point_on_surface(surface, make_vector(1.0f, 1.0f, 0.1f), 1.0f).has_value());
+    assert_true(!degenerate_geometry.segment_surface_intersection(surface, seg));
+    assert_true(u[0] < 0.0f);
+
+    // Other surfaces still collide.
+    assert_true(degenerate_geometry.segment_surface_intersection(0, seg));
+}
+
+end_suite(collision_geometry_test);
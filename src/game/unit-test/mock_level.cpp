@@ -0,0 +1,88 @@
+#include "mock_level.hpp"
+
+using namespace gorc;
+
+namespace {
+
+    // Corners are numbered x + 2y + 4z. Faces wind counterclockwise seen from inside.
+    int const face_corners[6][4] = {
+        { 0, 1, 3, 2 },
+        { 4, 6, 7, 5 },
+        { 0, 2, 6, 4 },
+        { 1, 5, 7, 3 },
+        { 0, 4, 5, 1 },
+        { 2, 3, 7, 6 }
+    };
+
+    float const face_normals[6][3] = {
+        { 0.0f, 0.0f, 1.0f },
+        { 0.0f, 0.0f, -1.0f },
+        { 1.0f, 0.0f, 0.0f },
+        { -1.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f },
+        { 0.0f, -1.0f, 0.0f }
+    };
+
+    size_t const low_x_face = 2;
+    size_t const high_x_face = 3;
+
+}
+
+mock_level::mock_level(size_t sector_count, float sector_size)
+{
+    for(size_t i = 0; i < sector_count; ++i) {
+        auto first_vertex = vertices.size();
+        auto v0 = make_vector(static_cast<float>(i) * sector_size, 0.0f, 0.0f);
+        auto v1 = v0 + make_vector(sector_size, sector_size, sector_size);
+        for(int c = 0; c < 8; ++c) {
+            vertices.push_back(make_vector((c & 1) ? get<0>(v1) : get<0>(v0),
+                                           (c & 2) ? get<1>(v1) : get<1>(v0),
+                                           (c & 4) ? get<2>(v1) : get<2>(v0)));
+        }
+
+        sectors.emplace_back();
+        auto &sector = sectors.back();
+        sector.number = sector_id(static_cast<int>(i));
+        sector.first_surface = static_cast<int>(surfaces.size());
+        sector.surface_count = 6;
+        sector.bounding_box = make_box(v0, v1);
+        sector.collide_box = make_box(v0, v1);
+        sector.center = (v0 + v1) / 2.0f;
+        sector.radius = length(v1 - v0) / 2.0f;
+        for(size_t c = 0; c < 8; ++c) {
+            sector.vertices.push_back(first_vertex + c);
+        }
+
+        for(size_t f = 0; f < 6; ++f) {
+            surfaces.emplace_back();
+            auto &surface = surfaces.back();
+            surface.adjoin = -1;
+            surface.adjoined_sector = invalid_id;
+            surface.normal = make_vector(face_normals[f][0], face_normals[f][1], face_normals[f][2]);
+            for(auto c : face_corners[f]) {
+                surface.vertices.emplace_back(static_cast<int>(first_vertex) + c, 0, 0.0f);
+            }
+        }
+    }
+
+    for(size_t i = 0; i + 1 < sector_count; ++i) {
+        int high_adjoin = static_cast<int>(adjoins.size());
+        int low_adjoin = high_adjoin + 1;
+
+        auto &high_surface = surfaces[i * 6 + high_x_face];
+        high_surface.adjoin = high_adjoin;
+        high_surface.adjoined_sector = sector_id(static_cast<int>(i + 1));
+
+        auto &low_surface = surfaces[(i + 1) * 6 + low_x_face];
+        low_surface.adjoin = low_adjoin;
+        low_surface.adjoined_sector = sector_id(static_cast<int>(i));
+
+        for(int mirror : { low_adjoin, high_adjoin }) {
+            adjoins.emplace_back();
+            adjoins.back().flags = flag_set<flags::adjoin_flag> { flags::adjoin_flag::Visible,
+                                                                  flags::adjoin_flag::AllowMovement };
+            adjoins.back().mirror = mirror;
+            adjoins.back().distance = 0.0f;
+        }
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "libold/content/assets/level.hpp"
+
+// Row of cube sectors along the x axis. Neighbouring sectors are joined by adjoins which
+// allow movement.
+class mock_level : public gorc::content::assets::level {
+public:
+    mock_level(size_t sector_count, float sector_size);
+};
@@ -0,0 +1,441 @@
+#include "test/test.hpp"
+#include "mock_level.hpp"
+#include "game/level_state.hpp"
+#include "game/world/level_place.hpp"
+#include "game/world/level_presenter.hpp"
+#include "game/world/level_model.hpp"
+#include "game/world/physics/physics_presenter.hpp"
+#include "game/world/components/thing.hpp"
+#include "game/world/components/character.hpp"
+#include "game/world/aspects/character_controller_aspect.hpp"
+#include "game/world/events/landed.hpp"
+#include "jk/content/inventory_loader.hpp"
+#include "content/loader_registry.hpp"
+#include "vfs/virtual_file_system.hpp"
+#include "io/memory_file.hpp"
+#include "log/diagnostic_context.hpp"
+#include "utility/worker_pool.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+
+using namespace gorc;
+using namespace gorc::game;
+using namespace gorc::game::world;
+
+namespace {
+
+    class mock_vfs : public virtual_file_system {
+    private:
+        memory_file items_mf;
+
+    public:
+        mock_vfs()
+        {
+            std::string items = "end\n";
+            items_mf.write(items.data(), items.size());
+        }
+
+        virtual std::unique_ptr<input_stream> open(path const &p) const override
+        {
+            if(p == "items.dat") {
+                return std::make_unique<memory_file::reader>(items_mf);
+            }
+
+            LOG_FATAL(format("could not open %s") % p.generic_string());
+        }
+
+        virtual std::tuple<path, std::unique_ptr<input_stream>>
+            find(path const &p, std::vector<path> const &) const override
+        {
+            return std::make_tuple(p, open(p));
+        }
+    };
+
+    // Level presenter over a mock level, with only physics started.
+    class physics_scene {
+    public:
+        level_state components;
+        std::shared_ptr<content_manager> content;
+        level_place place;
+        level_presenter presenter;
+
+        physics_scene(service_registry const &services, mock_level const &level, event_bus &bus,
+                      maybe<worker_pool*> workers)
+            : components(services)
+            , content(std::make_shared<content_manager>(components.services))
+            , place(content, asset_ref<content::assets::level>(level, asset_id(0)))
+            , presenter(components, place)
+        {
+            presenter.model = std::make_unique<level_model>(*content, components.services, place.level);
+            presenter.physics_presenter->start(*presenter.model, bus);
+            presenter.physics_presenter->set_worker_pool(workers);
+        }
+
+        thing_id add_thing(int sector, vector<3> const &position, vector<3> const &vel, bool gravity)
+        {
+            auto tid = presenter.model->ecs.emplace_entity();
+            add_thing(tid, sector, position, vel, gravity);
+            return tid;
+        }
+
+        // Adds a thing component to an existing entity.
+        void add_thing(thing_id tid, int sector, vector<3> const &position, vector<3> const &vel, bool gravity)
+        {
+            auto &model = *presenter.model;
+            model.ecs.emplace_component<components::thing>(tid);
+            auto &thing = model.get_thing(tid);
+            thing.type = flags::thing_type::Player;
+            thing.collide = flags::collide_type::sphere;
+            thing.move = flags::move_type::physics;
+            thing.size = 0.1f;
+            thing.move_size = 0.1f;
+            thing.sector = sector_id(sector);
+            thing.position = position;
+            thing.vel = vel;
+            if(gravity) {
+                thing.physics_flags = flag_set<flags::physics_flag> { flags::physics_flag::has_gravity };
+            }
+        }
+
+        void update(uint32_t frame)
+        {
+            presenter.physics_presenter->update(gorc::time(timestamp((frame + 1) * 50), timestamp(frame * 50)));
+        }
+    };
+
+    void push_contact(std::vector<float> &out, maybe<physics::contact> const &contact)
+    {
+        out.push_back(contact.has_value() ? 1.0f : 0.0f);
+        maybe_if(contact, [&](physics::contact const &c) {
+                out.push_back(get<0>(c.position));
+                out.push_back(get<1>(c.position));
+                out.push_back(get<2>(c.position));
+                out.push_back(static_cast<float>(static_cast<int>(maybe_value(c.contact_surface_id, surface_id(invalid_id)))));
+                out.push_back(static_cast<float>(static_cast<int>(maybe_value(c.contact_thing_id, thing_id(invalid_id)))));
+            });
+    }
+
+    class physics_presenter_fixture : public test::fixture {
+    public:
+        mock_vfs vfs;
+        loader_registry loaders;
+        event_bus bus;
+        service_registry services;
+        mock_level level;
+
+        physics_presenter_fixture()
+            : level(4, 2.0f)
+        {
+            loaders.emplace_loader<inventory_loader>();
+
+            services.add<virtual_file_system>(vfs);
+            services.add(loaders);
+            services.add(bus);
+        }
+
+        // Returns the position and sector of each thing after every update.
+        std::vector<float> run_scene(maybe<worker_pool*> workers)
+        {
+            physics_scene scene(services, level, bus, workers);
+
+            // Crosses from sector 0 into sector 1.
+            scene.add_thing(0, make_vector(1.0f, 1.0f, 1.0f), make_vector(2.0f, 0.5f, 0.0f), false);
+
+            // Falls to the floor of sector 2.
+            scene.add_thing(2, make_vector(5.0f, 1.0f, 1.0f), make_vector(0.0f, 0.25f, 0.0f), true);
+
+            // Collide with each other in sector 3.
+            scene.add_thing(3, make_vector(6.5f, 1.0f, 1.0f), make_vector(1.0f, 0.0f, 0.0f), false);
+            scene.add_thing(3, make_vector(7.5f, 1.0f, 1.0f), make_vector(-1.0f, 0.0f, 0.0f), false);
+
+            std::vector<float> results;
+            for(uint32_t i = 0; i < 20; ++i) {
+                scene.update(i);
+
+                for(auto const &thing : scene.presenter.model->ecs.all_components<components::thing>()) {
+                    results.push_back(get<0>(thing.second->position));
+                    results.push_back(get<1>(thing.second->position));
+                    results.push_back(get<2>(thing.second->position));
+                    results.push_back(static_cast<float>(static_cast<int>(thing.second->sector)));
+                }
+            }
+
+            return results;
+        }
+
+        // Returns the position of each thing, in id order, after every update. Thing components
+        // are emplaced in id order, or in reverse.
+        std::vector<float> run_emplace_order_scene(bool reverse)
+        {
+            physics_scene scene(services, level, bus, nothing);
+            auto &model = *scene.presenter.model;
+
+            std::vector<thing_id> things;
+            for(int i = 0; i < 3; ++i) {
+                things.push_back(model.ecs.emplace_entity());
+            }
+
+            std::vector<size_t> order { 0, 1, 2 };
+            if(reverse) {
+                std::reverse(order.begin(), order.end());
+            }
+
+            for(auto i : order) {
+                switch(i) {
+                case 0:
+                    // Collide with each other in sector 3.
+                    scene.add_thing(things[i], 3, make_vector(6.6f, 1.0f, 1.0f), make_vector(1.5f, 0.0f, 0.0f), false);
+                    break;
+
+                case 1:
+                    scene.add_thing(things[i], 3, make_vector(7.0f, 1.1f, 1.0f), make_vector(-0.5f, 0.2f, 0.0f), false);
+                    break;
+
+                default:
+                    // Crosses from sector 0 into sector 1.
+                    scene.add_thing(things[i], 0, make_vector(1.0f, 1.0f, 1.0f), make_vector(2.0f, 0.5f, 0.0f), false);
+                    break;
+                }
+            }
+
+            std::vector<float> results;
+            for(uint32_t i = 0; i < 20; ++i) {
+                scene.update(i);
+
+                for(auto tid : things) {
+                    auto const &thing = model.get_thing(tid);
+                    results.push_back(get<0>(thing.position));
+                    results.push_back(get<1>(thing.position));
+                    results.push_back(get<2>(thing.position));
+                }
+            }
+
+            return results;
+        }
+
+        // Returns the position and sector of each thing after every update. A cog linked to
+        // sector 1 sends the thing which enters it back to sector 0, and moves a bystander in
+        // sector 3 whose group is solved on the pool.
+        std::vector<float> run_linked_scene(maybe<worker_pool*> workers, int &reset_count)
+        {
+            physics_scene scene(services, level, bus, workers);
+            auto &model = *scene.presenter.model;
+
+            auto crossing = scene.add_thing(0, make_vector(1.0f, 1.0f, 1.0f), make_vector(2.0f, 0.5f, 0.0f), false);
+            auto bystander = scene.add_thing(3, make_vector(7.0f, 1.0f, 1.0f), make_vector(0.0f, 0.0f, 0.0f), false);
+
+            scene.components.verbs.add_verb("resettestthings", [&] {
+                    ++reset_count;
+
+                    auto &crossing_thing = model.get_thing(crossing);
+                    crossing_thing.position = make_vector(1.0f, 1.0f, 1.0f);
+                    crossing_thing.sector = sector_id(0);
+
+                    model.get_thing(bystander).position = make_vector(6.5f, 1.5f, 1.0f);
+                });
+
+            std::string const script_text =
+                "symbols\n"
+                "sector trigger\n"
+                "message entered\n"
+                "end\n"
+                "code\n"
+                "entered:\n"
+                "    resettestthings();\n"
+                "    return;\n"
+                "end\n";
+
+            std::unique_ptr<cog::script> script;
+            {
+                diagnostic_context dc("linked.cog");
+                memory_file source;
+                source.write(script_text.data(), script_text.size());
+                memory_file::reader source_reader(source);
+                script = scene.components.compiler.compile(source_reader);
+            }
+
+            model.sectors[1].flags += flags::sector_flag::CogLinked;
+            model.script_model.create_instance(asset_ref<cog::script>(*script, asset_id(1)),
+                                               { cog::value(sector_id(1)) });
+            model.script_model.compact_linkages();
+
+            std::vector<float> results;
+            for(uint32_t i = 0; i < 20; ++i) {
+                scene.update(i);
+
+                for(auto tid : { crossing, bystander }) {
+                    auto const &thing = model.get_thing(tid);
+                    results.push_back(get<0>(thing.position));
+                    results.push_back(get<1>(thing.position));
+                    results.push_back(get<2>(thing.position));
+                    results.push_back(static_cast<float>(static_cast<int>(thing.sector)));
+                }
+            }
+
+            return results;
+        }
+    };
+
+}
+
+begin_suite_fixture(physics_presenter_test, physics_presenter_fixture);
+
+test_case(parallel_groups_match_serial)
+{
+    auto serial_results = run_scene(nothing);
+
+    worker_pool workers(4);
+    auto parallel_results = run_scene(&workers);
+
+    assert_eq(parallel_results, serial_results);
+
+    // Thing 0 has crossed the adjoin.
+    assert_true(serial_results[serial_results.size() - 16] > 2.0f);
+    assert_eq(static_cast<int>(serial_results[serial_results.size() - 13]), 1);
+}
+
+test_case(groups_do_not_depend_on_component_order)
+{
+    auto in_order_results = run_emplace_order_scene(false);
+    auto reversed_results = run_emplace_order_scene(true);
+
+    assert_eq(reversed_results, in_order_results);
+}
+
+test_case(cog_moved_things_match_serial)
+{
+    int serial_reset_count = 0;
+    auto serial_results = run_linked_scene(nothing, serial_reset_count);
+
+    int parallel_reset_count = 0;
+    worker_pool workers(4);
+    auto parallel_results = run_linked_scene(&workers, parallel_reset_count);
+
+    assert_eq(parallel_results, serial_results);
+    assert_eq(parallel_reset_count, serial_reset_count);
+    assert_true(serial_reset_count > 0);
+
+    // The bystander keeps the position the cog gave it.
+    assert_true(serial_results[serial_results.size() - 4] < 6.75f);
+}
+
+test_case(segment_query_batch_matches_single)
+{
+    worker_pool workers(4);
+    physics_scene scene(services, level, bus, &workers);
+    auto &model = *scene.presenter.model;
+    auto &physics = *scene.presenter.physics_presenter;
+
+    scene.add_thing(0, make_vector(1.3f, 0.7f, 0.9f), make_vector(0.0f, 0.0f, 0.0f), false);
+    scene.add_thing(1, make_vector(3.1f, 1.2f, 0.4f), make_vector(0.0f, 0.0f, 0.0f), false);
+    scene.add_thing(2, make_vector(4.9f, 1.6f, 1.1f), make_vector(0.0f, 0.0f, 0.0f), false);
+    scene.update(0);
+
+    // Segments start in every sector and end anywhere in or around the level, so many cross
+    // several adjoins and reach the same sectors from both sides.
+    std::vector<physics::segment_query_request> requests;
+    uint32_t seed = 12345;
+    auto next = [&](float scale) {
+            seed = seed * 1103515245 + 12345;
+            return static_cast<float>((seed >> 8) % 10000) / 10000.0f * scale;
+        };
+
+    for(int i = 0; i < 200; ++i) {
+        int sector = i % 4;
+        auto start = make_vector(static_cast<float>(sector) * 2.0f + 0.05f + next(1.9f), 0.05f + next(1.9f), 0.05f + next(1.9f));
+        auto end = make_vector(next(9.0f) - 0.5f, next(3.0f) - 0.5f, next(3.0f) - 0.5f);
+        requests.emplace_back(physics::segment(start, end), sector_id(sector), thing_id(invalid_id));
+    }
+
+    auto thing_p = [](thing_id) { return true; };
+    auto surface_p = [&](surface_id sid) { return at_id(model.surfaces, sid).adjoin < 0; };
+
+    std::vector<maybe<physics::contact>> results;
+    physics.segment_query_batch(requests, thing_p, surface_p, results);
+    assert_eq(results.size(), requests.size());
+
+    std::vector<maybe<physics::contact>> serial_results;
+    physics.set_worker_pool(nothing);
+    physics.segment_query_batch(requests, thing_p, surface_p, serial_results);
+    assert_eq(serial_results.size(), requests.size());
+
+    // Batches issued concurrently from pool jobs
+    physics.set_worker_pool(&workers);
+    std::vector<std::vector<maybe<physics::contact>>> nested_results(4);
+    std::vector<std::function<void()>> jobs;
+    for(auto &nested : nested_results) {
+        jobs.push_back([&] { physics.segment_query_batch(requests, thing_p, surface_p, nested); });
+    }
+
+    workers.run(jobs);
+
+    std::vector<float> expected, actual, serial;
+    size_t contact_count = 0;
+    for(size_t i = 0; i < requests.size(); ++i) {
+        auto const &request = requests[i];
+        auto contact = physics.segment_query(request.query_segment, request.initial_sector, request.ray_cast_thing,
+                                             thing_p, surface_p);
+        contact_count += contact.has_value() ? 1 : 0;
+
+        push_contact(expected, contact);
+        push_contact(actual, results[i]);
+        push_contact(serial, serial_results[i]);
+    }
+
+    assert_eq(actual, expected);
+    assert_eq(serial, expected);
+
+    for(auto const &nested : nested_results) {
+        std::vector<float> nested_actual;
+        for(auto const &contact : nested) {
+            push_contact(nested_actual, contact);
+        }
+
+        assert_eq(nested_actual, expected);
+    }
+    assert_true(contact_count > 0);
+}
+
+test_case(character_sweeps_see_earlier_character_updates)
+{
+    physics_scene scene(services, level, bus, nothing);
+    auto &model = *scene.presenter.model;
+
+    // Floors of the first two sectors.
+    model.surfaces[0].flags = flag_set<flags::surface_flag> { flags::surface_flag::Floor };
+    model.surfaces[6].flags = flag_set<flags::surface_flag> { flags::surface_flag::Floor };
+
+    content::assets::model legs;
+    legs.insert_offset = make_vector(0.0f, 0.0f, 0.5f);
+
+    std::vector<thing_id> characters;
+    for(int i = 0; i < 2; ++i) {
+        auto tid = scene.add_thing(i, make_vector(static_cast<float>(i) * 2.0f + 1.0f, 1.0f, 0.4f),
+                                   make_vector(0.0f, 0.0f, 0.0f), false);
+        model.get_thing(tid).model_3d = asset_ref<content::assets::model>(legs, asset_id(1));
+        model.ecs.emplace_component<components::character>(tid);
+        characters.push_back(tid);
+    }
+
+    model.ecs.emplace_aspect<aspects::character_controller_aspect>(scene.presenter);
+
+    // Stands in for a cog handler which lifts the other character out of reach of its floor.
+    auto landed_delegate = model.ecs.bus.add_handler<events::landed>([&](events::landed const &e) {
+            for(auto tid : characters) {
+                if(tid != e.thing) {
+                    get<2>(model.get_thing(tid).position) = 1.8f;
+                }
+            }
+        });
+
+    model.ecs.update(time_delta(0.05));
+
+    int attached_count = 0;
+    for(auto tid : characters) {
+        attached_count += static_cast<int>(model.get_thing(tid).attach_flags) ? 1 : 0;
+    }
+
+    assert_eq(attached_count, 1);
+}
+
+end_suite(physics_presenter_test);
@@ -0,0 +1,27 @@
+#include "test/test.hpp"
+#include "game/world/physics/query.hpp"
+
+using namespace gorc;
+using namespace gorc::game::world::physics;
+
+begin_suite(query_test);
+
+test_case(inverse_rigid_transform_undoes_transform)
+{
+    auto trns = make_translation_matrix(make_vector(3.0f, -2.0f, 5.0f)) *
+                make_rotation_matrix(37.0f, normalize(make_vector(1.0f, 2.0f, -0.5f))) *
+                make_rotation_matrix(-110.0f, make_vector(0.0f, 0.0f, 1.0f));
+
+    for(auto const &v : { make_vector(0.0f, 0.0f, 0.0f),
+                          make_vector(1.0f, 0.0f, 0.0f),
+                          make_vector(-4.0f, 7.5f, 2.25f),
+                          make_vector(10.0f, -10.0f, 0.5f) }) {
+        auto mesh_v = inverse_rigid_transform(trns, trns.transform(v));
+        assert_lt(length(mesh_v - v), 0.0001f);
+
+        auto world_v = trns.transform(inverse_rigid_transform(trns, v));
+        assert_lt(length(world_v - v), 0.0001f);
+    }
+}
+
+end_suite(query_test);
@@ -3,6 +3,8 @@
 
 gorc::game::world::animations::aspects::update_slide_ceiling_sky_aspect::update_slide_ceiling_sky_aspect(entity_component_system<thing_id>& cs, level_model& model)
     : inner_join_aspect(cs), model(model) {
+    // The ceiling sky offset is only advanced here.
+    writes_component<components::slide_ceiling_sky>();
     return;
 }
 
@@ -4,6 +4,8 @@
 
 gorc::game::world::animations::aspects::update_slide_surface_aspect::update_slide_surface_aspect(entity_component_system<thing_id>& cs, level_model& model)
     : inner_join_aspect(cs), model(model) {
+    // Besides its component, only writes surface thrust and texture offsets.
+    writes_component<components::slide_surface>();
 
     // Add event handler to reduce thrust to 0 when the animation has stopped
     stop_animation_delegate =
@@ -2,6 +2,8 @@
 
 gorc::game::world::animations::aspects::update_surface_light_aspect::update_surface_light_aspect(entity_component_system<thing_id>& cs, level_model& model)
     : inner_join_aspect(cs), model(model) {
+    // Surface extra light is owned by this aspect.
+    writes_component<components::surface_light>();
     return;
 }
 
@@ -2,6 +2,8 @@
 
 gorc::game::world::animations::aspects::update_surface_material_aspect::update_surface_material_aspect(entity_component_system<thing_id>& cs, level_model& model)
     : inner_join_aspect(cs), model(model) {
+    // Writes surface cel numbers, which no other aspect touches.
+    writes_component<components::surface_material>();
     return;
 }
 
@@ -5,6 +5,9 @@
 
 gorc::game::world::aspects::actor_controller_aspect::actor_controller_aspect(entity_component_system<thing_id>& cs)
     : inner_join_aspect(cs) {
+    // Steering only updates the actor's own thing.
+    reads_component<components::actor>();
+    writes_component<components::thing>();
 
     created_delegate =
         cs.bus.add_handler<events::thing_created>([&](events::thing_created const &e) {
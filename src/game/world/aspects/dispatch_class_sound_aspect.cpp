@@ -111,6 +111,9 @@ void dispatch_class_sound_aspect::handle_animation_marker(thing_id id,
 dispatch_class_sound_aspect::dispatch_class_sound_aspect(entity_component_system<thing_id> &cs,
                                                          level_presenter &presenter)
     : inner_join_aspect(cs), presenter(presenter) {
+    // Sounds are dispatched by event; the update only refreshes the join.
+    reads_component<components::class_sounds>();
+    reads_component<components::thing>();
 
     created_delegate =
         cs.bus.add_handler<events::thing_created>([&](events::thing_created const &e) {
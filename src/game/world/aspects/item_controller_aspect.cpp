@@ -8,6 +8,9 @@ using gorc::game::world::aspects::item_controller_aspect;
 item_controller_aspect::item_controller_aspect(entity_component_system<thing_id> &cs,
                                                level_presenter &presenter)
     : inner_join_aspect(cs), presenter(presenter) {
+    // Items are handled by event; the update only refreshes the join.
+    reads_component<components::item>();
+    reads_component<components::thing>();
 
     created_delegate =
         cs.bus.add_handler<events::thing_created>([&](events::thing_created const &e) {
@@ -14,6 +14,8 @@ puppet_animation_aspect::puppet_animation_aspect(entity_component_system<thing_i
                                                  level_presenter &presenter)
     : inner_join_aspect(cs)
     , presenter(presenter) {
+    // Starts key animations through the key presenter, which creates entities, so this
+    // aspect declares no component access and is always updated alone.
 
     created_delegate =
         cs.bus.add_handler<events::thing_created>([&](events::thing_created const &e) {
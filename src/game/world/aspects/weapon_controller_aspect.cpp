@@ -104,6 +104,9 @@ void weapon_controller_aspect::touched_surface(thing_id tid, surface_id touched_
 weapon_controller_aspect::weapon_controller_aspect(entity_component_system<thing_id> &cs,
                                                    level_presenter &presenter)
     : inner_join_aspect(cs), presenter(presenter) {
+    // Damage decay only updates the weapon's own thing.
+    reads_component<components::weapon>();
+    writes_component<components::thing>();
 
     created_delegate =
         cs.bus.add_handler<events::thing_created>([&](events::thing_created const &e) {
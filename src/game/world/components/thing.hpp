@@ -6,6 +6,7 @@
 #include "libold/content/flags/jk_flag.hpp"
 #include "libold/content/flags/ai_mode_flag.hpp"
 #include "utility/uid.hpp"
+#include "ecs/component_storage.hpp"
 #include <memory>
 
 namespace gorc {
@@ -21,6 +22,7 @@ namespace components {
 class thing : public content::assets::thing_template {
 public:
     uid(1226231207);
+    dense_storage();
 
     physics::thing_object_data object_data;
 
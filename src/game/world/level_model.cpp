@@ -5,7 +5,7 @@
 
 gorc::game::world::level_model::level_model(gorc::content_manager& content, service_registry const &svc,
         asset_ref<gorc::content::assets::level> level)
-    : level(level), header(level->header), adjoins(level->adjoins), sectors(level->sectors),
+    : level(level), header(level->header), adjoins(level->adjoins), sectors(level->sectors), collision_geometry(*level),
       services(&svc), ecs(services), script_model(services),
       value_mapping(content, script_model, level) {
 
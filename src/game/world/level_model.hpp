@@ -6,6 +6,7 @@
 #include "ecs/entity_component_system.hpp"
 #include "components/thing.hpp"
 #include "surface.hpp"
+#include "physics/collision_geometry.hpp"
 #include "jk/cog/vm/executor.hpp"
 #include "game/world/sounds/sound_model.hpp"
 #include "game/world/camera/camera_model.hpp"
@@ -23,6 +24,7 @@ public:
     std::vector<content::assets::level_adjoin> adjoins;
     std::vector<surface> surfaces;
     std::vector<content::assets::level_sector> sectors;
+    physics::collision_geometry collision_geometry;
 
     service_registry services;
     entity_component_system<thing_id> ecs;
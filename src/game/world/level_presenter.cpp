@@ -37,6 +37,8 @@
 
 #include "jk/content/material.hpp"
 
+#include <sstream>
+
 gorc::game::world::level_presenter::level_presenter(level_state& components, const level_place& place)
     : components(components), place(place), contentmanager(place.contentmanager) {
     physics_presenter = std::make_unique<physics::physics_presenter>(*this);
@@ -50,12 +52,23 @@ gorc::game::world::level_presenter::level_presenter(level_state& components, con
 }
 
 gorc::game::world::level_presenter::~level_presenter() {
+    if(components.profile_cogs) {
+        std::stringstream report;
+        components.cog_profiler.write_report(report, components.verbs);
+        LOG_INFO(format("cog profile:\n%s") % report.str());
+        components.cog_profiler.clear();
+    }
+
     return;
 }
 
 void gorc::game::world::level_presenter::start(event_bus& eventBus) {
     eventbus = &eventBus;
     model = std::make_unique<level_model>(*place.contentmanager, components.services, place.level);
+    model->script_model.set_fused_tier_enabled(components.fused_cog_tier);
+    if(components.profile_cogs) {
+        model->script_model.set_profiler(&components.cog_profiler);
+    }
 
     // Create local aspects
     model->ecs.emplace_aspect<aspects::thing_controller_aspect>(*this);
@@ -67,6 +80,12 @@ void gorc::game::world::level_presenter::start(event_bus& eventBus) {
     model->ecs.emplace_aspect<aspects::puppet_animation_aspect>(*this);
 
     physics_presenter->start(*model, eventBus);
+
+    if(components.workers) {
+        model->ecs.set_worker_pool(components.workers.get());
+        physics_presenter->set_worker_pool(components.workers.get());
+    }
+
     key_presenter->start(*model, eventBus);
     camera_presenter->start(*model, model->camera_model);
     animation_presenter->start(*model);
@@ -79,6 +98,9 @@ void gorc::game::world::level_presenter::start(event_bus& eventBus) {
     // Update all components
     update(gorc::time(timestamp(0), timestamp(0)));
 
+    // Spawning leaves holes in the component pools. Nothing holds component references yet.
+    model->ecs.compact_components();
+
     // Send startup and loading messages
     model->script_model.send_to_all(cog::message_type::startup,
                                     /* sender */ cog::value(),
@@ -104,6 +126,8 @@ void gorc::game::world::level_presenter::initialize_world() {
             });
     }
 
+    model->script_model.compact_linkages();
+
     // HACK: create thing collision shapes and rigid bodies, enumerate spawn points
     for(const auto& thing : model->level->things) {
         if(thing.type == flags::thing_type::Player) {
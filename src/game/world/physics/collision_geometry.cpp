@@ -0,0 +1,271 @@
+#include "collision_geometry.hpp"
+#include "math/util.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <limits>
+
+void gorc::game::world::physics::segment_batch::clear() {
+    x0.clear();
+    y0.clear();
+    z0.clear();
+    x1.clear();
+    y1.clear();
+    z1.clear();
+}
+
+void gorc::game::world::physics::segment_batch::push_back(segment const &seg) {
+    auto const &p0 = std::get<0>(seg);
+    auto const &p1 = std::get<1>(seg);
+
+    x0.push_back(get<0>(p0));
+    y0.push_back(get<1>(p0));
+    z0.push_back(get<2>(p0));
+    x1.push_back(get<0>(p1));
+    y1.push_back(get<1>(p1));
+    z1.push_back(get<2>(p1));
+}
+
+gorc::game::world::physics::collision_geometry::collision_geometry(content::assets::level const &level) {
+    for(size_t surface_index = 0; surface_index < level.surfaces.size(); ++surface_index) {
+        auto const &surface = level.surfaces[surface_index];
+        first_edge.push_back(edge_px.size());
+
+        if(surface.vertices.empty()) {
+            // Keep the surface so ids still index these arrays, but give it no polygon.
+            // Queries never report contacts with it.
+            LOG_WARNING(format("surface %d has no vertices and will not collide") % static_cast<int>(surface_index));
+
+            plane_nx.push_back(0.0f);
+            plane_ny.push_back(0.0f);
+            plane_nz.push_back(0.0f);
+            plane_px.push_back(0.0f);
+            plane_py.push_back(0.0f);
+            plane_pz.push_back(0.0f);
+            edge_count.push_back(0UL);
+            bound_x.push_back(0.0f);
+            bound_y.push_back(0.0f);
+            bound_z.push_back(0.0f);
+            bound_radius.push_back(0.0f);
+            continue;
+        }
+
+        auto const &nrm = surface.normal;
+        auto const &p = level.vertices[std::get<0>(surface.vertices[0])];
+
+        plane_nx.push_back(get<0>(nrm));
+        plane_ny.push_back(get<1>(nrm));
+        plane_nz.push_back(get<2>(nrm));
+        plane_px.push_back(get<0>(p));
+        plane_py.push_back(get<1>(p));
+        plane_pz.push_back(get<2>(p));
+
+        edge_count.push_back(surface.vertices.size());
+
+        auto centroid = make_zero_vector<3, float>();
+        for(size_t i = surface.vertices.size() - 1UL, j = 0UL; j < surface.vertices.size(); i = j++) {
+            auto const &p0 = level.vertices[std::get<0>(surface.vertices[i])];
+            auto edge = level.vertices[std::get<0>(surface.vertices[j])] - p0;
+            auto edge_normal = cross(nrm, edge);
+
+            edge_px.push_back(get<0>(p0));
+            edge_py.push_back(get<1>(p0));
+            edge_pz.push_back(get<2>(p0));
+            edge_dx.push_back(get<0>(edge));
+            edge_dy.push_back(get<1>(edge));
+            edge_dz.push_back(get<2>(edge));
+            edge_length_squared.push_back(length_squared(edge));
+            edge_nx.push_back(get<0>(edge_normal));
+            edge_ny.push_back(get<1>(edge_normal));
+            edge_nz.push_back(get<2>(edge_normal));
+
+            centroid += p0;
+        }
+
+        centroid /= static_cast<float>(surface.vertices.size());
+
+        float radius = 0.0f;
+        for(auto const &vx : surface.vertices) {
+            radius = std::max(radius, length(level.vertices[std::get<0>(vx)] - centroid));
+        }
+
+        bound_x.push_back(get<0>(centroid));
+        bound_y.push_back(get<1>(centroid));
+        bound_z.push_back(get<2>(centroid));
+        bound_radius.push_back(radius);
+    }
+}
+
+gorc::vector<3> gorc::game::world::physics::collision_geometry::get_plane_normal(int surface) const {
+    auto i = static_cast<size_t>(surface);
+    return make_vector(plane_nx[i], plane_ny[i], plane_nz[i]);
+}
+
+gorc::vector<3> gorc::game::world::physics::collision_geometry::get_plane_point(int surface) const {
+    auto i = static_cast<size_t>(surface);
+    return make_vector(plane_px[i], plane_py[i], plane_pz[i]);
+}
+
+bool gorc::game::world::physics::collision_geometry::point_inside_surface(int surface, vector<3> const &point) const {
+    auto i = static_cast<size_t>(surface);
+    if(edge_count[i] == 0) {
+        return false;
+    }
+
+    float x = get<0>(point), y = get<1>(point), z = get<2>(point);
+
+    // No early out, so the loop vectorizes.
+    int outside = 0;
+    for(size_t e = first_edge[i]; e < first_edge[i] + edge_count[i]; ++e) {
+        float side = edge_nx[e] * (x - edge_px[e]) + edge_ny[e] * (y - edge_py[e]) + edge_nz[e] * (z - edge_pz[e]);
+        outside |= (side < 0.0f);
+    }
+
+    return outside == 0;
+}
+
+bool gorc::game::world::physics::collision_geometry::point_inside_sector(int first_surface, int surface_count,
+        vector<3> const &point) const {
+    float x = get<0>(point), y = get<1>(point), z = get<2>(point);
+
+    auto begin = static_cast<size_t>(first_surface);
+    auto end = begin + static_cast<size_t>(surface_count);
+
+    int outside = 0;
+    for(size_t i = begin; i < end; ++i) {
+        float side = plane_nx[i] * (x - plane_px[i]) + plane_ny[i] * (y - plane_py[i]) + plane_nz[i] * (z - plane_pz[i]);
+        outside |= (side < 0.0f);
+    }
+
+    return outside == 0;
+}
+
+gorc::maybe<gorc::vector<3>> gorc::game::world::physics::collision_geometry::bounded_closest_point_on_surface(int surface,
+        vector<3> const &origin, float max_dist) const {
+    auto i = static_cast<size_t>(surface);
+    if(edge_count[i] == 0) {
+        return nothing;
+    }
+
+    auto bound_dist = max_dist + bound_radius[i];
+    if(length_squared(origin - make_vector(bound_x[i], bound_y[i], bound_z[i])) > bound_dist * bound_dist) {
+        return nothing;
+    }
+
+    auto nrm = get_plane_normal(surface);
+    auto p = get_plane_point(surface);
+    auto v = origin - p;
+    auto plane_dist = dot(nrm, v);
+    if(plane_dist < 0.0f || plane_dist > max_dist) {
+        return nothing;
+    }
+
+    auto pp = (v - nrm * plane_dist) + p;
+    if(point_inside_surface(surface, pp)) {
+        return pp;
+    }
+
+    // Check edges
+    float closest_dist = std::numeric_limits<float>::max();
+    vector<3> closest_point = make_zero_vector<3, float>();
+
+    auto end_edge = first_edge[i] + edge_count[i];
+    for(size_t e = first_edge[i]; e < end_edge; ++e) {
+        // Each edge ends where the next one starts.
+        auto next_e = (e + 1 == end_edge) ? first_edge[i] : (e + 1);
+        auto vp0 = make_vector(edge_px[e], edge_py[e], edge_pz[e]);
+        auto vp1 = make_vector(edge_px[next_e], edge_py[next_e], edge_pz[next_e]);
+        auto lv = make_vector(edge_dx[e], edge_dy[e], edge_dz[e]);
+        auto pv = origin - vp0;
+
+        vector<3> candidate_point;
+        auto alpha = dot(lv, pv) / edge_length_squared[e];
+        if(alpha < 0.0f) {
+            candidate_point = vp0;
+        }
+        else if(alpha > 1.0f) {
+            candidate_point = vp1;
+        }
+        else {
+            candidate_point = lerp(vp0, vp1, alpha);
+        }
+
+        auto cp_dist = length_squared(candidate_point - origin);
+        if(cp_dist < closest_dist) {
+            closest_point = candidate_point;
+            closest_dist = cp_dist;
+        }
+    }
+
+    return closest_point;
+}
+
+gorc::maybe<gorc::vector<3>> gorc::game::world::physics::collision_geometry::segment_surface_intersection_point(int surface,
+        segment const &seg) const {
+    if(edge_count[static_cast<size_t>(surface)] == 0) {
+        return nothing;
+    }
+
+    auto nrm = get_plane_normal(surface);
+    auto p = get_plane_point(surface);
+    auto u = dot(nrm, p - std::get<0>(seg)) / dot(nrm, std::get<1>(seg) - std::get<0>(seg));
+
+    // u is NaN when the segment lies in the plane.
+    if(!(u >= 0.0f && u <= 1.0f)) {
+        return nothing;
+    }
+
+    // Check for segment passing through surface polygon.
+    auto sp = lerp(std::get<0>(seg), std::get<1>(seg), u);
+    if(point_inside_surface(surface, sp)) {
+        return sp;
+    }
+
+    return nothing;
+}
+
+bool gorc::game::world::physics::collision_geometry::segment_surface_intersection(int surface, segment const &seg) const {
+    return segment_surface_intersection_point(surface, seg).has_value();
+}
+
+void gorc::game::world::physics::collision_geometry::segment_surface_intersections(int surface, segment_batch const &segments,
+        std::vector<float> &u) const {
+    auto i = static_cast<size_t>(surface);
+    auto n = segments.size();
+    u.resize(n);
+
+    if(edge_count[i] == 0) {
+        std::fill(u.begin(), u.end(), -1.0f);
+        return;
+    }
+
+    float nx = plane_nx[i], ny = plane_ny[i], nz = plane_nz[i];
+    float px = plane_px[i], py = plane_py[i], pz = plane_pz[i];
+
+    // Each loop runs over all segments, so it vectorizes across segments. Points are
+    // interpolated with lerp, like segment_surface_intersection_point.
+    for(size_t k = 0; k < n; ++k) {
+        float num = nx * (px - segments.x0[k]) + ny * (py - segments.y0[k]) + nz * (pz - segments.z0[k]);
+        float den = nx * (segments.x1[k] - segments.x0[k]) +
+                    ny * (segments.y1[k] - segments.y0[k]) +
+                    nz * (segments.z1[k] - segments.z0[k]);
+        u[k] = num / den;
+    }
+
+    for(size_t e = first_edge[i]; e < first_edge[i] + edge_count[i]; ++e) {
+        float enx = edge_nx[e], eny = edge_ny[e], enz = edge_nz[e];
+        float epx = edge_px[e], epy = edge_py[e], epz = edge_pz[e];
+
+        for(size_t k = 0; k < n; ++k) {
+            float t = u[k];
+            float sx = lerp(segments.x0[k], segments.x1[k], t);
+            float sy = lerp(segments.y0[k], segments.y1[k], t);
+            float sz = lerp(segments.z0[k], segments.z1[k], t);
+            float side = enx * (sx - epx) + eny * (sy - epy) + enz * (sz - epz);
+            u[k] = (side < 0.0f) ? -1.0f : t;
+        }
+    }
+
+    for(size_t k = 0; k < n; ++k) {
+        u[k] = (u[k] >= 0.0f && u[k] <= 1.0f) ? u[k] : -1.0f;
+    }
+}
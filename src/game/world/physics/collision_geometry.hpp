@@ -0,0 +1,70 @@
+#pragma once
+
+#include "libold/content/assets/level.hpp"
+#include "shape.hpp"
+#include "math/vector.hpp"
+#include "utility/maybe.hpp"
+#include <vector>
+
+namespace gorc {
+namespace game {
+namespace world {
+namespace physics {
+
+// Segments stored by component, for testing many segments against one surface.
+class segment_batch {
+public:
+    std::vector<float> x0, y0, z0;
+    std::vector<float> x1, y1, z1;
+
+    void clear();
+    void push_back(segment const &seg);
+
+    inline size_t size() const {
+        return x0.size();
+    }
+};
+
+// Static level geometry packed for narrow-phase queries. Components are stored in separate
+// arrays so per-edge and per-surface loops can be vectorized. Sectors own contiguous surface
+// ranges, so each sector's surfaces are also contiguous here. Surfaces without vertices are
+// kept but never collide.
+class collision_geometry {
+private:
+    // Per surface: plane normal, first vertex, bounding sphere and edge range.
+    std::vector<float> plane_nx, plane_ny, plane_nz;
+    std::vector<float> plane_px, plane_py, plane_pz;
+    std::vector<float> bound_x, bound_y, bound_z, bound_radius;
+    std::vector<size_t> first_edge;
+    std::vector<size_t> edge_count;
+
+    // Per edge: start vertex, edge vector and inward edge plane normal.
+    std::vector<float> edge_px, edge_py, edge_pz;
+    std::vector<float> edge_dx, edge_dy, edge_dz, edge_length_squared;
+    std::vector<float> edge_nx, edge_ny, edge_nz;
+
+    vector<3> get_plane_normal(int surface) const;
+    vector<3> get_plane_point(int surface) const;
+
+public:
+    collision_geometry() = default;
+    explicit collision_geometry(content::assets::level const &level);
+
+    bool point_inside_surface(int surface, vector<3> const &point) const;
+    bool point_inside_sector(int first_surface, int surface_count, vector<3> const &point) const;
+
+    // Returns nothing when the surface is farther than max_dist from origin.
+    maybe<vector<3>> bounded_closest_point_on_surface(int surface, vector<3> const &origin, float max_dist) const;
+
+    maybe<vector<3>> segment_surface_intersection_point(int surface, segment const &seg) const;
+    bool segment_surface_intersection(int surface, segment const &seg) const;
+
+    // Stores the intersection parameter of each segment with the surface in u, or a negative
+    // value if the segment does not pass through the surface polygon.
+    void segment_surface_intersections(int surface, segment_batch const &segments, std::vector<float> &u) const;
+};
+
+}
+}
+}
+}
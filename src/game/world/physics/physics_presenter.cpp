@@ -10,18 +10,36 @@
 #include "game/world/events/touched_thing.hpp"
 #include "game/world/events/touched_surface.hpp"
 #include "query.hpp"
+#include <algorithm>
+#include <atomic>
 
 using namespace gorc::game::world::physics;
 
 physics_presenter::physics_presenter(level_presenter& presenter)
-    : presenter(presenter), model(nullptr), physics_anim_node_visitor(*this, physics_thing_resting_manifolds, physics_touched_thing_pairs),
-      segment_query_anim_node_visitor(*this) {
+    : presenter(presenter), model(nullptr), segment_query_anim_node_visitor(*this), serial_scratch(*this) {
+    return;
+}
+
+physics_presenter::solver_scratch::solver_scratch(physics_presenter& presenter)
+    : anim_node_visitor(presenter, resting_manifolds, touched_thing_pairs) {
     return;
 }
 
 void physics_presenter::start(level_model& model, event_bus& eb) {
     this->model = &model;
     this->eventbus = &eb;
+
+    physics_broadphase_thing_influence.clear();
+    physics_broadphase_sector_things.clear();
+}
+
+void physics_presenter::set_worker_pool(maybe<worker_pool*> pool) {
+    workers = pool;
+
+    // Size one scratch set for a full batch up front. Concurrent batches add more on demand.
+    size_t concurrency = maybe_if_else(workers, [](worker_pool *pool) { return pool->concurrency(); },
+                                       [] { return size_t(1); });
+    release_segment_query_scratch(acquire_segment_query_scratch(concurrency));
 }
 
 bool physics_presenter::surface_needs_collision_response(thing_id moving_thing_id, surface_id sid) {
@@ -77,7 +95,11 @@ physics_presenter::physics_node_visitor::physics_node_visitor(physics_presenter&
 void physics_presenter::physics_node_visitor::visit_mesh(asset_ref<content::assets::model> model, int mesh_id, int) {
     const auto& mesh = model->geosets.front().meshes[mesh_id];
 
-    for(const auto& face : mesh.faces) {
+    // Only test faces near the sphere.
+    auto mesh_center = inverse_rigid_transform(current_matrix, sphere.position);
+    auto mesh_extent = make_vector(sphere.radius, sphere.radius, sphere.radius);
+    mesh.face_bvh.visit_faces(make_box(mesh_center - mesh_extent, mesh_center + mesh_extent), [&](size_t face_index) {
+        const auto& face = mesh.faces[face_index];
         auto maybe_face_nearest_point = physics::bounded_closest_point_on_surface(sphere.position, mesh, face, current_matrix, sphere.radius);
 
         maybe_if(maybe_face_nearest_point, [&](vector<3> const &face_nearest_point) {
@@ -95,125 +117,188 @@ void physics_presenter::physics_node_visitor::visit_mesh(asset_ref<content::asse
                 physics_touched_thing_pairs.emplace(std::min(moving_thing_id, visited_thing_id), std::max(moving_thing_id, visited_thing_id));
             }
         });
-    };
+    });
 }
 
-void physics_presenter::physics_calculate_broadphase(double dt) {
-    physics_broadphase_thing_influence.clear();
-    physics_broadphase_sector_things.clear();
+bool physics_presenter::physics_thing_influence_is_current(thing_influence const& influence, components::thing const& thing,
+        box<3> const& bounds) {
+    // A flood fill within smaller bounds cannot reach new sectors. It reaches the same sectors
+    // as long as every cached sector still overlaps the bounds.
+    if(influence.sector != thing.sector ||
+       !influence.bounds.contains(bounds.v0) ||
+       !influence.bounds.contains(bounds.v1)) {
+        return false;
+    }
 
-    // Calculate influence AABBs and record overlapping sectors.
-    for(const auto& thing_pair : model->ecs.all_components<components::thing>()) {
-        const auto& thing = *thing_pair.second;
-        thing_id tid = thing_pair.first;
+    for(auto sid : influence.sectors) {
+        if(!bounds.overlaps(at_id(model->sectors, sid).collide_box)) {
+            return false;
+        }
+    }
 
-        auto thing_off_v = make_vector(1.0f, 1.0f, 1.0f) * (thing.move_size + length(thing.vel) * static_cast<float>(dt));
-        auto thing_aabb = make_box(thing.position - thing_off_v, thing.position + thing_off_v);
+    return true;
+}
 
-        physics_thing_closed_set.clear();
-        physics_thing_open_set.clear();
+void physics_presenter::physics_erase_thing_influence(thing_id tid, thing_influence const& influence) {
+    for(auto sid : influence.sectors) {
+        auto sector_thing_range = physics_broadphase_sector_things.equal_range(sid);
+        for(auto it = std::get<0>(sector_thing_range); it != std::get<1>(sector_thing_range); ++it) {
+            if(it->second == tid) {
+                physics_broadphase_sector_things.erase(it);
+                break;
+            }
+        }
+    }
+}
 
-        physics_thing_open_set.push_back(thing.sector);
+void physics_presenter::physics_compute_thing_influence(thing_id tid, thing_influence& influence, components::thing const& thing,
+        box<3> const& bounds) {
+    physics_erase_thing_influence(tid, influence);
 
-        while(!physics_thing_open_set.empty()) {
-            sector_id sid = physics_thing_open_set.back();
-            physics_thing_open_set.pop_back();
+    influence.bounds = bounds;
+    influence.sector = thing.sector;
+    influence.sectors.clear();
 
-            const auto& sector = at_id(model->sectors, sid);
+    physics_thing_closed_set.clear();
+    physics_thing_open_set.clear();
 
-            if(physics_thing_closed_set.find(sid) != physics_thing_closed_set.end()
-                    || !thing_aabb.overlaps(sector.collide_box)) {
-                // Thing does not influence sector.
-                continue;
-            }
+    physics_thing_open_set.push_back(thing.sector);
 
-            // Thing influences sector. Move to closed set.
-            physics_thing_closed_set.emplace(sid);
-            physics_broadphase_sector_things.emplace(sid, tid);
-            physics_broadphase_thing_influence.emplace(tid, sid);
+    while(!physics_thing_open_set.empty()) {
+        sector_id sid = physics_thing_open_set.back();
+        physics_thing_open_set.pop_back();
 
-            // Add adjoining sectors to open set.
-            for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
-                const auto& surf = model->surfaces[i];
-                if(surf.adjoin >= 0) {
-                    physics_thing_open_set.push_back(surf.adjoined_sector);
-                }
+        const auto& sector = at_id(model->sectors, sid);
+
+        if(physics_thing_closed_set.find(sid) != physics_thing_closed_set.end()
+                || !bounds.overlaps(sector.collide_box)) {
+            // Thing does not influence sector.
+            continue;
+        }
+
+        // Thing influences sector. Move to closed set.
+        physics_thing_closed_set.emplace(sid);
+        physics_broadphase_sector_things.emplace(sid, tid);
+        influence.sectors.push_back(sid);
+
+        // Add adjoining sectors to open set.
+        for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
+            const auto& surf = model->surfaces[i];
+            if(surf.adjoin >= 0) {
+                physics_thing_open_set.push_back(surf.adjoined_sector);
             }
         }
     }
+}
 
-    // Compute and merge sector groups
-    physics_broadphase_sector_group.clear();
+int physics_presenter::physics_find_sector_group(int sector) {
+    auto& parent = physics_broadphase_sector_parent;
+    while(parent[sector] != sector) {
+        parent[sector] = parent[parent[sector]];
+        sector = parent[sector];
+    }
+
+    return sector;
+}
 
-    // Group sectors together
-    int current_influence_group = 0;
-    for(auto it_begin = physics_broadphase_thing_influence.begin();
-        it_begin != physics_broadphase_thing_influence.end(); ) {
-        // Find range end
-        auto it_end = it_begin;
-        while((it_end != physics_broadphase_thing_influence.end()) &&
-              (it_end->first == it_begin->first)) {
-            ++it_end;
+void physics_presenter::physics_calculate_broadphase(double dt) {
+    ++physics_broadphase_generation;
+
+    // Calculate influence AABBs and update sectors for things that moved out of them.
+    for(const auto& thing_pair : model->ecs.all_components<components::thing>()) {
+        const auto& thing = *thing_pair.second;
+        thing_id tid = thing_pair.first;
+
+        auto thing_off_v = make_vector(1.0f, 1.0f, 1.0f) * (thing.move_size + length(thing.vel) * static_cast<float>(dt));
+        auto thing_aabb = make_box(thing.position - thing_off_v, thing.position + thing_off_v);
+
+        auto it = physics_broadphase_thing_influence.find(tid);
+        if(it == physics_broadphase_thing_influence.end()) {
+            it = physics_broadphase_thing_influence.emplace(tid, thing_influence()).first;
+            physics_compute_thing_influence(tid, it->second, thing, thing_aabb);
+        }
+        else if(!physics_thing_influence_is_current(it->second, thing, thing_aabb)) {
+            physics_compute_thing_influence(tid, it->second, thing, thing_aabb);
         }
 
-        physics_broadphase_groups_to_merge.clear();
-        bool used_current_influence_group = false;
-        int min_id_to_merge = current_influence_group;
-        for(const auto &influenced_sector : make_range(it_begin, it_end)) {
-            auto sector_group_it = physics_broadphase_sector_group.find(influenced_sector.second);
-            if(sector_group_it == physics_broadphase_sector_group.end()) {
-                // Sector is not currently in a group.
-                physics_broadphase_sector_group.emplace(influenced_sector.second,
-                                                        current_influence_group);
-                used_current_influence_group = true;
-            }
-            else {
-                // Sector is currently in a group.
-                physics_broadphase_groups_to_merge.emplace(sector_group_it->second);
-                min_id_to_merge = std::min(sector_group_it->second, min_id_to_merge);
-            }
+        it->second.generation = physics_broadphase_generation;
+    }
+
+    // Forget destroyed things.
+    for(auto it = physics_broadphase_thing_influence.begin(); it != physics_broadphase_thing_influence.end(); ) {
+        if(it->second.generation != physics_broadphase_generation) {
+            physics_erase_thing_influence(it->first, it->second);
+            it = physics_broadphase_thing_influence.erase(it);
         }
+        else {
+            ++it;
+        }
+    }
 
-        if(used_current_influence_group) {
-            physics_broadphase_groups_to_merge.emplace(current_influence_group++);
+    // Merge sectors influenced by the same thing. The smallest sector id names the group.
+    auto& parent = physics_broadphase_sector_parent;
+    parent.resize(model->sectors.size());
+    for(size_t i = 0; i < parent.size(); ++i) {
+        parent[i] = static_cast<int>(i);
+    }
+
+    for(const auto& influence : physics_broadphase_thing_influence) {
+        auto const &sectors = influence.second.sectors;
+        if(sectors.empty()) {
+            continue;
         }
 
-        // Merge groups
-        for(auto &grouped_sector : physics_broadphase_sector_group) {
-            if(physics_broadphase_groups_to_merge.count(grouped_sector.second)) {
-                grouped_sector.second = min_id_to_merge;
+        int first_group = physics_find_sector_group(static_cast<int>(sectors.front()));
+        for(auto sid : make_range(sectors.begin() + 1, sectors.end())) {
+            int group = physics_find_sector_group(static_cast<int>(sid));
+            if(group < first_group) {
+                parent[first_group] = group;
+                first_group = group;
+            }
+            else if(group > first_group) {
+                parent[group] = first_group;
             }
         }
+    }
+
+    // Remap sector groups to thing groups. Things are solved in id order, and groups in the
+    // order of their first thing, regardless of the order in which components are stored.
+    auto& sorted_things = physics_broadphase_sorted_things;
+    sorted_things.clear();
+    for(const auto& influence : physics_broadphase_thing_influence) {
+        auto const &sectors = influence.second.sectors;
+        if(sectors.empty()) {
+            continue;
+        }
 
-        it_begin = it_end;
+        sorted_things.emplace_back(influence.first,
+                                   physics_find_sector_group(static_cast<int>(sectors.front())));
     }
 
-    // Remap sector groups to thing groups
-    physics_broadphase_thing_groups.clear();
+    std::sort(sorted_things.begin(), sorted_things.end());
 
-    for(auto it_begin = physics_broadphase_thing_influence.begin();
-        it_begin != physics_broadphase_thing_influence.end(); ) {
-        auto it_end = it_begin;
-        while((it_end != physics_broadphase_thing_influence.end()) &&
-              (it_end->first == it_begin->first)) {
-            ++it_end;
-        }
+    auto& group_order = physics_broadphase_group_order;
+    group_order.assign(parent.size(), -1);
+    int next_group_order = 0;
 
-        int thing_group_id = physics_broadphase_sector_group.find(it_begin->second)->second;
-        physics_broadphase_thing_groups.emplace(thing_group_id, it_begin->first);
+    physics_broadphase_thing_groups.clear();
+    for(auto const &sorted_thing : sorted_things) {
+        int &thing_group_order = group_order[static_cast<size_t>(std::get<1>(sorted_thing))];
+        if(thing_group_order < 0) {
+            thing_group_order = next_group_order++;
+        }
 
-        it_begin = it_end;
+        physics_broadphase_thing_groups.emplace(thing_group_order, std::get<0>(sorted_thing));
     }
 
     return;
 }
 
 void physics_presenter::physics_find_sector_resting_manifolds(const physics::sphere& sphere, sector_id, const vector<3>&,
-        thing_id current_thing_id) {
+        thing_id current_thing_id, solver_scratch& scratch) {
     // Get list of sectors within thing influence.
-    auto thing_influence_range = physics_broadphase_thing_influence.equal_range(current_thing_id);
-    for(auto it = std::get<0>(thing_influence_range); it != std::get<1>(thing_influence_range); ++it) {
-        const auto& sector = at_id(model->sectors, it->second);
+    for(auto sid : physics_broadphase_thing_influence.find(current_thing_id)->second.sectors) {
+        const auto& sector = at_id(model->sectors, sid);
 
         for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
             const auto& surface = model->surfaces[i];
@@ -222,33 +307,33 @@ void physics_presenter::physics_find_sector_resting_manifolds(const physics::sph
                 continue;
             }
 
-            auto maybe_surf_nearest_point = physics::bounded_closest_point_on_surface(sphere.position, *model->level, surface, sphere.radius);
+            auto maybe_surf_nearest_point = model->collision_geometry.bounded_closest_point_on_surface(i, sphere.position, sphere.radius);
             maybe_if(maybe_surf_nearest_point, [&](vector<3> const &surf_nearest_point) {
                 auto surf_nearest_dist = length(sphere.position - surf_nearest_point);
 
                 if(surf_nearest_dist <= sphere.radius) {
-                    physics_thing_resting_manifolds.emplace_back(surf_nearest_point, (sphere.position - surf_nearest_point) / surf_nearest_dist,
+                    scratch.resting_manifolds.emplace_back(surf_nearest_point, (sphere.position - surf_nearest_point) / surf_nearest_dist,
                             surface.normal * ((sphere.radius / surf_nearest_dist) - 1.0f));
-                    physics_thing_resting_manifolds.back().contact_surface_id = surface_id(i);
-                    physics_touched_surface_pairs.emplace(current_thing_id, surface_id(i));
+                    scratch.resting_manifolds.back().contact_surface_id = surface_id(i);
+                    scratch.touched_surface_pairs.emplace(current_thing_id, surface_id(i));
                 }
             });
         }
     }
 }
 
-void physics_presenter::physics_find_thing_resting_manifolds(const physics::sphere& sphere, const vector<3>&, thing_id current_thing_id) {
+void physics_presenter::physics_find_thing_resting_manifolds(const physics::sphere& sphere, const vector<3>&, thing_id current_thing_id,
+        solver_scratch& scratch) {
     // Get list of things within thing influence.
-    physics_overlapping_things.clear();
-    auto thing_influence_range = physics_broadphase_thing_influence.equal_range(current_thing_id);
-    for(auto it = std::get<0>(thing_influence_range); it != std::get<1>(thing_influence_range); ++it) {
-        auto influenced_thing_range = physics_broadphase_sector_things.equal_range(it->second);
+    scratch.overlapping_things.clear();
+    for(auto sid : physics_broadphase_thing_influence.find(current_thing_id)->second.sectors) {
+        auto influenced_thing_range = physics_broadphase_sector_things.equal_range(sid);
         for(auto jt = std::get<0>(influenced_thing_range); jt != std::get<1>(influenced_thing_range); ++jt) {
-            physics_overlapping_things.emplace(jt->second);
+            scratch.overlapping_things.emplace(jt->second);
         }
     }
 
-    for(auto col_thing_id : physics_overlapping_things) {
+    for(auto col_thing_id : scratch.overlapping_things) {
         auto& col_thing = model->get_thing(col_thing_id);
 
         if(col_thing_id == current_thing_id) {
@@ -278,11 +363,11 @@ void physics_presenter::physics_find_thing_resting_manifolds(const physics::sphe
                         contact_point_vel = get_thing_path_moving_point_velocity(col_thing_id, contact_point);
                     }
 
-                    physics_thing_resting_manifolds.emplace_back(contact_point, vec_to / vec_to_len, contact_point_vel);
-                    physics_thing_resting_manifolds.back().contact_thing_id = col_thing_id;
+                    scratch.resting_manifolds.emplace_back(contact_point, vec_to / vec_to_len, contact_point_vel);
+                    scratch.resting_manifolds.back().contact_thing_id = col_thing_id;
                 }
 
-                physics_touched_thing_pairs.emplace(std::min(current_thing_id, col_thing_id), std::max(current_thing_id, col_thing_id));
+                scratch.touched_thing_pairs.emplace(std::min(current_thing_id, col_thing_id), std::max(current_thing_id, col_thing_id));
             }
         }
         else if(col_thing.collide == flags::collide_type::face) {
@@ -290,11 +375,12 @@ void physics_presenter::physics_find_thing_resting_manifolds(const physics::sphe
                 continue;
             }
 
-            physics_anim_node_visitor.needs_response = thing_needs_collision_response(current_thing_id, col_thing_id);
-            physics_anim_node_visitor.sphere = sphere;
-            physics_anim_node_visitor.visited_thing_id = col_thing_id;
-            physics_anim_node_visitor.moving_thing_id = current_thing_id;
-            presenter.key_presenter->visit_mesh_hierarchy(physics_anim_node_visitor, col_thing.model_3d.get_value(), col_thing.position, col_thing.orient, col_thing_id, /* is pov */ false);
+            auto& visitor = scratch.anim_node_visitor;
+            visitor.needs_response = thing_needs_collision_response(current_thing_id, col_thing_id);
+            visitor.sphere = sphere;
+            visitor.visited_thing_id = col_thing_id;
+            visitor.moving_thing_id = current_thing_id;
+            presenter.key_presenter->visit_mesh_hierarchy(visitor, col_thing.model_3d.get_value(), col_thing.position, col_thing.orient, col_thing_id, /* is pov */ false);
         }
     }
 }
@@ -343,7 +429,25 @@ void physics_presenter::compute_thing_attachment_velocity(components::thing &thi
     }
 }
 
-void physics_presenter::physics_thing_step(thing_id tid, components::thing& thing, double dt) {
+void physics_presenter::physics_move_thing(thing_id tid, components::thing& thing, const vector<3>& new_pos,
+        maybe<deferred_group_effects*> deferred) {
+    if(deferred.has_value()) {
+        // Sector changes send cog messages. Record the move so they are sent later, but keep
+        // the sector consistent with the new position for the rest of the update.
+        auto &effects = *deferred.get_value();
+        effects.moves.emplace_back(tid, thing.position, thing.sector, new_pos);
+        segment_adjoin_path(segment(thing.position, new_pos), *model, at_id(model->sectors, thing.sector),
+                effects.adjoin_path);
+        thing.position = new_pos;
+        thing.sector = std::get<0>(effects.adjoin_path.back());
+    }
+    else {
+        presenter.adjust_thing_pos(tid, new_pos);
+    }
+}
+
+void physics_presenter::physics_thing_step(thing_id tid, components::thing& thing, double dt, solver_scratch& scratch,
+        maybe<deferred_group_effects*> deferred) {
     // Only perform collision detection for player, actor, and weapon types.
     if(thing.type != flags::thing_type::Actor &&
        thing.type != flags::thing_type::Player &&
@@ -359,19 +463,20 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
 
     // Do sphere collision:
 
-    physics_thing_resting_manifolds.clear();
+    scratch.resting_manifolds.clear();
     physics_find_sector_resting_manifolds(physics::sphere(thing.position, thing.size),
                                           thing.sector,
                                           thing.vel,
-                                          tid);
-    physics_find_thing_resting_manifolds(physics::sphere(thing.position, thing.size), thing.vel, tid);
+                                          tid,
+                                          scratch);
+    physics_find_thing_resting_manifolds(physics::sphere(thing.position, thing.size), thing.vel, tid, scratch);
 
     vector<3> prev_thing_vel = thing.vel;
 
     bool influenced_by_manifolds = false;
 
     // Add 'towards' velocities from resting contacts, projected into manifold direction.
-    for(const auto& manifold : physics_thing_resting_manifolds) {
+    for(const auto& manifold : scratch.resting_manifolds) {
         auto man_vel_len = dot(manifold.velocity, manifold.normal);
 
         if(man_vel_len <= 0.0f) {
@@ -395,7 +500,7 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
     // Solve LCP, 5 iterations
     for(int i = 0; i < 5; ++i) {
         vector<3> new_computed_vel = prev_thing_vel;
-        for(const auto& manifold : physics_thing_resting_manifolds) {
+        for(const auto& manifold : scratch.resting_manifolds) {
             // Three cases:
             auto vel_dot = dot(new_computed_vel, manifold.normal);
             if(vel_dot < 0.0f) {
@@ -443,8 +548,10 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
     else {
         if(!reject_vel) {
             thing.vel = prev_thing_vel;
-            presenter.adjust_thing_pos(tid,
-                                       thing.position + prev_thing_vel * static_cast<float>(dt));
+            physics_move_thing(tid,
+                               thing,
+                               thing.position + prev_thing_vel * static_cast<float>(dt),
+                               deferred);
         }
         else {
             thing.vel = make_zero_vector<3, float>();
@@ -453,7 +560,7 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
     }
 
     // Check vel to make sure all valid resting velocities are still applied.
-    for(const auto& manifold : physics_thing_resting_manifolds) {
+    for(const auto& manifold : scratch.resting_manifolds) {
         auto man_vel_len = dot(manifold.velocity, manifold.normal);
 
         if(man_vel_len <= 0.0f) {
@@ -469,8 +576,13 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
         if(amt_in_man_vel < man_vel_len) {
             // Thing is blocked.
             maybe_if(manifold.contact_thing_id, [&](thing_id contact_thing_id) {
-                    auto& contact_thing = model->get_thing(contact_thing_id);
-                    contact_thing.is_blocked = true;
+                    if(deferred.has_value()) {
+                        deferred.get_value()->blocked_things.push_back(contact_thing_id);
+                    }
+                    else {
+                        auto& contact_thing = model->get_thing(contact_thing_id);
+                        contact_thing.is_blocked = true;
+                    }
             });
         }
     }
@@ -617,11 +729,188 @@ gorc::vector<3> physics_presenter::get_thing_path_moving_point_velocity(thing_id
     return make_zero_vector<3, float>();
 }
 
+bool physics_presenter::physics_group_can_solve_in_parallel(thing_group_iterator begin, thing_group_iterator end) {
+    // Path movers play sounds and send cog messages while they move.
+    for(auto const &moving_thing_pair : make_range(begin, end)) {
+        auto const &moving_thing = model->get_thing(moving_thing_pair.second);
+        if(moving_thing.move == flags::move_type::Path &&
+           (moving_thing.path_moving || moving_thing.rotatepivot_moving)) {
+            return false;
+        }
+    }
+
+    // Cog handlers linked to the group's sectors may move things between steps.
+    for(auto const &moving_thing_pair : make_range(begin, end)) {
+        for(auto sid : physics_broadphase_thing_influence.find(moving_thing_pair.second)->second.sectors) {
+            auto const &sector = at_id(model->sectors, sid);
+            if(sector.flags & flags::sector_flag::CogLinked) {
+                return false;
+            }
+
+            for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
+                if(model->surfaces[i].flags & flags::surface_flag::CogLinked) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void physics_presenter::physics_solve_group(thing_group_iterator begin, thing_group_iterator end, double dt,
+        solver_scratch& scratch, maybe<deferred_group_effects*> deferred) {
+    // - Compute minimum step size
+    double step_dt = dt;
+    for(auto const &moving_thing_pair : make_range(begin, end)) {
+        auto const &moving_thing = model->get_thing(moving_thing_pair.second);
+        auto moving_thing_vel_length = static_cast<double>(length(moving_thing.vel));
+        if(moving_thing_vel_length <= 0.0) {
+            step_dt = std::min(step_dt, dt);
+        }
+        else {
+            double moving_thing_step = 0.5 * static_cast<double>(moving_thing.move_size) /
+                                       static_cast<double>(length(moving_thing.vel));
+            step_dt = std::min(step_dt, moving_thing_step);
+        }
+    }
+
+    // - Update things
+    double dt_remaining = dt;
+    while(dt_remaining > 0.0) {
+        double this_step_dt = (dt_remaining > step_dt) ? step_dt : dt_remaining;
+        dt_remaining -= this_step_dt;
+
+        for(auto &moving_thing_pair : make_range(begin, end)) {
+            auto &moving_thing = model->get_thing(moving_thing_pair.second);
+            if(moving_thing.move == flags::move_type::physics) {
+                physics_thing_step(moving_thing_pair.second,
+                                   moving_thing,
+                                   this_step_dt,
+                                   scratch,
+                                   deferred);
+            }
+            else if(!moving_thing.is_blocked &&
+                    (moving_thing.path_moving || moving_thing.rotatepivot_moving)) {
+                update_thing_path_moving(moving_thing_pair.second, moving_thing, this_step_dt);
+            }
+        }
+    }
+}
+
+void physics_presenter::physics_solve_groups_in_parallel(worker_pool& pool, double dt) {
+    group_effects.resize(physics_broadphase_group_ranges.size());
+    parallel_groups.clear();
+    for(size_t i = 0; i < physics_broadphase_group_ranges.size(); ++i) {
+        auto &effects = group_effects[i];
+        effects.moves.clear();
+        effects.blocked_things.clear();
+        effects.solved_in_parallel = physics_group_can_solve_in_parallel(std::get<0>(physics_broadphase_group_ranges[i]),
+                                                                         std::get<1>(physics_broadphase_group_ranges[i]));
+        if(effects.solved_in_parallel) {
+            parallel_groups.push_back(i);
+        }
+    }
+
+    // - Solve independent groups. Groups do not share sectors or things, so each job only
+    //   needs its own scratch state.
+    size_t worker_count = std::min(pool.concurrency(), parallel_groups.size());
+    while(worker_scratch.size() < worker_count) {
+        worker_scratch.push_back(std::make_unique<solver_scratch>(*this));
+    }
+
+    std::atomic<size_t> next_group(0);
+    auto solve_groups = [&](solver_scratch &scratch) {
+        for(size_t i = next_group++; i < parallel_groups.size(); i = next_group++) {
+            auto group = parallel_groups[i];
+            physics_solve_group(std::get<0>(physics_broadphase_group_ranges[group]),
+                                std::get<1>(physics_broadphase_group_ranges[group]),
+                                dt,
+                                scratch,
+                                &group_effects[group]);
+        }
+    };
+
+    solver_jobs.clear();
+    for(size_t i = 0; i < worker_count; ++i) {
+        solver_jobs.push_back([&, i] { solve_groups(*worker_scratch[i]); });
+    }
+
+    pool.run(solver_jobs);
+
+    replay_expected_state.clear();
+    for(auto group : parallel_groups) {
+        for(auto const &move : group_effects[group].moves) {
+            auto const &thing = model->get_thing(std::get<0>(move));
+            replay_expected_state.emplace(std::get<0>(move), std::make_tuple(thing.position, thing.sector));
+        }
+    }
+
+    for(auto &scratch : worker_scratch) {
+        serial_scratch.touched_thing_pairs.insert(scratch->touched_thing_pairs.begin(),
+                                                  scratch->touched_thing_pairs.end());
+        serial_scratch.touched_surface_pairs.insert(scratch->touched_surface_pairs.begin(),
+                                                    scratch->touched_surface_pairs.end());
+        scratch->touched_thing_pairs.clear();
+        scratch->touched_surface_pairs.clear();
+    }
+
+    // - Apply side effects and solve the remaining groups in group order, so cog messages
+    //   are sent in the same order as a serial update.
+    for(size_t i = 0; i < physics_broadphase_group_ranges.size(); ++i) {
+        if(group_effects[i].solved_in_parallel) {
+            physics_apply_deferred_group_effects(group_effects[i]);
+        }
+        else {
+            physics_solve_group(std::get<0>(physics_broadphase_group_ranges[i]),
+                                std::get<1>(physics_broadphase_group_ranges[i]),
+                                dt,
+                                serial_scratch,
+                                nothing);
+        }
+    }
+}
+
+void physics_presenter::physics_apply_deferred_group_effects(deferred_group_effects const& effects) {
+    for(auto const &move : effects.moves) {
+        thing_id tid;
+        vector<3> old_pos, new_pos;
+        sector_id old_sector;
+        std::tie(tid, old_pos, old_sector, new_pos) = move;
+
+        // A thing moved by an earlier message handler keeps its new position. Its remaining
+        // moves were solved from the old one.
+        auto expected_it = replay_expected_state.find(tid);
+        if(expected_it == replay_expected_state.end()) {
+            continue;
+        }
+
+        auto &thing = model->get_thing(tid);
+        if(thing.sector != std::get<1>(expected_it->second) ||
+           length_squared(thing.position - std::get<0>(expected_it->second)) > 0.0f) {
+            replay_expected_state.erase(expected_it);
+            continue;
+        }
+
+        // Replay the move from its original position and sector to send messages.
+        thing.position = old_pos;
+        thing.sector = old_sector;
+        presenter.adjust_thing_pos(tid, new_pos);
+
+        auto const &moved_thing = model->get_thing(tid);
+        expected_it->second = std::make_tuple(moved_thing.position, moved_thing.sector);
+    }
+
+    for(auto blocked_thing_id : effects.blocked_things) {
+        model->get_thing(blocked_thing_id).is_blocked = true;
+    }
+}
+
 void physics_presenter::update(const gorc::time& time) {
     double dt = time.elapsed_as_seconds();
 
-    physics_touched_thing_pairs.clear();
-    physics_touched_surface_pairs.clear();
+    serial_scratch.touched_thing_pairs.clear();
+    serial_scratch.touched_surface_pairs.clear();
 
     // General approach:
 
@@ -642,55 +931,34 @@ void physics_presenter::update(const gorc::time& time) {
         }
     }
 
-    // - Rectify physics thing position vs. velocity, resting contacts, etc.
+    // - Find group ranges.
+    physics_broadphase_group_ranges.clear();
     for(auto thing_range_begin = physics_broadphase_thing_groups.begin();
         thing_range_begin != physics_broadphase_thing_groups.end(); ) {
-
-        // - Find end of group range.
         auto thing_range_end = thing_range_begin;
         while((thing_range_end != physics_broadphase_thing_groups.end()) &&
               (thing_range_begin->first == thing_range_end->first)) {
             ++thing_range_end;
         }
 
-        // - Compute minimum step size
-        double step_dt = dt;
-        for(auto const &moving_thing_pair : make_range(thing_range_begin, thing_range_end)) {
-            auto const &moving_thing = model->get_thing(moving_thing_pair.second);
-            auto moving_thing_vel_length = static_cast<double>(length(moving_thing.vel));
-            if(moving_thing_vel_length <= 0.0) {
-                step_dt = std::min(step_dt, dt);
-            }
-            else {
-                double moving_thing_step = 0.5 * static_cast<double>(moving_thing.move_size) /
-                                           static_cast<double>(length(moving_thing.vel));
-                step_dt = std::min(step_dt, moving_thing_step);
-            }
-        }
-
-        // - Update things
-        double dt_remaining = dt;
-        while(dt_remaining > 0.0) {
-            double this_step_dt = (dt_remaining > step_dt) ? step_dt : dt_remaining;
-            dt_remaining -= this_step_dt;
-
-            for(auto &moving_thing_pair : make_range(thing_range_begin, thing_range_end)) {
-                auto &moving_thing = model->get_thing(moving_thing_pair.second);
-                if(moving_thing.move == flags::move_type::physics) {
-                    physics_thing_step(moving_thing_pair.second,
-                                       moving_thing,
-                                       this_step_dt);
-                }
-                else if(!moving_thing.is_blocked &&
-                        (moving_thing.path_moving || moving_thing.rotatepivot_moving)) {
-                    update_thing_path_moving(moving_thing_pair.second, moving_thing, this_step_dt);
-                }
-            }
-        }
-
+        physics_broadphase_group_ranges.emplace_back(thing_range_begin, thing_range_end);
         thing_range_begin = thing_range_end;
     }
 
+    // - Rectify physics thing position vs. velocity, resting contacts, etc.
+    maybe_if_else(workers, [&](worker_pool *pool) {
+                physics_solve_groups_in_parallel(*pool, dt);
+            },
+            [&] {
+                for(auto const &group_range : physics_broadphase_group_ranges) {
+                    physics_solve_group(std::get<0>(group_range),
+                                        std::get<1>(group_range),
+                                        dt,
+                                        serial_scratch,
+                                        nothing);
+                }
+            });
+
     // - Remove thing attachment velocity.
     for(auto &thing : model->ecs.all_components<components::thing>()) {
         if(thing.second->move == flags::move_type::physics) {
@@ -713,14 +981,14 @@ void physics_presenter::update(const gorc::time& time) {
     }
 
     // Dispatch touched messages
-    for(const auto& touched_surface_pair : physics_touched_surface_pairs) {
+    for(const auto& touched_surface_pair : serial_scratch.touched_surface_pairs) {
         thing_id tid;
         surface_id sid;
         std::tie(tid, sid) = touched_surface_pair;
         eventbus->fire_event(events::touched_surface(tid, sid));
     }
 
-    for(const auto& touched_thing_pair : physics_touched_thing_pairs) {
+    for(const auto& touched_thing_pair : serial_scratch.touched_thing_pairs) {
         thing_id thing_a_id, thing_b_id;
         std::tie(thing_a_id, thing_b_id) = touched_thing_pair;
 
@@ -731,6 +999,201 @@ void physics_presenter::update(const gorc::time& time) {
     }
 }
 
+segment_query_request::segment_query_request(const segment& query_segment, sector_id initial_sector, thing_id ray_cast_thing)
+    : query_segment(query_segment), initial_sector(initial_sector), ray_cast_thing(ray_cast_thing) {
+    return;
+}
+
+physics_presenter::segment_query_closest_contact::segment_query_closest_contact(const segment& cam_segment,
+        const maybe<contact>& prev_contact) {
+    maybe_if(prev_contact, [&](contact const &prev_ct) {
+        distance = length(prev_ct.position - std::get<0>(cam_segment));
+        has_contact = true;
+        maybe_if(prev_ct.contact_thing_id, [&](thing_id c) {
+            contact_thing_id = c;
+        });
+
+        maybe_if(prev_ct.contact_surface_id, [&](surface_id c) {
+            contact_surface_id = c;
+        });
+
+        position = prev_ct.position;
+        normal = prev_ct.normal;
+    });
+}
+
+gorc::maybe<contact> physics_presenter::segment_query_closest_contact::get_contact() const {
+    if(has_contact) {
+        contact new_contact(position, normal, make_zero_vector<3, float>());
+        if(contact_surface_id.is_valid()) {
+            new_contact.contact_surface_id = contact_surface_id;
+        }
+
+        if(contact_thing_id.is_valid()) {
+            new_contact.contact_thing_id = contact_thing_id;
+        }
+
+        return new_contact;
+    }
+
+    return nothing;
+}
+
+physics_presenter::segment_query_scratch::segment_query_scratch(physics_presenter& presenter)
+    : anim_node_visitor(presenter) {
+    return;
+}
+
+void physics_presenter::segment_query_batch_sectors(const std::vector<segment_query_request>& requests, size_t begin, size_t end,
+        segment_query_scratch& scratch) {
+    auto count = end - begin;
+    scratch.closed_sectors.resize(count);
+    scratch.surface_hits.resize(count);
+    for(size_t i = 0; i < count; ++i) {
+        scratch.closed_sectors[i].clear();
+        scratch.surface_hits[i].clear();
+    }
+
+    // Requests starting in the same sector share an open sector entry.
+    scratch.open_sectors.clear();
+    for(size_t i = 0; i < count; ++i) {
+        auto initial_sector = requests[begin + i].initial_sector;
+        auto it = std::find_if(scratch.open_sectors.begin(), scratch.open_sectors.end(), [&](auto const &open_sector) {
+                return std::get<0>(open_sector) == initial_sector;
+            });
+
+        if(it == scratch.open_sectors.end()) {
+            scratch.open_sectors.emplace_back(initial_sector, std::vector<size_t> { i });
+        }
+        else {
+            std::get<1>(*it).push_back(i);
+        }
+    }
+
+    while(!scratch.open_sectors.empty()) {
+        sector_id current_sector = std::get<0>(scratch.open_sectors.back());
+        auto queries = std::move(std::get<1>(scratch.open_sectors.back()));
+        scratch.open_sectors.pop_back();
+
+        scratch.active_queries.clear();
+        scratch.segments.clear();
+        for(auto query : queries) {
+            auto& closed_sectors = scratch.closed_sectors[query];
+            if(std::find(closed_sectors.begin(), closed_sectors.end(), current_sector) != closed_sectors.end()) {
+                continue;
+            }
+
+            closed_sectors.push_back(current_sector);
+            scratch.active_queries.push_back(query);
+            scratch.segments.push_back(requests[begin + query].query_segment);
+        }
+
+        if(scratch.active_queries.empty()) {
+            continue;
+        }
+
+        const auto& sector = at_id(model->sectors, current_sector);
+
+        for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
+            const auto& surface = model->surfaces[i];
+
+            model->collision_geometry.segment_surface_intersections(i, scratch.segments, scratch.intersections);
+
+            scratch.crossing_queries.clear();
+            for(size_t k = 0; k < scratch.active_queries.size(); ++k) {
+                auto u = scratch.intersections[k];
+                if(!(u >= 0.0f)) {
+                    continue;
+                }
+
+                auto query = scratch.active_queries[k];
+                const auto& query_segment = requests[begin + query].query_segment;
+                scratch.surface_hits[query].emplace_back(surface_id(i), lerp(std::get<0>(query_segment), std::get<1>(query_segment), u));
+
+                if(surface.adjoin >= 0) {
+                    scratch.crossing_queries.push_back(query);
+                }
+            }
+
+            if(scratch.crossing_queries.empty()) {
+                continue;
+            }
+
+            // Requests reaching the same sector through different adjoins share an entry.
+            auto it = std::find_if(scratch.open_sectors.begin(), scratch.open_sectors.end(), [&](auto const &open_sector) {
+                    return std::get<0>(open_sector) == surface.adjoined_sector;
+                });
+
+            if(it == scratch.open_sectors.end()) {
+                scratch.open_sectors.emplace_back(surface.adjoined_sector, scratch.crossing_queries);
+            }
+            else {
+                auto &queries = std::get<1>(*it);
+                queries.insert(queries.end(), scratch.crossing_queries.begin(), scratch.crossing_queries.end());
+            }
+        }
+    }
+}
+
+std::unique_ptr<physics_presenter::segment_query_scratch_set> physics_presenter::acquire_segment_query_scratch(
+        size_t job_count) {
+    std::unique_ptr<segment_query_scratch_set> scratch_set;
+    {
+        std::lock_guard<std::mutex> lock(query_scratch_lock);
+        if(!free_query_scratch.empty()) {
+            scratch_set = std::move(free_query_scratch.back());
+            free_query_scratch.pop_back();
+        }
+    }
+
+    if(!scratch_set) {
+        scratch_set = std::make_unique<segment_query_scratch_set>();
+    }
+
+    while(scratch_set->scratch.size() < job_count) {
+        scratch_set->scratch.push_back(std::make_unique<segment_query_scratch>(*this));
+    }
+
+    scratch_set->jobs.reserve(job_count);
+    return scratch_set;
+}
+
+void physics_presenter::release_segment_query_scratch(std::unique_ptr<segment_query_scratch_set> scratch_set) {
+    std::lock_guard<std::mutex> lock(query_scratch_lock);
+    free_query_scratch.push_back(std::move(scratch_set));
+}
+
+void physics_presenter::segment_query_batch_parallel(size_t count,
+        const std::function<void(size_t, size_t, segment_query_scratch&)>& query_range) {
+    size_t concurrency = maybe_if_else(workers, [](worker_pool *pool) { return pool->concurrency(); },
+                                       [] { return size_t(1); });
+    size_t job_count = std::max(size_t(1), std::min(concurrency, count));
+
+    auto scratch_set = acquire_segment_query_scratch(job_count);
+    scratch_set->query_range = &query_range;
+    scratch_set->count = count;
+    scratch_set->range_size = (count + job_count - 1) / job_count;
+
+    // Jobs only capture the set and their index, so they fit in std::function without allocating.
+    scratch_set->jobs.clear();
+    for(size_t i = 0; i < job_count; ++i) {
+        scratch_set->jobs.push_back([set = scratch_set.get(), i] {
+                size_t range_begin = std::min(set->count, i * set->range_size);
+                size_t range_end = std::min(set->count, range_begin + set->range_size);
+                (*set->query_range)(range_begin, range_end, *set->scratch[i]);
+            });
+    }
+
+    maybe_if_else(workers, [&](worker_pool *pool) {
+                pool->run(scratch_set->jobs);
+            },
+            [&] {
+                scratch_set->jobs.front()();
+            });
+
+    release_segment_query_scratch(std::move(scratch_set));
+}
+
 physics_presenter::segment_query_node_visitor::segment_query_node_visitor(physics_presenter& presenter)
     : presenter(presenter) {
     return;
@@ -739,7 +1202,11 @@ physics_presenter::segment_query_node_visitor::segment_query_node_visitor(physic
 void physics_presenter::segment_query_node_visitor::visit_mesh(asset_ref<content::assets::model> model, int mesh_id, int) {
     const auto& mesh = model->geosets.front().meshes[mesh_id];
 
-    for(const auto& face : mesh.faces) {
+    // Only test faces along the segment.
+    auto mesh_p0 = inverse_rigid_transform(current_matrix, std::get<0>(cam_segment));
+    auto mesh_p1 = inverse_rigid_transform(current_matrix, std::get<1>(cam_segment));
+    mesh.face_bvh.visit_faces(mesh_p0, mesh_p1, [&](size_t face_index) {
+        const auto& face = mesh.faces[face_index];
         auto maybe_nearest_point = physics::segment_surface_intersection_point(cam_segment, mesh, face, current_matrix);
         maybe_if(maybe_nearest_point, [&](vector<3> const &nearest_point) {
             auto dist = length(nearest_point - std::get<0>(cam_segment));
@@ -750,7 +1217,7 @@ void physics_presenter::segment_query_node_visitor::visit_mesh(asset_ref<content
                 closest_contact_normal = current_matrix.transform_normal(face.normal);
             }
         });
-    }
+    });
 }
 
 void physics_presenter::register_verbs(cog::verb_table&, level_state&) {
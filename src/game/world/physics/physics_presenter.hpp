@@ -2,12 +2,16 @@
 
 #include "utility/flag_set.hpp"
 #include "math/vector.hpp"
+#include "math/box.hpp"
 #include "game/world/components/thing.hpp"
 #include "libold/base/utility/time.hpp"
 #include "shape.hpp"
 #include "contact.hpp"
+#include <functional>
 #include <unordered_map>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_set>
 #include <vector>
@@ -16,8 +20,10 @@
 #include "game/world/level_presenter.hpp"
 #include "game/world/keys/key_presenter.hpp"
 #include "query.hpp"
+#include "collision_geometry.hpp"
 #include "shape.hpp"
 #include "jk/cog/script/verb_table.hpp"
+#include "utility/worker_pool.hpp"
 
 namespace gorc {
 namespace game {
@@ -30,35 +36,46 @@ class level_presenter;
 
 namespace physics {
 
+class segment_query_request {
+public:
+    segment query_segment;
+    sector_id initial_sector;
+    thing_id ray_cast_thing;
+
+    segment_query_request(const segment& query_segment, sector_id initial_sector, thing_id ray_cast_thing);
+};
+
 class physics_presenter {
 private:
     level_presenter& presenter;
     level_model* model;
     event_bus* eventbus;
 
-    std::unordered_multimap<thing_id, sector_id> physics_broadphase_thing_influence;
+    // Sectors overlapped by a thing's swept bounds. Kept between updates and only recomputed
+    // when the thing's bounds no longer produce the same sectors.
+    class thing_influence {
+    public:
+        box<3> bounds;
+        sector_id sector;
+        std::vector<sector_id> sectors;
+        size_t generation = 0;
+    };
+
+    std::unordered_map<thing_id, thing_influence> physics_broadphase_thing_influence;
     std::unordered_multimap<sector_id, thing_id> physics_broadphase_sector_things;
-    std::unordered_map<sector_id, int> physics_broadphase_sector_group;
+    std::vector<int> physics_broadphase_sector_parent;
+    std::vector<std::tuple<thing_id, int>> physics_broadphase_sorted_things;
+    std::vector<int> physics_broadphase_group_order;
     std::multimap<int, thing_id> physics_broadphase_thing_groups;
-    std::unordered_set<int> physics_broadphase_groups_to_merge;
+    size_t physics_broadphase_generation = 0;
     std::set<thing_id> physics_overlapping_things;
-    std::vector<physics::contact> physics_thing_resting_manifolds;
     std::set<sector_id> physics_thing_closed_set;
     std::vector<sector_id> physics_thing_open_set;
-    std::set<std::tuple<thing_id, thing_id>> physics_touched_thing_pairs;
-    std::set<std::tuple<thing_id, surface_id>> physics_touched_surface_pairs;
     std::set<sector_id> segment_query_closed_sectors;
     std::vector<sector_id> segment_query_open_sectors;
 
-    void physics_calculate_broadphase(double dt);
-    void physics_find_sector_resting_manifolds(const physics::sphere& sphere, sector_id, const vector<3>& vel_dir, thing_id current_thing_id);
-    void physics_find_thing_resting_manifolds(const physics::sphere& sphere, const vector<3>& vel_dir, thing_id current_thing_id);
-    void compute_current_velocity(components::thing &thing, double dt);
-    void compute_thing_attachment_velocity(components::thing &thing, double dt);
-    void physics_thing_step(thing_id, components::thing& thing, double dt);
-
-    void update_thing_path_moving(thing_id, components::thing& thing, double dt);
-    vector<3> get_thing_path_moving_point_velocity(thing_id, const vector<3>& rel_point);
+    using thing_group_iterator = std::multimap<int, thing_id>::iterator;
+    std::vector<std::tuple<thing_group_iterator, thing_group_iterator>> physics_broadphase_group_ranges;
 
     class physics_node_visitor {
     private:
@@ -91,7 +108,7 @@ private:
         thing_id moving_thing_id;
         thing_id visited_thing_id;
         physics::sphere sphere;
-    } physics_anim_node_visitor;
+    };
 
     class segment_query_node_visitor {
     private:
@@ -123,36 +140,219 @@ private:
         float closest_contact_distance;
     } segment_query_anim_node_visitor;
 
+    // Scratch state for solving broadphase groups. Each solver thread has its own.
+    class solver_scratch {
+    public:
+        std::vector<physics::contact> resting_manifolds;
+        std::set<thing_id> overlapping_things;
+        std::set<std::tuple<thing_id, thing_id>> touched_thing_pairs;
+        std::set<std::tuple<thing_id, surface_id>> touched_surface_pairs;
+        physics_node_visitor anim_node_visitor;
+
+        solver_scratch(physics_presenter& presenter);
+    };
+
+    // Side effects of a group solved on a worker thread. Applied on the calling thread, in
+    // group order, after all workers finish. Moves record the position and sector the thing
+    // moved from, and the position it moved to. Groups which touch cog linked sectors or
+    // surfaces are never deferred.
+    class deferred_group_effects {
+    public:
+        bool solved_in_parallel = false;
+        std::vector<std::tuple<thing_id, vector<3>, sector_id, vector<3>>> moves;
+        std::vector<thing_id> blocked_things;
+        std::vector<std::tuple<sector_id, surface_id>> adjoin_path;
+    };
+
+    // Closest contact found so far by a segment query.
+    class segment_query_closest_contact {
+    public:
+        float distance = std::numeric_limits<float>::max();
+        bool has_contact = false;
+        thing_id contact_thing_id = invalid_id;
+        surface_id contact_surface_id = invalid_id;
+        vector<3> position;
+        vector<3> normal;
+
+        segment_query_closest_contact(const segment& cam_segment, const maybe<contact>& prev_contact);
+
+        maybe<contact> get_contact() const;
+    };
+
+    // Scratch state for batched segment queries. Each query job has its own.
+    class segment_query_scratch {
+    public:
+        std::vector<std::tuple<sector_id, std::vector<size_t>>> open_sectors;
+        std::vector<std::vector<sector_id>> closed_sectors;
+        std::vector<std::vector<std::tuple<surface_id, vector<3>>>> surface_hits;
+        std::vector<size_t> active_queries;
+        std::vector<size_t> crossing_queries;
+        segment_batch segments;
+        std::vector<float> intersections;
+        std::set<thing_id> overlapping_things;
+        segment_query_node_visitor anim_node_visitor;
+
+        segment_query_scratch(physics_presenter& presenter);
+    };
+
+    // Reusable state for one segment query batch: a scratch for each job and the job list.
+    // Batches issued concurrently from other pool jobs each take their own set.
+    class segment_query_scratch_set {
+    public:
+        std::vector<std::unique_ptr<segment_query_scratch>> scratch;
+        std::vector<std::function<void()>> jobs;
+        const std::function<void(size_t, size_t, segment_query_scratch&)>* query_range = nullptr;
+        size_t count = 0;
+        size_t range_size = 0;
+    };
+
+    solver_scratch serial_scratch;
+    std::vector<std::unique_ptr<solver_scratch>> worker_scratch;
+    std::vector<deferred_group_effects> group_effects;
+    std::unordered_map<thing_id, std::tuple<vector<3>, sector_id>> replay_expected_state;
+    std::vector<size_t> parallel_groups;
+    std::vector<std::function<void()>> solver_jobs;
+    maybe<worker_pool*> workers;
+    std::mutex query_scratch_lock;
+    std::vector<std::unique_ptr<segment_query_scratch_set>> free_query_scratch;
+
+    void physics_calculate_broadphase(double dt);
+    bool physics_thing_influence_is_current(thing_influence const& influence, components::thing const& thing,
+            box<3> const& bounds);
+    void physics_compute_thing_influence(thing_id, thing_influence& influence, components::thing const& thing,
+            box<3> const& bounds);
+    void physics_erase_thing_influence(thing_id, thing_influence const& influence);
+    int physics_find_sector_group(int sector);
+    void physics_find_sector_resting_manifolds(const physics::sphere& sphere, sector_id, const vector<3>& vel_dir, thing_id current_thing_id,
+            solver_scratch& scratch);
+    void physics_find_thing_resting_manifolds(const physics::sphere& sphere, const vector<3>& vel_dir, thing_id current_thing_id,
+            solver_scratch& scratch);
+    void compute_current_velocity(components::thing &thing, double dt);
+    void compute_thing_attachment_velocity(components::thing &thing, double dt);
+    void physics_thing_step(thing_id, components::thing& thing, double dt, solver_scratch& scratch,
+            maybe<deferred_group_effects*> deferred);
+    void physics_move_thing(thing_id, components::thing& thing, const vector<3>& new_pos,
+            maybe<deferred_group_effects*> deferred);
+
+    bool physics_group_can_solve_in_parallel(thing_group_iterator begin, thing_group_iterator end);
+    void physics_solve_group(thing_group_iterator begin, thing_group_iterator end, double dt, solver_scratch& scratch,
+            maybe<deferred_group_effects*> deferred);
+    void physics_solve_groups_in_parallel(worker_pool& pool, double dt);
+    void physics_apply_deferred_group_effects(deferred_group_effects const& effects);
+
+    void update_thing_path_moving(thing_id, components::thing& thing, double dt);
+    vector<3> get_thing_path_moving_point_velocity(thing_id, const vector<3>& rel_point);
+
+    void segment_query_batch_sectors(const std::vector<segment_query_request>& requests, size_t begin, size_t end,
+            segment_query_scratch& scratch);
+    std::unique_ptr<segment_query_scratch_set> acquire_segment_query_scratch(size_t job_count);
+    void release_segment_query_scratch(std::unique_ptr<segment_query_scratch_set> scratch_set);
+    void segment_query_batch_parallel(size_t count,
+            const std::function<void(size_t, size_t, segment_query_scratch&)>& query_range);
+
+    template <typename ThingP> void segment_query_things(const segment& cam_segment, thing_id ray_cast_thing, ThingP& thing_p,
+            const std::set<thing_id>& overlapping_things, segment_query_node_visitor& visitor,
+            segment_query_closest_contact& closest) {
+        for(auto col_thing_id : overlapping_things) {
+            auto& col_thing = model->get_thing(col_thing_id);
+
+            if(col_thing_id == ray_cast_thing || !thing_p(col_thing_id)) {
+                continue;
+            }
+
+            if(col_thing.collide == flags::collide_type::sphere) {
+                auto maybe_int = segment_sphere_intersection(cam_segment, sphere(col_thing.position, col_thing.size));
+                maybe_if(maybe_int, [&](vector<3> const &int_point) {
+                    // Sphere intersected.
+                    float col_dist = length(int_point - std::get<0>(cam_segment));
+                    if(col_dist < closest.distance) {
+                        closest.distance = col_dist;
+                        closest.has_contact = true;
+                        closest.contact_surface_id = invalid_id;
+                        closest.contact_thing_id = col_thing_id;
+                        closest.normal = normalize(int_point - col_thing.position);
+                        closest.position = int_point;
+                    }
+                });
+            }
+            else if(col_thing.collide == flags::collide_type::face) {
+                if(!col_thing.model_3d.has_value()) {
+                    continue;
+                }
+
+                visitor.cam_segment = cam_segment;
+                visitor.closest_contact_distance = closest.distance;
+                visitor.has_closest_contact = false;
+                presenter.key_presenter->visit_mesh_hierarchy(visitor, col_thing.model_3d.get_value(), col_thing.position,
+                        col_thing.orient, col_thing_id, /* is pov mix */ false);
+
+                if(visitor.has_closest_contact) {
+                    closest.distance = visitor.closest_contact_distance;
+                    closest.has_contact = true;
+                    closest.contact_surface_id = invalid_id;
+                    closest.contact_thing_id = col_thing_id;
+                    closest.normal = visitor.closest_contact_normal;
+                    closest.position = visitor.closest_contact;
+                }
+            }
+        }
+    }
+
+    template <typename ThingP, typename SurfaceP> void segment_query_batch_range(const std::vector<segment_query_request>& requests,
+            size_t begin, size_t end, ThingP& thing_p, SurfaceP& surface_p, segment_query_scratch& scratch,
+            std::vector<maybe<contact>>& results) {
+        segment_query_batch_sectors(requests, begin, end, scratch);
+
+        for(size_t i = begin; i < end; ++i) {
+            const auto& request = requests[i];
+            segment_query_closest_contact closest(request.query_segment, maybe<contact>());
+
+            for(const auto& hit : scratch.surface_hits[i - begin]) {
+                surface_id sid;
+                vector<3> nearest_point;
+                std::tie(sid, nearest_point) = hit;
+
+                if(surface_p(sid)) {
+                    auto dist = length(nearest_point - std::get<0>(request.query_segment));
+                    if(dist < closest.distance) {
+                        closest.distance = dist;
+                        closest.has_contact = true;
+                        closest.contact_surface_id = sid;
+                        closest.position = nearest_point;
+                        closest.normal = at_id(model->surfaces, sid).normal;
+                    }
+                }
+            }
+
+            scratch.overlapping_things.clear();
+            for(auto sector_id : scratch.closed_sectors[i - begin]) {
+                auto influenced_thing_range = physics_broadphase_sector_things.equal_range(sector_id);
+                for(auto jt = std::get<0>(influenced_thing_range); jt != std::get<1>(influenced_thing_range); ++jt) {
+                    scratch.overlapping_things.emplace(jt->second);
+                }
+            }
+
+            segment_query_things(request.query_segment, request.ray_cast_thing, thing_p, scratch.overlapping_things,
+                    scratch.anim_node_visitor, closest);
+
+            results[i] = closest.get_contact();
+        }
+    }
+
 public:
     physics_presenter(level_presenter& presenter);
 
     void start(level_model& model, event_bus& eventbus);
     void update(const gorc::time& time);
 
+    // Independent broadphase groups are solved on the pool, unless they touch cog linked
+    // sectors or surfaces. Without a pool, every group is solved in order on the calling thread.
+    void set_worker_pool(maybe<worker_pool*> pool);
+
     template <typename ThingP, typename SurfaceP> maybe<contact> segment_query(const segment& cam_segment, sector_id initial_sector, thing_id ray_cast_thing,
             ThingP thing_p, SurfaceP surface_p, const maybe<contact>& prev_contact = maybe<contact>()) {
         // Search for closest thing-ray intersection.
-        float closest_contact_distance = std::numeric_limits<float>::max();
-        bool has_contact = false;
-        thing_id closest_contact_thing_id = invalid_id;
-        surface_id closest_contact_surface_id = invalid_id;
-        vector<3> closest_contact_position;
-        vector<3> closest_contact_normal;
-
-        maybe_if(prev_contact, [&](contact const &prev_ct) {
-            closest_contact_distance = length(prev_ct.position - std::get<0>(cam_segment));
-            has_contact = true;
-            maybe_if(prev_ct.contact_thing_id, [&](thing_id c) {
-                closest_contact_thing_id = c;
-            });
-
-            maybe_if(prev_ct.contact_surface_id, [&](surface_id c) {
-                closest_contact_surface_id = c;
-            });
-
-            closest_contact_position = prev_ct.position;
-            closest_contact_normal = prev_ct.normal;
-        });
+        segment_query_closest_contact closest(cam_segment, prev_contact);
 
         // Find contact among sectors.
         // Get list of sectors within thing influence.
@@ -174,16 +374,16 @@ public:
             for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
                 const auto& surface = model->surfaces[i];
 
-                auto maybe_nearest_point = physics::segment_surface_intersection_point(cam_segment, *model->level, surface);
+                auto maybe_nearest_point = model->collision_geometry.segment_surface_intersection_point(i, cam_segment);
                 maybe_if(maybe_nearest_point, [&](vector<3> const &nearest_point) {
                     if(surface_p(surface_id(i))) {
                         auto dist = length(nearest_point - std::get<0>(cam_segment));
-                        if(dist < closest_contact_distance) {
-                            closest_contact_distance = dist;
-                            has_contact = true;
-                            closest_contact_surface_id = surface_id(i);
-                            closest_contact_position = nearest_point;
-                            closest_contact_normal = surface.normal;
+                        if(dist < closest.distance) {
+                            closest.distance = dist;
+                            closest.has_contact = true;
+                            closest.contact_surface_id = surface_id(i);
+                            closest.position = nearest_point;
+                            closest.normal = surface.normal;
                         }
                     }
 
@@ -204,64 +404,21 @@ public:
             }
         }
 
-        for(auto col_thing_id : physics_overlapping_things) {
-            auto& col_thing = model->get_thing(col_thing_id);
-
-            if(col_thing_id == ray_cast_thing || !thing_p(col_thing_id)) {
-                continue;
-            }
+        segment_query_things(cam_segment, ray_cast_thing, thing_p, physics_overlapping_things, segment_query_anim_node_visitor, closest);
 
-            if(col_thing.collide == flags::collide_type::sphere) {
-                auto maybe_int = segment_sphere_intersection(cam_segment, sphere(col_thing.position, col_thing.size));
-                maybe_if(maybe_int, [&](vector<3> const &int_point) {
-                    // Sphere intersected.
-                    float col_dist = length(int_point - std::get<0>(cam_segment));
-                    if(col_dist < closest_contact_distance) {
-                        closest_contact_distance = col_dist;
-                        has_contact = true;
-                        closest_contact_surface_id = invalid_id;
-                        closest_contact_thing_id = col_thing_id;
-                        closest_contact_normal = normalize(int_point - col_thing.position);
-                        closest_contact_position = int_point;
-                    }
-                });
-            }
-            else if(col_thing.collide == flags::collide_type::face) {
-                if(!col_thing.model_3d.has_value()) {
-                    continue;
-                }
-
-                segment_query_anim_node_visitor.cam_segment = cam_segment;
-                segment_query_anim_node_visitor.closest_contact_distance = closest_contact_distance;
-                segment_query_anim_node_visitor.has_closest_contact = false;
-                presenter.key_presenter->visit_mesh_hierarchy(segment_query_anim_node_visitor, col_thing.model_3d.get_value(), col_thing.position,
-                        col_thing.orient, col_thing_id, /* is pov mix */ false);
-
-                if(segment_query_anim_node_visitor.has_closest_contact) {
-                    closest_contact_distance = segment_query_anim_node_visitor.closest_contact_distance;
-                    has_contact = true;
-                    closest_contact_surface_id = invalid_id;
-                    closest_contact_thing_id = col_thing_id;
-                    closest_contact_normal = segment_query_anim_node_visitor.closest_contact_normal;
-                    closest_contact_position = segment_query_anim_node_visitor.closest_contact;
-                }
-            }
-        }
-
-        if(has_contact) {
-            contact new_contact(closest_contact_position, closest_contact_normal, make_zero_vector<3, float>());
-            if(closest_contact_surface_id.is_valid()) {
-                new_contact.contact_surface_id = closest_contact_surface_id;
-            }
-
-            if(closest_contact_thing_id.is_valid()) {
-                new_contact.contact_thing_id = closest_contact_thing_id;
-            }
-
-            return new_contact;
-        }
+        return closest.get_contact();
+    }
 
-        return nothing;
+    // Finds the closest contact for each request, like segment_query. Requests waiting to
+    // enter the same sector share one pass over its surfaces, and each surface is tested
+    // against all of their segments at once. With a worker pool the requests are split
+    // between jobs, so the predicates must be safe to call concurrently.
+    template <typename ThingP, typename SurfaceP> void segment_query_batch(const std::vector<segment_query_request>& requests,
+            ThingP thing_p, SurfaceP surface_p, std::vector<maybe<contact>>& results) {
+        results.assign(requests.size(), maybe<contact>());
+        segment_query_batch_parallel(requests.size(), [&](size_t begin, size_t end, segment_query_scratch& scratch) {
+                segment_query_batch_range(requests, begin, end, thing_p, surface_p, scratch, results);
+            });
     }
 
     template <typename ThingP, typename SurfaceP> maybe<contact> thing_segment_query(thing_id current_thing_id, const vector<3>& direction,
@@ -3,16 +3,7 @@
 
 bool gorc::game::world::physics::point_inside_sector(const vector<3>& position, const level_model& model,
         const gorc::content::assets::level_sector& sec) {
-    for(int i = sec.first_surface; i < sec.first_surface + sec.surface_count; ++i) {
-        const auto& surf = model.level->surfaces[i];
-        const auto& p = model.level->vertices[std::get<0>(surf.vertices[0])];
-
-        if(dot(surf.normal, position - p) < 0.0f) {
-            return false;
-        }
-    }
-
-    return true;
+    return model.collision_geometry.point_inside_sector(sec.first_surface, sec.surface_count, position);
 }
 
 void gorc::game::world::physics::segment_adjoin_path(const segment& segment, const level_model& level,
@@ -33,8 +24,7 @@ void gorc::game::world::physics::segment_adjoin_path(const segment& segment, con
         bool has_continued = false;
         for(int surf_id = current_sector.first_surface; surf_id < current_sector.first_surface + current_sector.surface_count; ++surf_id) {
             auto& surf = level.surfaces[surf_id];
-            if(surf.adjoin >= 0 && dot(surf.normal, segment_dir) <= 0.0f && segment_surface_intersection(segment, *level.level,
-                    surf, make_identity_matrix<4, float>())) {
+            if(surf.adjoin >= 0 && dot(surf.normal, segment_dir) <= 0.0f && level.collision_geometry.segment_surface_intersection(surf_id, segment)) {
                 // Object passes through this adjoin, to the adjoined sector.
                 path.emplace_back(current_sector_id, surface_id(surf_id));
                 current_sector_id = surf.adjoined_sector;
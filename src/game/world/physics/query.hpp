@@ -15,6 +15,12 @@ namespace game {
 namespace world {
 namespace physics {
 
+// Maps a point into the space of a rigid transform. The inverse rotation is the transpose.
+inline vector<3> inverse_rigid_transform(const matrix<4>& trns, const vector<3>& v) {
+    auto translation = trns.transform(make_zero_vector<3, float>());
+    return trns.transpose().transform_normal(v - translation);
+}
+
 template <typename VertexProvider, typename EdgeProvider> bool point_inside_surface(const vector<3>& sp,
         const VertexProvider& level, const EdgeProvider& surface, const matrix<4>& trns) {
     for(size_t i = surface.vertices.size() - 1UL, j = 0UL; j < surface.vertices.size(); i = j++) {
@@ -49,7 +55,7 @@ template <typename VertexProvider, typename EdgeProvider> maybe<vector<3>> segme
     auto nrm = trns.transform_normal(surface.normal);
     auto p = trns.transform(level.vertices[std::get<0>(surface.vertices[0])]);
     auto u = dot(nrm, p - std::get<0>(segment)) / dot(nrm, std::get<1>(segment) - std::get<0>(segment));
-    if(u < 0.0f || u > 1.0f) {
+    if(!(u >= 0.0f && u <= 1.0f)) {
         return nothing;
     }
 
@@ -68,7 +74,7 @@ template <typename VertexProvider, typename EdgeProvider> maybe<vector<3>> segme
     auto nrm = surface.normal;
     auto p = level.vertices[std::get<0>(surface.vertices[0])];
     auto u = dot(nrm, p - std::get<0>(segment)) / dot(nrm, std::get<1>(segment) - std::get<0>(segment));
-    if(u < 0.0f || u > 1.0f) {
+    if(!(u >= 0.0f && u <= 1.0f)) {
         return nothing;
     }
 
@@ -87,7 +93,7 @@ template <typename VertexProvider, typename EdgeProvider> bool segment_surface_i
     auto nrm = trns.transform_normal(surface.normal);
     auto p = trns.transform(level.vertices[std::get<0>(surface.vertices[0])]);
     auto u = dot(nrm, p - std::get<0>(segment)) / dot(nrm, std::get<1>(segment) - std::get<0>(segment));
-    if(u < 0.0f || u > 1.0f) {
+    if(!(u >= 0.0f && u <= 1.0f)) {
         return false;
     }
 
@@ -102,7 +108,7 @@ template <typename VertexProvider, typename EdgeProvider> bool segment_surface_i
     auto nrm = surface.normal;
     auto p = level.vertices[std::get<0>(surface.vertices[0])];
     auto u = dot(nrm, p - std::get<0>(segment)) / dot(nrm, std::get<1>(segment) - std::get<0>(segment));
-    if(u < 0.0f || u > 1.0f) {
+    if(!(u >= 0.0f && u <= 1.0f)) {
         return false;
     }
 
@@ -3,6 +3,10 @@
 
 gorc::game::world::sounds::aspects::thing_sound_aspect::thing_sound_aspect(entity_component_system<thing_id> &cs)
     : inner_join_aspect(cs) {
+    // Moves each attached sound to its thing.
+    reads_component<components::thing_sound>();
+    reads_component<world::components::thing>();
+    writes_component<components::sound>();
     return;
 }
 
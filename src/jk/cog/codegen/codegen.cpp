@@ -5,11 +5,14 @@
 void gorc::cog::perform_code_generation(script &out_script,
                                         ast::translation_unit &tu,
                                         verb_table const &verbs,
-                                        constant_table const &constants)
+                                        constant_table const &constants,
+                                        bool optimize)
 {
     memory_file::writer text_writer(out_script.program);
     ir_printer ir(text_writer,
-                  out_script.exports);
+                  out_script.exports,
+                  out_script.call_sites,
+                  optimize);
 
     statement_gen_visitor sgv(out_script,
                               ir,
@@ -8,10 +8,12 @@
 namespace gorc {
     namespace cog {
 
+        // Changes to the emitted code must increment compiled_format_version in vm/opcode.hpp.
         void perform_code_generation(script &out_script,
                                      ast::translation_unit &tu,
                                      verb_table const &verbs,
-                                     constant_table const &constants);
+                                     constant_table const &constants,
+                                     bool optimize);
 
     }
 }
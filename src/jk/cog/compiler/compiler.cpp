@@ -4,6 +4,15 @@
 #include "log/log.hpp"
 #include "jk/cog/semantics/analyzer.hpp"
 #include "jk/cog/codegen/codegen.hpp"
+#include <functional>
+#include <unordered_set>
+
+gorc::cog::script_source::script_source(std::string const &filename, std::string const &text)
+    : filename(filename)
+    , text(text)
+{
+    return;
+}
 
 gorc::cog::compiler::compiler(verb_table &verbs,
                               constant_table &constants)
@@ -13,7 +22,138 @@ gorc::cog::compiler::compiler(verb_table &verbs,
     return;
 }
 
+void gorc::cog::compiler::set_cache(maybe<script_cache *> cache)
+{
+    this->cache = cache;
+}
+
+void gorc::cog::compiler::set_optimize(bool optimize)
+{
+    this->optimize = optimize;
+}
+
+void gorc::cog::compiler::set_precompile_threads(size_t threads)
+{
+    precompile_threads = threads;
+
+    precompile_workers.reset();
+    if(threads > 0) {
+        precompile_workers = std::make_unique<worker_pool>(threads);
+    }
+}
+
+size_t gorc::cog::compiler::get_precompile_threads() const
+{
+    return precompile_threads;
+}
+
+void gorc::cog::compiler::precompile(std::vector<script_source> const &sources)
+{
+    prepared_scripts.clear();
+
+    if(!precompile_workers) {
+        return;
+    }
+
+    // Identical sources are compiled once, so workers never store the same cache entry.
+    std::vector<script_source const *> unique_sources;
+    std::unordered_set<std::string> seen_sources;
+    for(auto const &src : sources) {
+        if(seen_sources.insert(src.text).second) {
+            unique_sources.push_back(&src);
+        }
+    }
+
+    std::vector<prepared_script> results(unique_sources.size());
+
+    std::vector<std::function<void()>> jobs;
+    for(size_t i = 0; i < unique_sources.size(); ++i) {
+        jobs.push_back([&, i] {
+                auto const &src = *unique_sources[i];
+                auto &result = results[i];
+
+                log_capture capture;
+                try {
+                    diagnostic_context dc(src.filename.c_str());
+
+                    memory_file source;
+                    source.write(src.text.data(), src.text.size());
+                    result.compiled = compile_memory(source);
+                }
+                catch(...) {
+                    // Compiled again when loaded, so the errors are reported in load order
+                    result.compiled.reset();
+                }
+
+                result.diagnostics = std::move(capture.messages);
+            });
+    }
+
+    precompile_workers->run(jobs);
+
+    for(size_t i = 0; i < unique_sources.size(); ++i) {
+        if(results[i].compiled) {
+            prepared_scripts.emplace(unique_sources[i]->text, std::move(results[i]));
+        }
+    }
+}
+
+bool gorc::cog::compiler::can_cache_scripts() const
+{
+    return true;
+}
+
+bool gorc::cog::compiler::uses_cache() const
+{
+    return cache.has_value() && can_cache_scripts();
+}
+
 std::unique_ptr<gorc::cog::script> gorc::cog::compiler::compile(input_stream &f)
+{
+    if(prepared_scripts.empty() && !uses_cache()) {
+        return compile_source(f);
+    }
+
+    memory_file source;
+    f.copy_to(source);
+
+    auto prepared_it = prepared_scripts.find(std::string(source.data(), source.size()));
+    if(prepared_it != prepared_scripts.end()) {
+        auto prepared = std::move(prepared_it->second);
+        prepared_scripts.erase(prepared_it);
+
+        replay_log_messages(prepared.diagnostics);
+        prepared.compiled->filename = diagnostic_file_name();
+        return std::move(prepared.compiled);
+    }
+
+    return compile_memory(source);
+}
+
+std::unique_ptr<gorc::cog::script> gorc::cog::compiler::compile_memory(memory_file const &source)
+{
+    memory_file::reader source_reader(source);
+    if(!uses_cache()) {
+        return compile_source(source_reader);
+    }
+
+    script_cache_key key(source, verbs, constants, optimize);
+    auto cached_script = cache.get_value()->load(key);
+    if(cached_script) {
+        cached_script->filename = diagnostic_file_name();
+        return cached_script;
+    }
+
+    // Scripts with diagnostics are recompiled on every load, so the diagnostics are not lost.
+    auto script = compile_source(source_reader);
+    if(diagnostic_file_warning_count() == 0) {
+        cache.get_value()->store(key, *script);
+    }
+
+    return script;
+}
+
+std::unique_ptr<gorc::cog::script> gorc::cog::compiler::compile_source(input_stream &f)
 {
     ast_factory ast_factory;
     cog::grammar grammar(f, ast_factory);
@@ -48,7 +188,8 @@ std::unique_ptr<gorc::cog::script> gorc::cog::compiler::compile(input_stream &f)
     cog::perform_code_generation(*script,
                                  *tu,
                                  verbs,
-                                 constants);
+                                 constants,
+                                 optimize);
 
     // Abort after any code generation error
     LOG_FATAL_ASSERT(diagnostic_file_error_count() == 0,
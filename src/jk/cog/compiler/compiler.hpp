@@ -5,20 +5,77 @@
 #include "jk/cog/script/constant_table.hpp"
 #include "jk/cog/script/script.hpp"
 #include "jk/cog/ast/ast.hpp"
+#include "script_cache.hpp"
+#include "io/memory_file.hpp"
+#include "log/log_capture.hpp"
+#include "utility/maybe.hpp"
+#include "utility/worker_pool.hpp"
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace gorc {
     namespace cog {
 
+        class script_source {
+        public:
+            std::string filename;
+            std::string text;
+
+            script_source(std::string const &filename, std::string const &text);
+        };
+
         class compiler {
+        private:
+            class prepared_script {
+            public:
+                std::unique_ptr<script> compiled;
+                std::vector<captured_log_message> diagnostics;
+            };
+
+            // Precompiled scripts, keyed by source text
+            std::unordered_map<std::string, prepared_script> prepared_scripts;
+            size_t precompile_threads = 0;
+            std::unique_ptr<worker_pool> precompile_workers;
+
+            std::unique_ptr<script> compile_memory(memory_file const &);
+            bool uses_cache() const;
+
         protected:
             verb_table &verbs;
             constant_table &constants;
+            maybe<script_cache *> cache;
+            bool optimize = true;
+
+            std::unique_ptr<script> compile_source(input_stream &);
+
+            // Compilers whose hooks must observe every compile, or which return early from
+            // them, override this to return false. Cached loads skip the hooks.
+            virtual bool can_cache_scripts() const;
 
         public:
             compiler(verb_table &verbs,
                      constant_table &constants);
 
+            // Compiled scripts are loaded from and stored to the cache, when one is set and
+            // can_cache_scripts() returns true.
+            void set_cache(maybe<script_cache *> cache);
+
+            // Generated code is optimized by default.
+            void set_optimize(bool optimize);
+
+            // Precompilation is disabled by default.
+            void set_precompile_threads(size_t threads);
+            size_t get_precompile_threads() const;
+
+            // Compiles the sources concurrently. Scripts which compile without errors are held
+            // until compile() is called with identical source text, and their diagnostics are
+            // reported then, so the log reads as if the scripts were compiled one at a time.
+            // Sources which fail are left for compile() to report. Compiler hooks are called
+            // from the worker threads.
+            void precompile(std::vector<script_source> const &sources);
+
             std::unique_ptr<script> compile(input_stream &);
 
             virtual bool handle_parsed_ast(ast::translation_unit &);
@@ -0,0 +1,414 @@
+#include "script_cache.hpp"
+#include "jk/cog/vm/decoded_program.hpp"
+#include "jk/cog/vm/opcode.hpp"
+#include "io/binary_input_stream.hpp"
+#include "io/binary_output_stream.hpp"
+#include "io/native_file.hpp"
+#include "log/log.hpp"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    // Increment when the entry layout changes. Changes to compiled programs increment
+    // cog::compiled_format_version instead.
+    constexpr uint32_t cache_format_version = 1;
+
+    class fnv1a_hash {
+    public:
+        uint64_t hash = 14695981039346656037ULL;
+
+        void add(void const *data, size_t size)
+        {
+            auto const *bytes = reinterpret_cast<unsigned char const *>(data);
+            for(size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        template <typename T>
+        void add_value(T const &v)
+        {
+            static_assert(std::is_fundamental<T>::value, "hashed values must be fundamental");
+            add(&v, sizeof(T));
+        }
+
+        void add_string(std::string const &str)
+        {
+            add_value(str.size());
+            add(str.data(), str.size());
+        }
+
+        void add_cog_value(gorc::cog::value const &v)
+        {
+            using gorc::cog::value_type;
+
+            add_value(static_cast<uint8_t>(v.get_type()));
+            switch(v.get_type()) {
+            case value_type::nothing:
+            case value_type::dynamic:
+                break;
+
+            case value_type::string:
+                add_string(static_cast<char const *>(v));
+                break;
+
+            case value_type::boolean:
+                add_value(static_cast<bool>(v));
+                break;
+
+            case value_type::floating:
+                add_value(static_cast<float>(v));
+                break;
+
+            case value_type::vector: {
+                    auto vec = static_cast<gorc::vector<3>>(v);
+                    add_value(gorc::get<0>(vec));
+                    add_value(gorc::get<1>(vec));
+                    add_value(gorc::get<2>(vec));
+                }
+                break;
+
+            default:
+                add_value(static_cast<int>(v));
+                break;
+            }
+        }
+    };
+
+    // Values are stored with string pointers replaced by string table indices.
+    bool serialize_cached_value(gorc::binary_output_stream &bos,
+                                gorc::cog::value const &v,
+                                std::unordered_map<char const *, size_t> const &string_index)
+    {
+        gorc::binary_serialize(bos, v.get_type());
+        if(v.get_type() == gorc::cog::value_type::string) {
+            auto it = string_index.find(static_cast<char const *>(v));
+            if(it == string_index.end()) {
+                return false;
+            }
+
+            gorc::binary_serialize<size_t>(bos, it->second);
+        }
+        else {
+            gorc::binary_serialize(bos, v);
+        }
+
+        return true;
+    }
+
+    gorc::cog::value deserialize_cached_value(gorc::binary_input_stream &bis,
+                                              std::vector<char const *> const &strings)
+    {
+        auto type = gorc::binary_deserialize<gorc::cog::value_type>(bis);
+        if(type == gorc::cog::value_type::string) {
+            return gorc::cog::value(strings.at(gorc::binary_deserialize<size_t>(bis)));
+        }
+        else {
+            return gorc::binary_deserialize<gorc::cog::value>(bis);
+        }
+    }
+
+    std::string to_hex(uint64_t v)
+    {
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << v;
+        return ss.str();
+    }
+}
+
+gorc::cog::script_cache_key::script_cache_key(memory_file const &source,
+                                              verb_table const &verbs,
+                                              constant_table const &constants,
+                                              bool optimized)
+{
+    fnv1a_hash src;
+    src.add(source.data(), source.size());
+    source_hash = src.hash;
+
+    // Compiled programs refer to verbs by index and embed constant values.
+    fnv1a_hash tables;
+    tables.add_value(cache_format_version);
+    tables.add_value(compiled_format_version);
+    tables.add_value(sizeof(value));
+    tables.add_value(optimized);
+
+    for(size_t i = 0; i < verbs.size(); ++i) {
+        auto const &v = verbs.get_verb(verb_id(static_cast<int>(i)));
+        tables.add_string(v.name);
+        tables.add_value(static_cast<uint8_t>(v.return_type));
+        tables.add_value(v.argument_types.size());
+        for(auto const &arg : v.argument_types) {
+            tables.add_value(static_cast<uint8_t>(arg));
+        }
+    }
+
+    std::vector<std::tuple<std::string, int, bool>> verb_names;
+    for(auto const &em : verbs.get_verb_index()) {
+        verb_names.emplace_back(em.first, std::get<0>(em.second), std::get<1>(em.second));
+    }
+
+    std::sort(verb_names.begin(), verb_names.end());
+    for(auto const &em : verb_names) {
+        tables.add_string(std::get<0>(em));
+        tables.add_value(std::get<1>(em));
+        tables.add_value(std::get<2>(em));
+    }
+
+    std::vector<std::string> constant_names;
+    for(auto const &em : constants) {
+        constant_names.push_back(em.first);
+    }
+
+    std::sort(constant_names.begin(), constant_names.end());
+    for(auto const &name : constant_names) {
+        tables.add_string(name);
+        tables.add_cog_value(constants.at(name));
+    }
+
+    table_fingerprint = tables.hash;
+}
+
+gorc::cog::script_cache::script_cache(path const &directory)
+    : directory(directory)
+{
+    return;
+}
+
+gorc::path gorc::cog::script_cache::entry_path(script_cache_key const &key) const
+{
+    return directory / (to_hex(key.source_hash) + "-" + to_hex(key.table_fingerprint) + ".cogc");
+}
+
+std::unique_ptr<gorc::cog::script> gorc::cog::script_cache::load(script_cache_key const &key) const
+{
+    path entry = entry_path(key);
+    if(!boost::filesystem::exists(entry)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<script> rv;
+    bool damaged = false;
+
+    {
+        // Errors in a damaged entry belong to the entry, not to the script being loaded. They
+        // are discarded, and the script is compiled again.
+        std::string entry_name = entry.generic_string();
+        log_capture discarded_diagnostics;
+        diagnostic_context dc(entry_name.c_str());
+
+        try {
+            rv = read_entry(entry, key);
+        }
+        catch(std::exception const &) {
+            damaged = true;
+        }
+    }
+
+    if(damaged) {
+        LOG_INFO(format("discarding damaged script cache entry %s") % entry.generic_string());
+
+        boost::system::error_code ec;
+        boost::filesystem::remove(entry, ec);
+    }
+
+    return rv;
+}
+
+std::unique_ptr<gorc::cog::script> gorc::cog::script_cache::read_entry(path const &entry,
+                                                                       script_cache_key const &key) const
+{
+    auto f = make_native_read_only_file(entry);
+    binary_input_stream bis(*f);
+
+    auto version = binary_deserialize<uint32_t>(bis);
+    auto source_hash = binary_deserialize<uint64_t>(bis);
+    auto table_fingerprint = binary_deserialize<uint64_t>(bis);
+    if(version != cache_format_version ||
+       source_hash != key.source_hash ||
+       table_fingerprint != key.table_fingerprint) {
+        return nullptr;
+    }
+
+    auto rv = std::make_unique<script>();
+
+    std::vector<char const *> strings;
+    size_t num_strings = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_strings; ++i) {
+        strings.push_back(rv->strings.add_string(binary_deserialize<std::string>(bis)));
+    }
+
+    size_t num_symbols = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_symbols; ++i) {
+        auto type = binary_deserialize<value_type>(bis);
+        auto name = binary_deserialize<std::string>(bis);
+        auto default_value = deserialize_cached_value(bis, strings);
+        auto local = binary_deserialize<bool>(bis);
+        auto desc = binary_deserialize<std::string>(bis);
+        auto mask = binary_deserialize<flag_set<source_type>>(bis);
+        auto link_id = binary_deserialize<int>(bis);
+        auto no_link = binary_deserialize<bool>(bis);
+
+        rv->symbols.add_symbol(type,
+                               name,
+                               default_value,
+                               local,
+                               desc,
+                               mask,
+                               link_id,
+                               no_link);
+    }
+
+    size_t num_exports = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_exports; ++i) {
+        auto msg = binary_deserialize<message_type>(bis);
+        auto offset = binary_deserialize<size_t>(bis);
+        rv->exports.set_offset(msg, offset);
+    }
+
+    size_t num_call_sites = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_call_sites; ++i) {
+        auto offset = binary_deserialize<size_t>(bis);
+        auto first_line = binary_deserialize<int>(bis);
+        auto first_col = binary_deserialize<int>(bis);
+        auto last_line = binary_deserialize<int>(bis);
+        auto last_col = binary_deserialize<int>(bis);
+
+        // The virtual machine substitutes the script filename
+        rv->call_sites.set_range(offset, diagnostic_context_location(nothing,
+                                                                     first_line,
+                                                                     first_col,
+                                                                     last_line,
+                                                                     last_col));
+    }
+
+    size_t program_size = binary_deserialize<size_t>(bis);
+    std::vector<char> program(program_size);
+    bis.read(program.data(), program_size);
+    rv->program.write(program.data(), program_size);
+
+    // Restore string pointers in PUSH immediates
+    memory_file::writer &program_writer = rv->program;
+    binary_output_stream pbos(program_writer);
+
+    size_t num_relocations = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_relocations; ++i) {
+        auto program_counter = binary_deserialize<size_t>(bis);
+        auto string_index = binary_deserialize<size_t>(bis);
+
+        program_writer.set_position(program_counter);
+        binary_serialize(pbos, opcode::push);
+        binary_serialize(pbos, value(strings.at(string_index)));
+    }
+
+    program_writer.set_position(program_size);
+
+    // Validate relocated program text
+    decoded_program validate(rv->program);
+
+    return rv;
+}
+
+void gorc::cog::script_cache::store(script_cache_key const &key, script const &s) const
+{
+    std::unordered_map<char const *, size_t> string_index;
+    for(auto const &str : s.strings) {
+        string_index.emplace(str->c_str(), string_index.size());
+    }
+
+    memory_file buffer;
+    binary_output_stream bos(buffer);
+
+    binary_serialize<uint32_t>(bos, cache_format_version);
+    binary_serialize<uint64_t>(bos, key.source_hash);
+    binary_serialize<uint64_t>(bos, key.table_fingerprint);
+
+    binary_serialize_range(bos, s.strings, [](auto &bos, auto const &em) {
+            binary_serialize(bos, *em);
+        });
+
+    binary_serialize<size_t>(bos, s.symbols.size());
+    for(auto const &sym : s.symbols) {
+        binary_serialize(bos, sym.type);
+        binary_serialize(bos, sym.name);
+        if(!serialize_cached_value(bos, sym.default_value, string_index)) {
+            return;
+        }
+
+        binary_serialize(bos, sym.local);
+        binary_serialize(bos, sym.desc);
+        binary_serialize(bos, sym.mask);
+        binary_serialize(bos, sym.link_id);
+        binary_serialize(bos, sym.no_link);
+    }
+
+    std::vector<std::pair<message_type, size_t>> exports(s.exports.begin(), s.exports.end());
+    std::sort(exports.begin(), exports.end());
+    binary_serialize_range(bos, exports, [](auto &bos, auto const &em) {
+            binary_serialize(bos, em.first);
+            binary_serialize(bos, em.second);
+        });
+
+    binary_serialize_range(bos, s.call_sites, [](auto &bos, auto const &em) {
+            binary_serialize(bos, em.first);
+            binary_serialize(bos, em.second.first_line);
+            binary_serialize(bos, em.second.first_col);
+            binary_serialize(bos, em.second.last_line);
+            binary_serialize(bos, em.second.last_col);
+        });
+
+    std::vector<std::pair<size_t, size_t>> relocations;
+    decoded_program program(s.program);
+    for(size_t i = 0; i < program.size(); ++i) {
+        auto const &inst = program.data()[i];
+        if(inst.op != opcode::push || inst.immediate.get_type() != value_type::string) {
+            continue;
+        }
+
+        auto it = string_index.find(static_cast<char const *>(inst.immediate));
+        if(it == string_index.end()) {
+            return;
+        }
+
+        relocations.emplace_back(inst.program_counter, it->second);
+    }
+
+    binary_serialize<size_t>(bos, s.program.size());
+    bos.write(s.program.data(), s.program.size());
+
+    binary_serialize_range(bos, relocations, [](auto &bos, auto const &em) {
+            binary_serialize(bos, em.first);
+            binary_serialize(bos, em.second);
+        });
+
+    // Processes sharing the directory may store the same entry concurrently. Each writes its
+    // own temporary file, and the last rename wins.
+    path entry = entry_path(key);
+    path temp_entry = entry.parent_path() /
+                      boost::filesystem::unique_path(entry.filename().string() + ".%%%%-%%%%.tmp");
+
+    try {
+        boost::filesystem::create_directories(directory);
+
+        {
+            auto f = make_native_file(temp_entry);
+            buffer.copy_to(*f);
+        }
+
+        boost::filesystem::rename(temp_entry, entry);
+    }
+    catch(std::exception const &e) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp_entry, ec);
+
+        LOG_WARNING(format("could not write script cache entry %s: %s") %
+                    entry.generic_string() %
+                    e.what());
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "jk/cog/script/script.hpp"
+#include "jk/cog/script/verb_table.hpp"
+#include "jk/cog/script/constant_table.hpp"
+#include "io/memory_file.hpp"
+#include "io/path.hpp"
+#include <cstdint>
+#include <memory>
+
+namespace gorc {
+    namespace cog {
+
+        class script_cache_key {
+        public:
+            uint64_t source_hash;
+            uint64_t table_fingerprint;
+
+            script_cache_key(memory_file const &source,
+                             verb_table const &verbs,
+                             constant_table const &constants,
+                             bool optimized);
+        };
+
+        // On-disk cache of compiled scripts. Entries are keyed by the script source and by a
+        // fingerprint of the verb and constant tables the script was compiled against, and of
+        // the compiled program format version.
+        class script_cache {
+        private:
+            path directory;
+
+            path entry_path(script_cache_key const &key) const;
+            std::unique_ptr<script> read_entry(path const &entry, script_cache_key const &key) const;
+
+        public:
+            explicit script_cache(path const &directory);
+
+            // Returns nullptr if there is no valid entry for the key. Damaged entries are deleted
+            // without counting diagnostics against the script being loaded.
+            std::unique_ptr<script> load(script_cache_key const &key) const;
+
+            // Scripts which cannot be relocated, and write failures, are not cached.
+            void store(script_cache_key const &key, script const &) const;
+        };
+
+    }
+}
@@ -0,0 +1,175 @@
+#include "test/test.hpp"
+#include "jk/cog/compiler/compiler.hpp"
+#include "jk/cog/vm/default_verbs.hpp"
+#include "log/diagnostic_context.hpp"
+#include <boost/filesystem.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gorc;
+
+namespace {
+
+    std::string const script_text =
+        "symbols\n"
+        "message startup\n"
+        "end\n"
+        "code\n"
+        "startup:\n"
+        "    setpulse(1.0);\n"
+        "    return;\n"
+        "end\n";
+
+    // Stops after parsing, like cogcheck's parse-only mode.
+    class parse_only_compiler : public cog::compiler {
+    protected:
+        virtual bool can_cache_scripts() const override
+        {
+            return false;
+        }
+
+    public:
+        int parsed_count = 0;
+
+        parse_only_compiler(cog::verb_table &verbs, cog::constant_table &constants)
+            : cog::compiler(verbs, constants)
+        {
+            return;
+        }
+
+        virtual bool handle_parsed_ast(cog::ast::translation_unit &) override
+        {
+            ++parsed_count;
+            return false;
+        }
+    };
+
+    class derived_compiler : public cog::compiler {
+    public:
+        derived_compiler(cog::verb_table &verbs, cog::constant_table &constants)
+            : cog::compiler(verbs, constants)
+        {
+            return;
+        }
+    };
+
+    class compiler_fixture : public test::fixture {
+    public:
+        cog::verb_table verbs;
+        cog::constant_table constants;
+        path cache_directory;
+        cog::script_cache cache;
+
+        compiler_fixture()
+            : cache_directory(boost::filesystem::temp_directory_path() /
+                              boost::filesystem::unique_path("compiler-test-%%%%-%%%%-%%%%"))
+            , cache(cache_directory)
+        {
+            cog::default_populate_verb_table(verbs);
+            cog::default_populate_constant_table(constants);
+            boost::filesystem::create_directories(cache_directory);
+        }
+
+        ~compiler_fixture()
+        {
+            boost::filesystem::remove_all(cache_directory);
+        }
+
+        std::unique_ptr<cog::script> compile(cog::compiler &c)
+        {
+            diagnostic_context dc("test.cog");
+
+            memory_file source;
+            source.write(script_text.data(), script_text.size());
+            memory_file::reader source_reader(source);
+            return c.compile(source_reader);
+        }
+
+        size_t cache_entry_count() const
+        {
+            return static_cast<size_t>(std::distance(boost::filesystem::directory_iterator(cache_directory),
+                                                     boost::filesystem::directory_iterator()));
+        }
+    };
+
+}
+
+begin_suite_fixture(compiler_test, compiler_fixture);
+
+test_case(base_compiler_uses_cache)
+{
+    cog::compiler c(verbs, constants);
+    c.set_cache(&cache);
+
+    auto fresh = compile(c);
+    assert_eq(cache_entry_count(), size_t(1));
+
+    auto cached = compile(c);
+    assert_eq(cached->program.size(), fresh->program.size());
+}
+
+test_case(derived_compiler_uses_cache)
+{
+    derived_compiler c(verbs, constants);
+    c.set_cache(&cache);
+
+    compile(c);
+    assert_eq(cache_entry_count(), size_t(1));
+}
+
+test_case(opted_out_compiler_bypasses_cache)
+{
+    parse_only_compiler c(verbs, constants);
+    c.set_cache(&cache);
+
+    auto first = compile(c);
+    auto second = compile(c);
+
+    // Hooks run on every compile, and scripts returned early are not stored
+    assert_eq(c.parsed_count, 2);
+    assert_eq(second->program.size(), size_t(0));
+    assert_eq(cache_entry_count(), size_t(0));
+
+    // A full compile sharing the cache is not served the incomplete script
+    cog::compiler full(verbs, constants);
+    full.set_cache(&cache);
+    assert_true(compile(full)->program.size() > 0);
+    assert_eq(cache_entry_count(), size_t(1));
+}
+
+test_case(concurrent_stores_share_directory)
+{
+    cog::compiler c(verbs, constants);
+    auto compiled = compile(c);
+
+    memory_file source;
+    source.write(script_text.data(), script_text.size());
+    cog::script_cache_key key(source, verbs, constants, true);
+
+    // Processes sharing a cache directory each have their own cache
+    std::vector<std::unique_ptr<cog::script_cache>> caches;
+    std::vector<std::thread> writers;
+    for(int i = 0; i < 4; ++i) {
+        caches.push_back(std::make_unique<cog::script_cache>(cache_directory));
+    }
+
+    for(auto &writer_cache : caches) {
+        cog::script_cache const &store_cache = *writer_cache;
+        writers.emplace_back([&] {
+                for(int j = 0; j < 50; ++j) {
+                    store_cache.store(key, *compiled);
+                }
+            });
+    }
+
+    for(auto &writer : writers) {
+        writer.join();
+    }
+
+    assert_log_empty();
+    assert_eq(cache_entry_count(), size_t(1));
+    assert_eq(cache.load(key)->program.size(), compiled->program.size());
+}
+
+end_suite(compiler_test);
@@ -0,0 +1,37 @@
+#include "ir_instruction.hpp"
+
+gorc::cog::ir_instruction::ir_instruction(opcode op)
+    : op(op)
+{
+    return;
+}
+
+gorc::cog::ir_instruction::ir_instruction(label_id lid)
+    : type(ir_instruction_type::label)
+    , target(lid)
+{
+    return;
+}
+
+bool gorc::cog::ir_instruction::is_label() const
+{
+    return type == ir_instruction_type::label;
+}
+
+bool gorc::cog::ir_instruction::is_branch() const
+{
+    if(type != ir_instruction_type::instruction) {
+        return false;
+    }
+
+    switch(op) {
+    case opcode::jmp:
+    case opcode::jal:
+    case opcode::bt:
+    case opcode::bf:
+        return true;
+
+    default:
+        return false;
+    }
+}
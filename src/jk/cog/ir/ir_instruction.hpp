@@ -0,0 +1,39 @@
+#pragma once
+
+#include "jk/cog/script/value.hpp"
+#include "jk/cog/vm/opcode.hpp"
+#include "log/diagnostic_context_location.hpp"
+#include "content/id.hpp"
+#include "label_id.hpp"
+#include <cstddef>
+
+namespace gorc {
+    namespace cog {
+
+        enum class ir_instruction_type {
+            instruction,
+            label
+        };
+
+        // Instruction buffered by the IR printer. Labels are zero-width markers in the
+        // instruction stream and use the target field as their id.
+        class ir_instruction {
+        public:
+            ir_instruction_type type = ir_instruction_type::instruction;
+            opcode op = opcode::ret;
+
+            value immediate;
+            size_t address = 0;
+            label_id target;
+            verb_id verb;
+            diagnostic_context_location location;
+
+            explicit ir_instruction(opcode op);
+            explicit ir_instruction(label_id lid);
+
+            bool is_label() const;
+            bool is_branch() const;
+        };
+
+    }
+}
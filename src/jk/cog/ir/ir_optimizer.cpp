@@ -0,0 +1,344 @@
+#include "ir_optimizer.hpp"
+#include "utility/maybe.hpp"
+#include <unordered_map>
+
+using namespace gorc;
+using namespace gorc::cog;
+
+namespace {
+
+    bool is_op(ir_instruction const &instr, opcode op)
+    {
+        return !instr.is_label() && instr.op == op;
+    }
+
+    bool is_foldable_operand(value const &v)
+    {
+        switch(v.get_type()) {
+        case value_type::integer:
+        case value_type::floating:
+        case value_type::boolean:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    // Integer division by zero, and INT_MIN / -1, are left for the VM to evaluate.
+    bool is_safe_division(opcode op, value const &left, value const &right)
+    {
+        bool integer_division = (op == opcode::mod) ||
+                                (left.get_type() != value_type::floating &&
+                                 right.get_type() != value_type::floating);
+        if(!integer_division) {
+            return true;
+        }
+
+        int divisor = static_cast<int>(right);
+        return divisor != 0 && divisor != -1;
+    }
+
+    // Evaluates operators exactly as the virtual machine does.
+    maybe<value> fold_binary(opcode op, value const &left, value const &right)
+    {
+        if(!is_foldable_operand(left) || !is_foldable_operand(right)) {
+            return nothing;
+        }
+
+        switch(op) {
+        case opcode::add:
+            return left + right;
+        case opcode::sub:
+            return left - right;
+        case opcode::mul:
+            return left * right;
+        case opcode::div:
+            if(!is_safe_division(op, left, right)) {
+                return nothing;
+            }
+
+            return left / right;
+        case opcode::mod:
+            if(!is_safe_division(op, left, right)) {
+                return nothing;
+            }
+
+            return left % right;
+        case opcode::bor:
+            return left | right;
+        case opcode::band:
+            return left & right;
+        case opcode::bxor:
+            return left ^ right;
+        case opcode::lor:
+            return left || right;
+        case opcode::land:
+            return left && right;
+        case opcode::eq:
+            return left == right;
+        case opcode::ne:
+            return left != right;
+        case opcode::gt:
+            return left > right;
+        case opcode::ge:
+            return left >= right;
+        case opcode::lt:
+            return left < right;
+        case opcode::le:
+            return left <= right;
+        default:
+            return nothing;
+        }
+    }
+
+    maybe<value> fold_unary(opcode op, value const &operand)
+    {
+        if(!is_foldable_operand(operand)) {
+            return nothing;
+        }
+
+        switch(op) {
+        case opcode::neg:
+            return -operand;
+        case opcode::lnot:
+            return !operand;
+        default:
+            return nothing;
+        }
+    }
+
+    // Rewrites the last few instructions of a partially rebuilt program.
+    // Label markers end a window, so patterns never span a branch target.
+    bool rewrite_tail(std::vector<ir_instruction> &out)
+    {
+        size_t n = out.size();
+
+        // push a; push b; op -> push (a op b)
+        if(n >= 3 &&
+           is_op(out[n - 3], opcode::push) &&
+           is_op(out[n - 2], opcode::push) &&
+           !out[n - 1].is_label()) {
+            auto folded = fold_binary(out[n - 1].op, out[n - 3].immediate, out[n - 2].immediate);
+            if(folded.has_value()) {
+                out.erase(out.end() - 2, out.end());
+                out.back().immediate = folded.get_value();
+                return true;
+            }
+        }
+
+        if(n >= 2 && is_op(out[n - 2], opcode::push) && !out[n - 1].is_label()) {
+            // push a; op -> push (op a)
+            auto folded = fold_unary(out[n - 1].op, out[n - 2].immediate);
+            if(folded.has_value()) {
+                out.pop_back();
+                out.back().immediate = folded.get_value();
+                return true;
+            }
+
+            // push a; bt/bf -> jmp, or nothing
+            if(out[n - 1].op == opcode::bt || out[n - 1].op == opcode::bf) {
+                bool taken = (static_cast<bool>(out[n - 2].immediate) == (out[n - 1].op == opcode::bt));
+                label_id target = out[n - 1].target;
+
+                out.erase(out.end() - 2, out.end());
+                if(taken) {
+                    out.emplace_back(opcode::jmp);
+                    out.back().target = target;
+                }
+
+                return true;
+            }
+        }
+
+        // stor x; load x -> dup; stor x
+        if(n >= 2 &&
+           is_op(out[n - 2], opcode::stor) &&
+           is_op(out[n - 1], opcode::load) &&
+           out[n - 2].address == out[n - 1].address) {
+            out[n - 1] = out[n - 2];
+            out[n - 2] = ir_instruction(opcode::dup);
+            return true;
+        }
+
+        // load x; load x -> load x; dup
+        if(n >= 2 &&
+           is_op(out[n - 2], opcode::load) &&
+           is_op(out[n - 1], opcode::load) &&
+           out[n - 2].address == out[n - 1].address) {
+            out[n - 1] = ir_instruction(opcode::dup);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool fold_and_fuse(std::vector<ir_instruction> &program)
+    {
+        bool changed = false;
+
+        std::vector<ir_instruction> out;
+        out.reserve(program.size());
+
+        for(auto const &instr : program) {
+            out.push_back(instr);
+            while(rewrite_tail(out)) {
+                changed = true;
+            }
+        }
+
+        std::swap(program, out);
+        return changed;
+    }
+
+    using label_index_map = std::unordered_map<int, size_t>;
+
+    label_index_map index_labels(std::vector<ir_instruction> const &program)
+    {
+        label_index_map rv;
+        for(size_t i = 0; i < program.size(); ++i) {
+            if(program[i].is_label()) {
+                rv.emplace(static_cast<int>(program[i].target), i);
+            }
+        }
+
+        return rv;
+    }
+
+    // Index of the first instruction executed from the position, skipping label markers.
+    size_t next_instruction(std::vector<ir_instruction> const &program, size_t i)
+    {
+        while(i < program.size() && program[i].is_label()) {
+            ++i;
+        }
+
+        return i;
+    }
+
+    size_t branch_destination(std::vector<ir_instruction> const &program,
+                              label_index_map const &labels,
+                              label_id target)
+    {
+        auto it = labels.find(static_cast<int>(target));
+        if(it == labels.end()) {
+            return program.size();
+        }
+
+        return next_instruction(program, it->second);
+    }
+
+    // Returns nothing if the chain of jumps starting at the target is a cycle.
+    maybe<label_id> resolve_jump_chain(std::vector<ir_instruction> const &program,
+                                       label_index_map const &labels,
+                                       label_id target)
+    {
+        std::unordered_set<int> visited;
+        while(visited.insert(static_cast<int>(target)).second) {
+            size_t dest = branch_destination(program, labels, target);
+            if(dest >= program.size() || !is_op(program[dest], opcode::jmp)) {
+                return target;
+            }
+
+            target = program[dest].target;
+        }
+
+        return nothing;
+    }
+
+    bool thread_jumps(std::vector<ir_instruction> &program)
+    {
+        bool changed = false;
+        auto labels = index_labels(program);
+
+        for(auto &instr : program) {
+            if(!instr.is_branch()) {
+                continue;
+            }
+
+            auto final_target = resolve_jump_chain(program, labels, instr.target);
+            if(final_target.has_value() && final_target.get_value() != instr.target) {
+                instr.target = final_target.get_value();
+                changed = true;
+            }
+
+            // jmp to ret -> ret
+            if(instr.op == opcode::jmp) {
+                size_t dest = branch_destination(program, labels, instr.target);
+                if(dest < program.size() && is_op(program[dest], opcode::ret)) {
+                    instr = ir_instruction(opcode::ret);
+                    changed = true;
+                }
+            }
+        }
+
+        // Remove jumps to the instruction which follows them
+        std::vector<ir_instruction> out;
+        out.reserve(program.size());
+
+        for(size_t i = 0; i < program.size(); ++i) {
+            if(is_op(program[i], opcode::jmp) &&
+               branch_destination(program, labels, program[i].target) ==
+                   next_instruction(program, i + 1)) {
+                changed = true;
+                continue;
+            }
+
+            out.push_back(program[i]);
+        }
+
+        std::swap(program, out);
+        return changed;
+    }
+
+    bool remove_unreachable(std::vector<ir_instruction> &program,
+                            std::unordered_set<int> const &entry_labels)
+    {
+        std::unordered_set<int> live_labels(entry_labels);
+        for(auto const &instr : program) {
+            if(instr.is_branch()) {
+                live_labels.insert(static_cast<int>(instr.target));
+            }
+        }
+
+        bool changed = false;
+        bool reachable = true;
+
+        std::vector<ir_instruction> out;
+        out.reserve(program.size());
+
+        for(auto const &instr : program) {
+            if(instr.is_label()) {
+                if(live_labels.find(static_cast<int>(instr.target)) != live_labels.end()) {
+                    reachable = true;
+                }
+
+                out.push_back(instr);
+                continue;
+            }
+
+            if(!reachable) {
+                changed = true;
+                continue;
+            }
+
+            out.push_back(instr);
+            if(instr.op == opcode::jmp || instr.op == opcode::ret) {
+                reachable = false;
+            }
+        }
+
+        std::swap(program, out);
+        return changed;
+    }
+}
+
+void gorc::cog::optimize_ir(std::vector<ir_instruction> &program,
+                            std::unordered_set<int> const &entry_labels)
+{
+    bool changed = true;
+    while(changed) {
+        changed = fold_and_fuse(program);
+        changed = thread_jumps(program) || changed;
+        changed = remove_unreachable(program, entry_labels) || changed;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ir_instruction.hpp"
+#include <unordered_set>
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        // Rewrites buffered IR until no further pass applies:
+        //  - constant folding of immediate operands and immediate branch conditions,
+        //  - dup/stor/load peephole fusion,
+        //  - jump threading through unconditional jumps,
+        //  - removal of code which cannot be reached from an entry label or branch target.
+        // Entry labels are never removed. Changes to the rewritten code must increment
+        // compiled_format_version in vm/opcode.hpp.
+        void optimize_ir(std::vector<ir_instruction> &program,
+                         std::unordered_set<int> const &entry_labels);
+
+    }
+}
@@ -1,21 +1,47 @@
 #include "ir_printer.hpp"
+#include "ir_optimizer.hpp"
 #include "jk/cog/vm/opcode.hpp"
 #include "log/log.hpp"
 
 gorc::cog::ir_printer::ir_printer(file &program_text,
-                                  message_table &exports)
+                                  message_table &exports,
+                                  source_map &call_sites,
+                                  bool optimize)
     : program_text(program_text)
     , program_stream(program_text)
     , exports(exports)
+    , call_sites(call_sites)
+    , optimize(optimize)
 {
     return;
 }
 
 void gorc::cog::ir_printer::finalize()
 {
+    if(optimize) {
+        std::unordered_set<int> entry_labels;
+        for(auto const &exported_label_id : exported_label_ids) {
+            entry_labels.insert(static_cast<int>(exported_label_id.second));
+        }
+
+        optimize_ir(instructions, entry_labels);
+    }
+
+    bool ends_with_ret = false;
+    for(auto it = instructions.rbegin(); it != instructions.rend(); ++it) {
+        if(!it->is_label()) {
+            ends_with_ret = (it->op == opcode::ret);
+            break;
+        }
+    }
+
     if(!ends_with_ret) {
         // End program text with ret
-        ret();
+        instructions.emplace_back(opcode::ret);
+    }
+
+    for(auto const &instr : instructions) {
+        write_instruction(instr);
     }
 
     // Loop over backpatch map, replacing temporary indices
@@ -44,6 +70,64 @@ void gorc::cog::ir_printer::finalize()
     return;
 }
 
+void gorc::cog::ir_printer::write_instruction(ir_instruction const &instr)
+{
+    if(instr.is_label()) {
+        // Current position is the label offset
+        label_offsets.emplace(static_cast<int>(instr.target), program_text.position());
+        return;
+    }
+
+    switch(instr.op) {
+    case opcode::push:
+        binary_serialize(program_stream, instr.op);
+        binary_serialize(program_stream, instr.immediate);
+        break;
+
+    case opcode::load:
+    case opcode::loadi:
+    case opcode::stor:
+    case opcode::stori:
+        binary_serialize(program_stream, instr.op);
+        binary_serialize(program_stream, instr.address);
+        break;
+
+    case opcode::jmp:
+    case opcode::jal:
+    case opcode::bt:
+    case opcode::bf:
+        write_branch_instruction(instr.op, instr.target);
+        break;
+
+    case opcode::call:
+    case opcode::callv:
+        call_sites.set_range(program_text.position(), instr.location);
+        binary_serialize(program_stream, instr.op);
+        binary_serialize(program_stream, static_cast<int>(instr.verb));
+        break;
+
+    default:
+        binary_serialize(program_stream, instr.op);
+        break;
+    }
+}
+
+void gorc::cog::ir_printer::write_branch_instruction(opcode op, label_id lid)
+{
+    binary_serialize(program_stream, op);
+
+    // Store current location in backpatch map
+    backpatch_map.emplace(static_cast<int>(lid), program_text.position());
+
+    // Write placeholder
+    binary_serialize(program_stream, size_t(0));
+}
+
+void gorc::cog::ir_printer::add_instruction(opcode op)
+{
+    instructions.emplace_back(op);
+}
+
 gorc::cog::label_id gorc::cog::ir_printer::generate_label()
 {
     return label_id(next_label_id++);
@@ -72,222 +156,178 @@ gorc::cog::label_id gorc::cog::ir_printer::get_export_label(message_type mt,
 
 void gorc::cog::ir_printer::label(label_id lid)
 {
-    // Current position is the label offset
-    bool succeeded = label_offsets.emplace(static_cast<int>(lid),
-                                           program_text.position()).second;
+    bool succeeded = defined_labels.insert(static_cast<int>(lid)).second;
     if(!succeeded) {
         LOG_FATAL(format("label id %d used for multiple branch targets") % static_cast<int>(lid));
     }
+
+    instructions.emplace_back(lid);
 }
 
 void gorc::cog::ir_printer::push(value v)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::push);
-    binary_serialize(program_stream, v);
+    add_instruction(opcode::push);
+    instructions.back().immediate = v;
 }
 
 void gorc::cog::ir_printer::dup()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::dup);
+    add_instruction(opcode::dup);
 }
 
 void gorc::cog::ir_printer::load(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::load);
-    binary_serialize(program_stream, addr);
+    add_instruction(opcode::load);
+    instructions.back().address = addr;
 }
 
 void gorc::cog::ir_printer::loadi(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::loadi);
-    binary_serialize(program_stream, addr);
+    add_instruction(opcode::loadi);
+    instructions.back().address = addr;
 }
 
 void gorc::cog::ir_printer::stor(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::stor);
-    binary_serialize(program_stream, addr);
+    add_instruction(opcode::stor);
+    instructions.back().address = addr;
 }
 
 void gorc::cog::ir_printer::stori(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::stori);
-    binary_serialize(program_stream, addr);
-}
-
-void gorc::cog::ir_printer::write_branch_instruction(opcode op, label_id lid)
-{
-    binary_serialize(program_stream, op);
-
-    // Store current location in backpatch map
-    backpatch_map.emplace(static_cast<int>(lid), program_text.position());
-
-    // Write placeholder
-    binary_serialize(program_stream, size_t(0));
+    add_instruction(opcode::stori);
+    instructions.back().address = addr;
 }
 
 void gorc::cog::ir_printer::jmp(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::jmp, lid);
+    add_instruction(opcode::jmp);
+    instructions.back().target = lid;
 }
 
 void gorc::cog::ir_printer::jal(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::jal, lid);
+    add_instruction(opcode::jal);
+    instructions.back().target = lid;
 }
 
 void gorc::cog::ir_printer::bt(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::bt, lid);
+    add_instruction(opcode::bt);
+    instructions.back().target = lid;
 }
 
 void gorc::cog::ir_printer::bf(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::bf, lid);
+    add_instruction(opcode::bf);
+    instructions.back().target = lid;
 }
 
 void gorc::cog::ir_printer::ret()
 {
-    ends_with_ret = true;
-    binary_serialize(program_stream, opcode::ret);
+    add_instruction(opcode::ret);
 }
 
 void gorc::cog::ir_printer::call(verb_id id, diagnostic_context_location const &loc)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::call);
-    binary_serialize(program_stream, static_cast<int>(id));
-    binary_serialize(program_stream, loc.first_line);
-    binary_serialize(program_stream, loc.first_col);
-    binary_serialize(program_stream, loc.last_line);
-    binary_serialize(program_stream, loc.last_col);
+    add_instruction(opcode::call);
+    instructions.back().verb = id;
+    instructions.back().location = loc;
 }
 
 void gorc::cog::ir_printer::callv(verb_id id, diagnostic_context_location const &loc)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::callv);
-    binary_serialize(program_stream, static_cast<int>(id));
-    binary_serialize(program_stream, loc.first_line);
-    binary_serialize(program_stream, loc.first_col);
-    binary_serialize(program_stream, loc.last_line);
-    binary_serialize(program_stream, loc.last_col);
+    add_instruction(opcode::callv);
+    instructions.back().verb = id;
+    instructions.back().location = loc;
 }
 
 void gorc::cog::ir_printer::neg()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::neg);
+    add_instruction(opcode::neg);
 }
 
 void gorc::cog::ir_printer::lnot()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::lnot);
+    add_instruction(opcode::lnot);
 }
 
 void gorc::cog::ir_printer::add()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::add);
+    add_instruction(opcode::add);
 }
 
 void gorc::cog::ir_printer::sub()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::sub);
+    add_instruction(opcode::sub);
 }
 
 void gorc::cog::ir_printer::mul()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::mul);
+    add_instruction(opcode::mul);
 }
 
 void gorc::cog::ir_printer::div()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::div);
+    add_instruction(opcode::div);
 }
 
 void gorc::cog::ir_printer::mod()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::mod);
+    add_instruction(opcode::mod);
 }
 
 void gorc::cog::ir_printer::bor()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::bor);
+    add_instruction(opcode::bor);
 }
 
 void gorc::cog::ir_printer::band()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::band);
+    add_instruction(opcode::band);
 }
 
 void gorc::cog::ir_printer::bxor()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::bxor);
+    add_instruction(opcode::bxor);
 }
 
 void gorc::cog::ir_printer::lor()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::lor);
+    add_instruction(opcode::lor);
 }
 
 void gorc::cog::ir_printer::land()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::land);
+    add_instruction(opcode::land);
 }
 
 void gorc::cog::ir_printer::eq()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::eq);
+    add_instruction(opcode::eq);
 }
 
 void gorc::cog::ir_printer::ne()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::ne);
+    add_instruction(opcode::ne);
 }
 
 void gorc::cog::ir_printer::gt()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::gt);
+    add_instruction(opcode::gt);
 }
 
 void gorc::cog::ir_printer::ge()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::ge);
+    add_instruction(opcode::ge);
 }
 
 void gorc::cog::ir_printer::lt()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::lt);
+    add_instruction(opcode::lt);
 }
 
 void gorc::cog::ir_printer::le()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::le);
+    add_instruction(opcode::le);
 }
@@ -2,13 +2,17 @@
 
 #include "jk/cog/script/value.hpp"
 #include "jk/cog/script/message_table.hpp"
+#include "jk/cog/script/source_map.hpp"
 #include "io/file.hpp"
 #include "io/binary_output_stream.hpp"
 #include "label_id.hpp"
+#include "ir_instruction.hpp"
 #include "utility/enum_hash.hpp"
 #include "jk/cog/vm/opcode.hpp"
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace gorc {
     namespace cog {
@@ -19,22 +23,33 @@ namespace gorc {
             binary_output_stream program_stream;
 
             message_table &exports;
+            source_map &call_sites;
+
+            bool optimize;
 
             int next_label_id = 0;
             std::unordered_map<std::string, label_id> named_label_ids;
             std::unordered_map<message_type, label_id, enum_hash<message_type>> exported_label_ids;
 
+            std::unordered_set<int> defined_labels;
+            std::vector<ir_instruction> instructions;
+
             std::unordered_map<int, size_t> label_offsets;
 
             std::unordered_multimap<int, size_t> backpatch_map;
 
-            bool ends_with_ret = false;
-
+            void write_instruction(ir_instruction const &instr);
             void write_branch_instruction(opcode op, label_id lid);
 
+            void add_instruction(opcode op);
+
         public:
+            // Instructions are buffered until finalize, when they are optionally optimized
+            // and written to the program text.
             ir_printer(file &program_text,
-                       message_table &exports);
+                       message_table &exports,
+                       source_map &call_sites,
+                       bool optimize = false);
 
             void finalize();
 
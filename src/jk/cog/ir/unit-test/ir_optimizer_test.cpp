@@ -0,0 +1,226 @@
+#include "test/test.hpp"
+#include "jk/cog/ir/ir_optimizer.hpp"
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::cog;
+
+namespace {
+    ir_instruction make_push(value v)
+    {
+        ir_instruction rv(opcode::push);
+        rv.immediate = v;
+        return rv;
+    }
+
+    ir_instruction make_address(opcode op, size_t addr)
+    {
+        ir_instruction rv(op);
+        rv.address = addr;
+        return rv;
+    }
+
+    ir_instruction make_branch(opcode op, int lid)
+    {
+        ir_instruction rv(op);
+        rv.target = label_id(lid);
+        return rv;
+    }
+
+    ir_instruction make_label(int lid)
+    {
+        return ir_instruction(label_id(lid));
+    }
+
+    std::vector<opcode> opcodes(std::vector<ir_instruction> const &program)
+    {
+        std::vector<opcode> rv;
+        for(auto const &instr : program) {
+            if(!instr.is_label()) {
+                rv.push_back(instr.op);
+            }
+        }
+
+        return rv;
+    }
+}
+
+begin_suite(ir_optimizer_test);
+
+test_case(fold_immediate_operands)
+{
+    std::vector<ir_instruction> program {
+        make_push(value(2)),
+        make_push(value(3)),
+        make_push(value(4)),
+        ir_instruction(opcode::mul),
+        ir_instruction(opcode::add),
+        ir_instruction(opcode::neg),
+        make_push(value(7.0f)),
+        make_push(value(2)),
+        ir_instruction(opcode::div),
+        ir_instruction(opcode::ret)
+    };
+
+    optimize_ir(program, { });
+
+    assert_eq(opcodes(program),
+              (std::vector<opcode> { opcode::push, opcode::push, opcode::ret }));
+    assert_true(is_same(program[0].immediate, value(-14)));
+    assert_true(is_same(program[1].immediate, value(3.5f)));
+}
+
+test_case(integer_division_by_zero_not_folded)
+{
+    std::vector<ir_instruction> program {
+        make_push(value(7)),
+        make_push(value(0)),
+        ir_instruction(opcode::div),
+        make_push(value(7)),
+        make_push(value(0)),
+        ir_instruction(opcode::mod),
+        ir_instruction(opcode::ret)
+    };
+
+    optimize_ir(program, { });
+
+    assert_eq(program.size(), size_t(7));
+}
+
+test_case(fold_immediate_branch)
+{
+    std::vector<ir_instruction> program {
+        make_label(0),
+        make_push(value(1)),
+        make_branch(opcode::bf, 1),
+        ir_instruction(opcode::call),
+        make_label(1),
+        make_push(value(0)),
+        make_branch(opcode::bt, 0),
+        ir_instruction(opcode::ret)
+    };
+
+    optimize_ir(program, { 0 });
+
+    assert_eq(opcodes(program),
+              (std::vector<opcode> { opcode::call, opcode::ret }));
+}
+
+test_case(thread_jumps)
+{
+    std::vector<ir_instruction> program {
+        make_label(0),
+        make_address(opcode::load, 0),
+        make_branch(opcode::bf, 1),
+        ir_instruction(opcode::call),
+        make_branch(opcode::jmp, 2),
+        make_label(1),
+        ir_instruction(opcode::callv),
+        make_branch(opcode::bt, 3),
+        ir_instruction(opcode::call),
+        make_label(2),
+        make_branch(opcode::jmp, 4),
+        make_label(3),
+        ir_instruction(opcode::call),
+        make_label(4),
+        ir_instruction(opcode::call)
+    };
+
+    optimize_ir(program, { 0 });
+
+    assert_eq(program[4].op, opcode::jmp);
+    assert_eq(program[4].target, label_id(4));
+    assert_eq(program[10].op, opcode::jmp);
+    assert_eq(program[10].target, label_id(4));
+}
+
+test_case(jump_to_ret_is_ret)
+{
+    std::vector<ir_instruction> program {
+        make_label(0),
+        make_address(opcode::load, 0),
+        make_branch(opcode::bf, 1),
+        ir_instruction(opcode::call),
+        make_branch(opcode::jmp, 2),
+        make_label(1),
+        ir_instruction(opcode::call),
+        make_label(2),
+        ir_instruction(opcode::ret)
+    };
+
+    optimize_ir(program, { 0 });
+
+    assert_eq(opcodes(program),
+              (std::vector<opcode> { opcode::load,
+                                     opcode::bf,
+                                     opcode::call,
+                                     opcode::ret,
+                                     opcode::call,
+                                     opcode::ret }));
+}
+
+test_case(jump_cycle)
+{
+    std::vector<ir_instruction> program {
+        make_label(0),
+        make_branch(opcode::jmp, 1),
+        make_label(1),
+        make_branch(opcode::jmp, 0)
+    };
+
+    optimize_ir(program, { 0 });
+
+    assert_eq(opcodes(program), (std::vector<opcode> { opcode::jmp }));
+    assert_eq(program[2].target, label_id(0));
+}
+
+test_case(remove_unreachable)
+{
+    std::vector<ir_instruction> program {
+        make_label(0),
+        ir_instruction(opcode::call),
+        ir_instruction(opcode::ret),
+        ir_instruction(opcode::call),
+        make_label(1),
+        ir_instruction(opcode::callv),
+        make_label(2),
+        ir_instruction(opcode::call),
+        ir_instruction(opcode::ret)
+    };
+
+    optimize_ir(program, { 0, 2 });
+
+    assert_eq(opcodes(program),
+              (std::vector<opcode> { opcode::call,
+                                     opcode::ret,
+                                     opcode::call,
+                                     opcode::ret }));
+}
+
+test_case(fuse_store_load)
+{
+    std::vector<ir_instruction> program {
+        make_push(value(1)),
+        make_address(opcode::stor, 3),
+        make_address(opcode::load, 3),
+        make_address(opcode::stor, 4),
+        make_address(opcode::load, 4),
+        make_address(opcode::load, 4),
+        ir_instruction(opcode::mul),
+        ir_instruction(opcode::ret)
+    };
+
+    optimize_ir(program, { });
+
+    assert_eq(opcodes(program),
+              (std::vector<opcode> { opcode::push,
+                                     opcode::dup,
+                                     opcode::stor,
+                                     opcode::dup,
+                                     opcode::dup,
+                                     opcode::stor,
+                                     opcode::mul,
+                                     opcode::ret }));
+}
+
+end_suite(ir_optimizer_test);
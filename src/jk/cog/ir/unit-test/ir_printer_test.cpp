@@ -11,7 +11,8 @@ test_case(label_redefinition)
 {
     memory_file mf;
     message_table mt;
-    ir_printer ir(mf, mt);
+    source_map sm;
+    ir_printer ir(mf, mt, sm);
 
     auto lid = ir.generate_label();
     ir.label(lid);
@@ -1,6 +1,17 @@
 #include "script.hpp"
 #include "content/fourcc.hpp"
+#include <atomic>
 
 using namespace gorc;
 
 gorc::fourcc const gorc::cog::script::type = "COG"_4CC;
+
+namespace {
+    std::atomic<uint64_t> next_script_serial(0);
+}
+
+gorc::cog::script::script()
+    : serial(next_script_serial++)
+{
+    return;
+}
@@ -3,8 +3,10 @@
 #include "symbol_table.hpp"
 #include "string_table.hpp"
 #include "message_table.hpp"
+#include "source_map.hpp"
 #include "io/memory_file.hpp"
 #include "content/asset.hpp"
+#include <cstdint>
 
 namespace gorc {
     namespace cog {
@@ -13,11 +15,18 @@ namespace gorc {
         public:
             static fourcc const type;
 
+            // Unique for the life of the process. Unlike the script's address, it is never
+            // reused after the script is destroyed.
+            uint64_t const serial;
+
+            script();
+
             std::string filename;
             symbol_table symbols;
             string_table strings;
             message_table exports;
             memory_file program;
+            source_map call_sites;
         };
 
     }
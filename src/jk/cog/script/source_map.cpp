@@ -0,0 +1,34 @@
+#include "source_map.hpp"
+#include <algorithm>
+
+namespace {
+    using range_type = std::pair<size_t, gorc::diagnostic_context_location>;
+
+    bool range_offset_less(range_type const &range, size_t offset)
+    {
+        return range.first < offset;
+    }
+}
+
+void gorc::cog::source_map::set_range(size_t offset, diagnostic_context_location const &loc)
+{
+    // Code generation emits ranges in program order, so this is normally an append.
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), offset, range_offset_less);
+    if(it != ranges.end() && it->first == offset) {
+        it->second = loc;
+    }
+    else {
+        ranges.emplace(it, offset, loc);
+    }
+}
+
+gorc::maybe<gorc::diagnostic_context_location const *>
+    gorc::cog::source_map::get_range(size_t offset) const
+{
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), offset, range_offset_less);
+    if(it != ranges.end() && it->first == offset) {
+        return &it->second;
+    }
+
+    return nothing;
+}
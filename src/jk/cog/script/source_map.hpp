@@ -0,0 +1,40 @@
+#pragma once
+
+#include "log/diagnostic_context_location.hpp"
+#include "utility/maybe.hpp"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        // Maps program offsets to the source ranges which generated them.
+        class source_map {
+        private:
+            std::vector<std::pair<size_t, diagnostic_context_location>> ranges;
+
+        public:
+            void set_range(size_t offset, diagnostic_context_location const &);
+            maybe<diagnostic_context_location const *> get_range(size_t offset) const;
+
+            inline size_t size() const
+            {
+                return ranges.size();
+            }
+
+            inline auto begin() const
+                -> decltype(ranges.begin())
+            {
+                return ranges.begin();
+            }
+
+            inline auto end() const
+                -> decltype(ranges.end())
+            {
+                return ranges.end();
+            }
+        };
+
+    }
+}
@@ -13,6 +13,23 @@ namespace gorc {
 
         public:
             char const* add_string(std::string const &str);
+
+            inline size_t size() const
+            {
+                return strings.size();
+            }
+
+            inline auto begin() const
+                -> decltype(strings.begin())
+            {
+                return strings.begin();
+            }
+
+            inline auto end() const
+                -> decltype(strings.end())
+            {
+                return strings.end();
+            }
         };
 
     }
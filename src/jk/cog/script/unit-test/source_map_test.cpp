@@ -0,0 +1,30 @@
+#include "test/test.hpp"
+#include "jk/cog/script/source_map.hpp"
+
+begin_suite(source_map_test);
+
+test_case(get_range)
+{
+    gorc::cog::source_map m;
+
+    assert_true(!m.get_range(10).has_value());
+
+    m.set_range(30, gorc::diagnostic_context_location(gorc::nothing, 3, 1, 3, 8));
+    m.set_range(10, gorc::diagnostic_context_location(gorc::nothing, 1, 1, 1, 5));
+    m.set_range(20, gorc::diagnostic_context_location(gorc::nothing, 2, 4, 2, 9));
+
+    assert_true(!m.get_range(15).has_value());
+    assert_true(!m.get_range(40).has_value());
+
+    auto loc = m.get_range(20);
+    assert_true(loc.has_value());
+    assert_true(*loc.get_value() == gorc::diagnostic_context_location(gorc::nothing, 2, 4, 2, 9));
+
+    m.set_range(20, gorc::diagnostic_context_location(gorc::nothing, 7, 1, 7, 2));
+    assert_true(*m.get_range(20).get_value() ==
+                gorc::diagnostic_context_location(gorc::nothing, 7, 1, 7, 2));
+    assert_eq(m.get_range(10).get_value()->first_line, 1);
+    assert_eq(m.get_range(30).get_value()->first_line, 3);
+}
+
+end_suite(source_map_test);
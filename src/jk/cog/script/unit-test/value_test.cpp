@@ -1,5 +1,7 @@
 #include "test/test.hpp"
 #include "jk/cog/script/value.hpp"
+#include <cmath>
+#include <set>
 
 using namespace gorc;
 using namespace gorc::cog;
@@ -80,6 +82,29 @@ test_case(float_operator_tests)
     assert_true((u != v));
 }
 
+test_case(mixed_operator_tests)
+{
+    value u(5);
+    value v(2.5f);
+    value b(true);
+    value t(thing_id(3));
+
+    assert_true(is_same(value(7.5f), u + v));
+    assert_true(is_same(value(-2.5f), v - u));
+    assert_true(is_same(value(12.5f), u * v));
+    assert_true(is_same(value(2.0f), u / v));
+    assert_true(is_same(value(1), u % value(2.0f)));
+    assert_true(is_same(value(6), u + b));
+    assert_true(is_same(value(8), u + t));
+    assert_true(is_same(value(-3), -t));
+
+    assert_true(is_same(value(true), u > v));
+    assert_true(is_same(value(false), u < v));
+    assert_true(is_same(value(true), value(5.0f) == u));
+    assert_true(is_same(value(true), value(0.1f) == value(0.1f)));
+    assert_true(is_same(value(false), u != value(5.0f)));
+}
+
 test_case(bool_operator_tests)
 {
     value u(true);
@@ -169,6 +194,41 @@ test_case(is_same_vector)
                          value(make_vector(1.0f, 2.0f, 3.1f))));
 }
 
+test_case(hash_consistent_with_is_same)
+{
+    assert_eq(value(5).hash(), value(5).hash());
+    assert_eq(value(thing_id(5)).hash(), value(thing_id(5)).hash());
+    assert_eq(value("abc").hash(), value(std::string("abc").c_str()).hash());
+    assert_eq(value(0.0f).hash(), value(-0.0f).hash());
+    assert_eq(value(make_vector(1.0f, 2.0f, 3.0f)).hash(),
+              value(make_color(1.0f, 2.0f, 3.0f)).hash());
+
+    value_identical same;
+    assert_true(same(value(thing_id(5)), value(thing_id(5))));
+    assert_true(!same(value(thing_id(5)), value(sector_id(5))));
+    assert_true(!same(value(thing_id(5)), value(thing_id(6))));
+    assert_true(same(value(0.0f), value(-0.0f)));
+    assert_true(same(value(1.5f), value(1.5f)));
+    assert_true(!same(value(1.0f), value(std::nextafter(1.0f, 2.0f))));
+    assert_true(same(value(make_vector(1.0f, 2.0f, 3.0f)), value(make_vector(1.0f, 2.0f, 3.0f))));
+    assert_true(!same(value(make_vector(1.0f, 2.0f, 3.0f)), value(make_vector(1.0f, 2.0f, 3.5f))));
+}
+
+test_case(float_payloads_hashed)
+{
+    // Distinct payloads must not all share one hash
+    std::set<size_t> float_hashes;
+    std::set<size_t> vector_hashes;
+    for(int i = 0; i < 16; ++i) {
+        float f = static_cast<float>(i) * 0.5f;
+        float_hashes.insert(value(f).hash());
+        vector_hashes.insert(value(make_vector(f, 1.0f, 2.0f)).hash());
+    }
+
+    assert_eq(float_hashes.size(), size_t(16));
+    assert_eq(vector_hashes.size(), size_t(16));
+}
+
 test_case(vector_types)
 {
     auto v0 = value(make_vector(1.0f, 2.0f, 3.0f));
@@ -1,4 +1,7 @@
 #include "value.hpp"
+#include <cmath>
+#include <functional>
+#include <limits>
 #include <sstream>
 
 namespace {
@@ -8,6 +11,29 @@ namespace {
     constexpr gorc::point<3> default_point;
     constexpr gorc::color_rgb default_color;
     constexpr float default_float = 0.0f;
+
+    // Equality without -Wfloat-equal. Zeroes of either sign are identical, and so are NaNs.
+    bool float_identical(float x, float y)
+    {
+        if(std::isnan(x) || std::isnan(y)) {
+            return std::isnan(x) && std::isnan(y);
+        }
+
+        return !(x < y) && !(y < x);
+    }
+
+    size_t float_hash(float x)
+    {
+        if(std::isnan(x)) {
+            return std::numeric_limits<size_t>::max();
+        }
+
+        if(std::fpclassify(x) == FP_ZERO) {
+            x = 0.0f;
+        }
+
+        return std::hash<float>()(x);
+    }
 }
 
 gorc::cog::value::value(deserialization_constructor_tag, binary_input_stream &f)
@@ -44,18 +70,6 @@ gorc::cog::value::operator char const*() const
     }
 }
 
-gorc::cog::value::value(bool b)
-{
-    *this = b;
-}
-
-gorc::cog::value& gorc::cog::value::operator=(bool b)
-{
-    type_flag = value_type::boolean;
-    data.boolean = b;
-    return *this;
-}
-
 gorc::cog::value::operator bool() const
 {
     switch(type_flag) {
@@ -79,18 +93,6 @@ gorc::cog::value::operator bool() const
     }
 }
 
-gorc::cog::value::value(int i)
-{
-    *this = i;
-}
-
-gorc::cog::value& gorc::cog::value::operator=(int i)
-{
-    type_flag = value_type::integer;
-    data.integer = i;
-    return *this;
-}
-
 gorc::cog::value::operator int() const
 {
     if(is_id_type(type_flag) || type_flag == value_type::integer) {
@@ -107,18 +109,6 @@ gorc::cog::value::operator int() const
     }
 }
 
-gorc::cog::value::value(float f)
-{
-    *this = f;
-}
-
-gorc::cog::value& gorc::cog::value::operator=(float f)
-{
-    type_flag = value_type::floating;
-    data.floating = f;
-    return *this;
-}
-
 gorc::cog::value::operator float() const
 {
     if(is_id_type(type_flag) || type_flag == value_type::integer) {
@@ -244,8 +234,8 @@ MAKE_ID_MEMBERS(sound)
 MAKE_ID_MEMBERS(thing_template)
 MAKE_ID_MEMBERS(message)
 
-#define MAKE_TYPED_NUMERIC_OPERATOR(op) \
-gorc::cog::value gorc::cog::value::operator op(value const &v) const \
+#define MAKE_TYPED_NUMERIC_OPERATOR(op, name) \
+gorc::cog::value gorc::cog::value::generic_##name(value const &v) const \
 { \
     if(type_flag == value_type::floating || v.type_flag == value_type::floating) { \
         return static_cast<float>(*this) op static_cast<float>(v); \
@@ -255,26 +245,26 @@ gorc::cog::value gorc::cog::value::operator op(value const &v) const \
     } \
 }
 
-#define MAKE_INTEGER_ONLY_OPERATOR(op) \
-gorc::cog::value gorc::cog::value::operator op(value const &v) const \
+#define MAKE_INTEGER_ONLY_OPERATOR(op, name) \
+gorc::cog::value gorc::cog::value::generic_##name(value const &v) const \
 { \
     return static_cast<int>(*this) op static_cast<int>(v); \
 }
 
-MAKE_TYPED_NUMERIC_OPERATOR(+)
-MAKE_TYPED_NUMERIC_OPERATOR(-)
-MAKE_TYPED_NUMERIC_OPERATOR(*)
-MAKE_TYPED_NUMERIC_OPERATOR(/)
-MAKE_INTEGER_ONLY_OPERATOR(%)
-MAKE_INTEGER_ONLY_OPERATOR(&)
-MAKE_INTEGER_ONLY_OPERATOR(|)
-MAKE_INTEGER_ONLY_OPERATOR(^)
-MAKE_TYPED_NUMERIC_OPERATOR(>)
-MAKE_TYPED_NUMERIC_OPERATOR(<)
-MAKE_TYPED_NUMERIC_OPERATOR(>=)
-MAKE_TYPED_NUMERIC_OPERATOR(<=)
-
-gorc::cog::value gorc::cog::value::operator==(value const &v) const
+MAKE_TYPED_NUMERIC_OPERATOR(+, add)
+MAKE_TYPED_NUMERIC_OPERATOR(-, sub)
+MAKE_TYPED_NUMERIC_OPERATOR(*, mul)
+MAKE_TYPED_NUMERIC_OPERATOR(/, div)
+MAKE_INTEGER_ONLY_OPERATOR(%, mod)
+MAKE_INTEGER_ONLY_OPERATOR(&, band)
+MAKE_INTEGER_ONLY_OPERATOR(|, bor)
+MAKE_INTEGER_ONLY_OPERATOR(^, bxor)
+MAKE_TYPED_NUMERIC_OPERATOR(>, gt)
+MAKE_TYPED_NUMERIC_OPERATOR(<, lt)
+MAKE_TYPED_NUMERIC_OPERATOR(>=, ge)
+MAKE_TYPED_NUMERIC_OPERATOR(<=, le)
+
+gorc::cog::value gorc::cog::value::generic_eq(value const &v) const
 {
     if(type_flag == value_type::floating || v.type_flag == value_type::floating) {
         return almost_equal(static_cast<float>(*this), static_cast<float>(v));
@@ -284,7 +274,7 @@ gorc::cog::value gorc::cog::value::operator==(value const &v) const
     }
 }
 
-gorc::cog::value gorc::cog::value::operator!=(value const &v) const
+gorc::cog::value gorc::cog::value::generic_ne(value const &v) const
 {
     if(type_flag == value_type::floating || v.type_flag == value_type::floating) {
         return !almost_equal(static_cast<float>(*this), static_cast<float>(v));
@@ -309,7 +299,7 @@ gorc::cog::value gorc::cog::value::operator+() const
     return *this;
 }
 
-gorc::cog::value gorc::cog::value::operator-() const
+gorc::cog::value gorc::cog::value::generic_neg() const
 {
     return value(0) - *this;
 }
@@ -319,11 +309,6 @@ gorc::cog::value gorc::cog::value::operator!() const
     return !static_cast<bool>(*this);
 }
 
-gorc::cog::value_type gorc::cog::value::get_type() const
-{
-    return type_flag;
-}
-
 bool gorc::cog::value::is_same(value const &v) const
 {
     if(type_flag != v.type_flag) {
@@ -350,6 +335,54 @@ bool gorc::cog::value::is_same(value const &v) const
     }
 }
 
+bool gorc::cog::value::is_identical(value const &v) const
+{
+    if(type_flag != v.type_flag) {
+        return false;
+    }
+
+    switch(type_flag) {
+    case value_type::floating:
+        return float_identical(data.floating, v.data.floating);
+
+    case value_type::vector:
+        return float_identical(data.vector.x, v.data.vector.x) &&
+               float_identical(data.vector.y, v.data.vector.y) &&
+               float_identical(data.vector.z, v.data.vector.z);
+
+    default:
+        return is_same(v);
+    }
+}
+
+size_t gorc::cog::value::hash() const
+{
+    size_t type_hash = std::hash<int>()(static_cast<int>(type_flag));
+
+    switch(type_flag) {
+    case value_type::nothing:
+    case value_type::dynamic:
+        return type_hash;
+
+    case value_type::floating:
+        return type_hash ^ (float_hash(data.floating) << 1);
+
+    case value_type::vector:
+        return type_hash ^ (((float_hash(data.vector.x) * 31 +
+                              float_hash(data.vector.y)) * 31 +
+                              float_hash(data.vector.z)) << 1);
+
+    case value_type::boolean:
+        return type_hash ^ (std::hash<bool>()(data.boolean) << 1);
+
+    case value_type::string:
+        return type_hash ^ (std::hash<std::string>()(std::string(data.string)) << 1);
+
+    default:
+        return type_hash ^ (std::hash<int>()(data.integer) << 1);
+    }
+}
+
 std::string gorc::cog::value::as_string() const
 {
     std::stringstream ss;
@@ -27,6 +27,34 @@ namespace gorc {
                 } vector;
             } data;
 
+            // Mixed-type and non-numeric operands. The inline operators handle int/int and
+            // float/float operands directly and defer everything else to these.
+            value generic_add(value const &) const;
+            value generic_sub(value const &) const;
+            value generic_mul(value const &) const;
+            value generic_div(value const &) const;
+            value generic_mod(value const &) const;
+            value generic_band(value const &) const;
+            value generic_bor(value const &) const;
+            value generic_bxor(value const &) const;
+            value generic_gt(value const &) const;
+            value generic_lt(value const &) const;
+            value generic_ge(value const &) const;
+            value generic_le(value const &) const;
+            value generic_eq(value const &) const;
+            value generic_ne(value const &) const;
+            value generic_neg() const;
+
+            inline bool both_integer(value const &v) const
+            {
+                return type_flag == value_type::integer && v.type_flag == value_type::integer;
+            }
+
+            inline bool both_floating(value const &v) const
+            {
+                return type_flag == value_type::floating && v.type_flag == value_type::floating;
+            }
+
         public:
             value(deserialization_constructor_tag, binary_input_stream &);
             void binary_serialize_object(binary_output_stream &) const;
@@ -39,16 +67,49 @@ namespace gorc {
             value& operator=(char const *);
             operator char const*() const;
 
-            value(bool);
-            value& operator=(bool);
+            inline value(bool v)
+                : type_flag(value_type::boolean)
+            {
+                data.boolean = v;
+            }
+
+            inline value& operator=(bool v)
+            {
+                type_flag = value_type::boolean;
+                data.boolean = v;
+                return *this;
+            }
+
             operator bool() const;
 
-            value(int);
-            value& operator=(int);
+            inline value(int v)
+                : type_flag(value_type::integer)
+            {
+                data.integer = v;
+            }
+
+            inline value& operator=(int v)
+            {
+                type_flag = value_type::integer;
+                data.integer = v;
+                return *this;
+            }
+
             operator int() const;
 
-            value(float);
-            value& operator=(float);
+            inline value(float v)
+                : type_flag(value_type::floating)
+            {
+                data.floating = v;
+            }
+
+            inline value& operator=(float v)
+            {
+                type_flag = value_type::floating;
+                data.floating = v;
+                return *this;
+            }
+
             operator float() const;
 
             value(vector<3> const &);
@@ -84,33 +145,103 @@ namespace gorc {
 
 #undef MAKE_ID_MEMBERS
 
-            value operator+(value const &) const;
-            value operator-(value const &) const;
-            value operator*(value const &) const;
-            value operator/(value const &) const;
-            value operator%(value const &) const;
-            value operator&(value const &) const;
-            value operator|(value const &) const;
-            value operator^(value const &) const;
-            value operator>(value const &) const;
-            value operator<(value const &) const;
-            value operator>=(value const &) const;
-            value operator<=(value const &) const;
-            value operator==(value const &) const;
-            value operator!=(value const &) const;
+#define MAKE_NUMERIC_OPERATOR(op, name) \
+            inline value operator op(value const &v) const \
+            { \
+                if(both_integer(v)) { \
+                    return value(data.integer op v.data.integer); \
+                } \
+                else if(both_floating(v)) { \
+                    return value(data.floating op v.data.floating); \
+                } \
+                else { \
+                    return generic_##name(v); \
+                } \
+            }
+
+#define MAKE_INTEGER_OPERATOR(op, name) \
+            inline value operator op(value const &v) const \
+            { \
+                if(both_integer(v)) { \
+                    return value(data.integer op v.data.integer); \
+                } \
+                else { \
+                    return generic_##name(v); \
+                } \
+            }
+
+            MAKE_NUMERIC_OPERATOR(+, add)
+            MAKE_NUMERIC_OPERATOR(-, sub)
+            MAKE_NUMERIC_OPERATOR(*, mul)
+            MAKE_NUMERIC_OPERATOR(/, div)
+            MAKE_INTEGER_OPERATOR(%, mod)
+            MAKE_INTEGER_OPERATOR(&, band)
+            MAKE_INTEGER_OPERATOR(|, bor)
+            MAKE_INTEGER_OPERATOR(^, bxor)
+            MAKE_NUMERIC_OPERATOR(>, gt)
+            MAKE_NUMERIC_OPERATOR(<, lt)
+            MAKE_NUMERIC_OPERATOR(>=, ge)
+            MAKE_NUMERIC_OPERATOR(<=, le)
+
+            // Floating point equality is approximate, so only int/int operands take the fast path.
+            MAKE_INTEGER_OPERATOR(==, eq)
+            MAKE_INTEGER_OPERATOR(!=, ne)
+
+#undef MAKE_NUMERIC_OPERATOR
+#undef MAKE_INTEGER_OPERATOR
+
             value operator&&(value const &) const;
             value operator||(value const &) const;
             value operator+() const;
-            value operator-() const;
+
+            inline value operator-() const
+            {
+                if(type_flag == value_type::integer) {
+                    return value(0 - data.integer);
+                }
+                else if(type_flag == value_type::floating) {
+                    return value(0.0f - data.floating);
+                }
+                else {
+                    return generic_neg();
+                }
+            }
+
             value operator!() const;
 
-            value_type get_type() const;
+            inline value_type get_type() const
+            {
+                return type_flag;
+            }
             std::string as_string() const;
 
             bool is_same(value const &v) const;
+
+            // Like is_same, but floating point payloads must be equal rather than approximately
+            // equal. Keys of hashed containers are compared this way, as the ordered
+            // containers they replaced did.
+            bool is_identical(value const &v) const;
+
+            // Hash consistent with is_identical.
+            size_t hash() const;
         };
 
         std::string as_string(value const &);
         bool is_same(value const &u, value const &v);
+
+        // Functors for hashed containers keyed on values.
+        struct value_hash {
+            inline size_t operator()(value const &v) const
+            {
+                return v.hash();
+            }
+        };
+
+        struct value_identical {
+            inline bool operator()(value const &u, value const &v) const
+            {
+                return u.is_identical(v);
+            }
+        };
     }
 }
@@ -45,3 +45,8 @@ gorc::cog::verb const& gorc::cog::verb_table::get_verb(verb_id id) const
 {
     return *verbs[static_cast<size_t>(static_cast<int>(id))];
 }
+
+size_t gorc::cog::verb_table::size() const
+{
+    return verbs.size();
+}
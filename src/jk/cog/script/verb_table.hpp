@@ -56,6 +56,14 @@ namespace gorc {
 
             verb_id get_verb_id(std::string const &name) const;
             verb const& get_verb(verb_id) const;
+
+            size_t size() const;
+
+            // Verb names and synonyms, with their verb ids and deprecation flags.
+            inline auto const& get_verb_index() const
+            {
+                return verb_index;
+            }
         };
 
     }
@@ -9,12 +9,14 @@ gorc::cog::continuation::continuation(deserialization_constructor_tag, binary_in
 {
     binary_deserialize_range<call_stack_frame>(bis, std::back_inserter(call_stack));
     binary_deserialize_range<value>(bis, std::back_inserter(data_stack));
+    handler = binary_deserialize<message_type>(bis);
 }
 
 void gorc::cog::continuation::binary_serialize_object(binary_output_stream &bos) const
 {
     binary_serialize_range(bos, call_stack);
     binary_serialize_range(bos, data_stack);
+    binary_serialize(bos, handler);
 }
 
 gorc::cog::call_stack_frame& gorc::cog::continuation::frame()
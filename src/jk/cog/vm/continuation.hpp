@@ -4,6 +4,7 @@
 #include "jk/cog/script/stack.hpp"
 #include "call_stack_frame.hpp"
 #include "jk/cog/script/value.hpp"
+#include "jk/cog/script/message_type.hpp"
 #include "io/binary_input_stream.hpp"
 #include "io/binary_output_stream.hpp"
 
@@ -15,6 +16,9 @@ namespace gorc {
             std::vector<call_stack_frame> call_stack;
             cog::stack data_stack;
 
+            // Message which started the continuation
+            message_type handler = message_type::global0;
+
             continuation() = default;
             explicit continuation(call_stack_frame &&frame);
 
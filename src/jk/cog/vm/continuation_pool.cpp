@@ -0,0 +1,37 @@
+#include "continuation_pool.hpp"
+
+namespace {
+    // Initial capacities cover typical message handlers.
+    constexpr size_t initial_call_stack_capacity = 8;
+    constexpr size_t initial_data_stack_capacity = 32;
+}
+
+std::unique_ptr<gorc::cog::continuation>
+    gorc::cog::continuation_pool::acquire(call_stack_frame &&frame)
+{
+    std::unique_ptr<continuation> cc;
+    if(free_continuations.empty()) {
+        cc = std::make_unique<continuation>();
+        cc->call_stack.reserve(initial_call_stack_capacity);
+        cc->data_stack.reserve(initial_data_stack_capacity);
+    }
+    else {
+        cc = std::move(free_continuations.back());
+        free_continuations.pop_back();
+    }
+
+    cc->call_stack.push_back(std::forward<call_stack_frame>(frame));
+    return cc;
+}
+
+void gorc::cog::continuation_pool::release(std::unique_ptr<continuation> &&cc)
+{
+    cc->call_stack.clear();
+    cc->data_stack.clear();
+    free_continuations.push_back(std::forward<std::unique_ptr<continuation>>(cc));
+}
+
+size_t gorc::cog::continuation_pool::size() const
+{
+    return free_continuations.size();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "continuation.hpp"
+#include <memory>
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        // Recycles continuations between message sends. Released continuations keep their stack
+        // capacity, so steady-state sends do not allocate.
+        class continuation_pool {
+        private:
+            std::vector<std::unique_ptr<continuation>> free_continuations;
+
+        public:
+            std::unique_ptr<continuation> acquire(call_stack_frame &&frame);
+            void release(std::unique_ptr<continuation> &&cc);
+
+            size_t size() const;
+        };
+
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "utility/time.hpp"
+#include "utility/maybe.hpp"
+#include <cstdint>
+#include <set>
+#include <utility>
+
+namespace gorc {
+    namespace cog {
+
+        struct insertion_order {
+            template <typename ValueT>
+            bool operator()(ValueT const &, ValueT const &) const
+            {
+                return false;
+            }
+        };
+
+        template <typename ValueT>
+        class deadline_schedule_event {
+        public:
+            time_delta deadline;
+            uint64_t sequence;
+
+            // Moved out when the event is released, just before it is erased.
+            mutable ValueT value;
+
+            template <typename ArgT>
+            deadline_schedule_event(time_delta deadline, uint64_t sequence, ArgT &&value)
+                : deadline(deadline)
+                , sequence(sequence)
+                , value(std::forward<ArgT>(value))
+            {
+                return;
+            }
+        };
+
+        // Events ordered by absolute expiration time. Events with equal deadlines are released in
+        // TieCompT order, then in insertion order. Handlers may insert and erase events while due
+        // events are released.
+        template <typename ValueT, typename TieCompT = insertion_order>
+        class deadline_schedule {
+        private:
+            using event = deadline_schedule_event<ValueT>;
+
+            struct event_order {
+                TieCompT tie_comp;
+
+                bool operator()(event const &left, event const &right) const
+                {
+                    if(left.deadline < right.deadline) {
+                        return true;
+                    }
+                    else if(right.deadline < left.deadline) {
+                        return false;
+                    }
+                    else if(tie_comp(left.value, right.value)) {
+                        return true;
+                    }
+                    else if(tie_comp(right.value, left.value)) {
+                        return false;
+                    }
+
+                    return left.sequence < right.sequence;
+                }
+            };
+
+            using event_set = std::set<event, event_order>;
+            event_set events;
+            uint64_t next_sequence = 0;
+
+        public:
+            void insert(time_delta deadline, ValueT &&value)
+            {
+                events.emplace(deadline, next_sequence++, std::forward<ValueT>(value));
+            }
+
+            void insert(time_delta deadline, ValueT const &value)
+            {
+                events.emplace(deadline, next_sequence++, value);
+            }
+
+            // Erases the first event scheduled at the deadline which compares equal to value.
+            // Only events which tie with value are visited, so schedules which erase events
+            // should have a tie order: under insertion_order, every event at the deadline ties.
+            void erase(time_delta deadline, ValueT const &value)
+            {
+                auto first = events.lower_bound(event(deadline, 0, value));
+                auto last = events.lower_bound(event(deadline, next_sequence, value));
+                for(auto it = first; it != last; ++it) {
+                    if(it->value == value) {
+                        events.erase(it);
+                        return;
+                    }
+                }
+            }
+
+            // Removes and returns the earliest event expiring at or before now.
+            maybe<ValueT> pop_due(time_delta now)
+            {
+                auto it = events.begin();
+                if(it == events.end() || it->deadline > now) {
+                    return nothing;
+                }
+
+                maybe<ValueT> rv(std::move(it->value));
+                events.erase(it);
+                return rv;
+            }
+
+            inline size_t size() const
+            {
+                return events.size();
+            }
+
+            inline typename event_set::const_iterator begin() const
+            {
+                return events.begin();
+            }
+
+            inline typename event_set::const_iterator end() const
+            {
+                return events.end();
+            }
+        };
+
+    }
+}
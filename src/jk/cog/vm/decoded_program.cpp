@@ -0,0 +1,259 @@
+#include "decoded_program.hpp"
+#include "io/binary_input_stream.hpp"
+#include "log/log.hpp"
+#include <limits>
+
+namespace {
+    constexpr size_t invalid_index = std::numeric_limits<size_t>::max();
+
+    bool is_fusable_operator(gorc::cog::opcode op)
+    {
+        using gorc::cog::opcode;
+
+        switch(op) {
+        case opcode::add:
+        case opcode::sub:
+        case opcode::mul:
+        case opcode::div:
+        case opcode::mod:
+        case opcode::bor:
+        case opcode::band:
+        case opcode::bxor:
+        case opcode::lor:
+        case opcode::land:
+        case opcode::eq:
+        case opcode::ne:
+        case opcode::gt:
+        case opcode::ge:
+        case opcode::lt:
+        case opcode::le:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+}
+
+gorc::cog::decoded_program::decoded_program(memory_file const &program)
+    : instruction_index(program.size() + 1, invalid_index)
+{
+    memory_file::reader sr(program);
+    binary_input_stream bsr(sr);
+
+    while(!sr.at_end()) {
+        size_t program_counter = sr.position();
+        instruction_index[program_counter] = instructions.size();
+
+        instructions.emplace_back();
+        decoded_instruction &inst = instructions.back();
+        inst.program_counter = program_counter;
+        inst.op = binary_deserialize<opcode>(bsr);
+
+        switch(inst.op) {
+        case opcode::push:
+            inst.immediate = value(deserialization_constructor, bsr);
+            break;
+
+        case opcode::load:
+        case opcode::loadi:
+        case opcode::stor:
+        case opcode::stori:
+        case opcode::jmp:
+        case opcode::jal:
+        case opcode::bt:
+        case opcode::bf:
+            inst.address = binary_deserialize<size_t>(bsr);
+            break;
+
+        case opcode::call:
+        case opcode::callv:
+            inst.verb = binary_deserialize<int>(bsr);
+            break;
+
+        case opcode::dup:
+        case opcode::ret:
+        case opcode::neg:
+        case opcode::lnot:
+        case opcode::add:
+        case opcode::sub:
+        case opcode::mul:
+        case opcode::div:
+        case opcode::mod:
+        case opcode::bor:
+        case opcode::band:
+        case opcode::bxor:
+        case opcode::lor:
+        case opcode::land:
+        case opcode::eq:
+        case opcode::ne:
+        case opcode::gt:
+        case opcode::ge:
+        case opcode::lt:
+        case opcode::le:
+            break;
+
+        default:
+            LOG_FATAL(format("invalid opcode %d at program offset %d") %
+                      static_cast<int>(inst.op) %
+                      program_counter);
+        }
+
+        inst.next_program_counter = sr.position();
+    }
+
+    // Programs which run off the end return, instead of running past the instruction array.
+    instruction_index[program.size()] = instructions.size();
+    instructions.emplace_back();
+    decoded_instruction &sentinel = instructions.back();
+    sentinel.op = opcode::ret;
+    sentinel.program_counter = program.size();
+    sentinel.next_program_counter = program.size();
+
+    // Resolve branch targets
+    for(auto &inst : instructions) {
+        switch(inst.op) {
+        case opcode::jmp:
+        case opcode::jal:
+        case opcode::bt:
+        case opcode::bf:
+            inst.target = index_of(inst.address);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+gorc::cog::decoded_program::decoded_program(decoded_program const &program,
+                                            message_table const &exports)
+    : instruction_index(program.instruction_index.size(), invalid_index)
+{
+    auto const &source = program.instructions;
+
+    // Fused sequences may begin, but not continue, at an entry point
+    std::vector<bool> is_entry(source.size(), false);
+    for(auto const &inst : source) {
+        switch(inst.op) {
+        case opcode::jmp:
+        case opcode::jal:
+        case opcode::bt:
+        case opcode::bf:
+            is_entry[inst.target] = true;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    for(auto const &exported : exports) {
+        size_t offset = exported.second;
+        if(offset < program.instruction_index.size() &&
+           program.instruction_index[offset] != invalid_index) {
+            is_entry[program.instruction_index[offset]] = true;
+        }
+    }
+
+    auto can_fuse = [&](size_t first, size_t count) {
+        if(first + count > source.size()) {
+            return false;
+        }
+
+        for(size_t i = first + 1; i < first + count; ++i) {
+            if(is_entry[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    std::vector<size_t> fused_index(source.size(), invalid_index);
+    size_t i = 0;
+    while(i < source.size()) {
+        decoded_instruction inst = source[i];
+        size_t count = 1;
+
+        if(inst.op == opcode::load &&
+           can_fuse(i, 3) &&
+           is_fusable_operator(source[i + 2].op)) {
+            auto const &operand = source[i + 1];
+            if(operand.op == opcode::load) {
+                inst.op = opcode::load_load_op;
+                inst.operation = source[i + 2].op;
+                inst.second_address = operand.address;
+                count = 3;
+            }
+            else if(operand.op == opcode::push) {
+                inst.op = opcode::load_push_op;
+                inst.operation = source[i + 2].op;
+                inst.immediate = operand.immediate;
+                count = 3;
+
+                if(can_fuse(i, 4)) {
+                    auto const &consumer = source[i + 3];
+                    switch(consumer.op) {
+                    case opcode::stor:
+                        inst.op = opcode::load_push_op_stor;
+                        inst.second_address = consumer.address;
+                        count = 4;
+                        break;
+
+                    case opcode::bt:
+                        inst.op = opcode::load_push_op_bt;
+                        inst.target = consumer.target;
+                        count = 4;
+                        break;
+
+                    case opcode::bf:
+                        inst.op = opcode::load_push_op_bf;
+                        inst.target = consumer.target;
+                        count = 4;
+                        break;
+
+                    default:
+                        break;
+                    }
+                }
+            }
+        }
+
+        inst.next_program_counter = source[i + count - 1].next_program_counter;
+        inst.source_instructions = count;
+
+        fused_index[i] = instructions.size();
+        instruction_index[inst.program_counter] = instructions.size();
+        instructions.push_back(inst);
+
+        i += count;
+    }
+
+    // Branch targets are entry points, which always begin an instruction
+    for(auto &inst : instructions) {
+        switch(inst.op) {
+        case opcode::jmp:
+        case opcode::jal:
+        case opcode::bt:
+        case opcode::bf:
+        case opcode::load_push_op_bt:
+        case opcode::load_push_op_bf:
+            inst.target = fused_index[inst.target];
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+size_t gorc::cog::decoded_program::index_of(size_t program_counter) const
+{
+    if(program_counter >= instruction_index.size() ||
+       instruction_index[program_counter] == invalid_index) {
+        LOG_FATAL(format("program offset %d is not an instruction boundary") % program_counter);
+    }
+
+    return instruction_index[program_counter];
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "opcode.hpp"
+#include "jk/cog/script/value.hpp"
+#include "jk/cog/script/message_table.hpp"
+#include "io/memory_file.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        class decoded_instruction {
+        public:
+            opcode op;
+
+            // Heap address for LOAD/LOADI/STOR/STORI, program offset for branches.
+            size_t address = 0;
+
+            // Operator and second heap address of fused instructions.
+            opcode operation = opcode::add;
+            size_t second_address = 0;
+
+            // Instruction index of the branch target.
+            size_t target = 0;
+
+            // Program offsets of this instruction and of the following instruction.
+            size_t program_counter = 0;
+            size_t next_program_counter = 0;
+
+            // Instructions of the program text this instruction executes. Greater than one for
+            // fused instructions.
+            size_t source_instructions = 1;
+
+            // Immediate for PUSH.
+            value immediate;
+
+            // Verb for CALL/CALLV.
+            int verb = 0;
+        };
+
+        // Instruction stream decoded once from a script's program text. Branch targets are
+        // resolved to instruction indices. Continuations keep program offsets, which are mapped
+        // to instruction indices on entry. The stream always ends with a return instruction at
+        // the end offset of the program text.
+        class decoded_program {
+        private:
+            std::vector<decoded_instruction> instructions;
+            std::vector<size_t> instruction_index;
+
+        public:
+            explicit decoded_program(memory_file const &program);
+
+            // Copies the program, fusing common instruction sequences into single instructions.
+            // Sequences never contain calls, and never span an exported entry point or a branch
+            // target, so every offset a continuation can resume from maps to an instruction.
+            decoded_program(decoded_program const &program, message_table const &exports);
+
+            size_t index_of(size_t program_counter) const;
+
+            inline decoded_instruction const* data() const
+            {
+                return instructions.data();
+            }
+
+            inline size_t size() const
+            {
+                return instructions.size();
+            }
+        };
+
+    }
+}
@@ -1,11 +1,8 @@
 #include "executor.hpp"
 #include "log/log.hpp"
 #include "utility/range.hpp"
-
-bool gorc::cog::detail::executor_link_comp::operator()(value left, value right) const
-{
-    return std::make_tuple(left.get_type(), left) < std::make_tuple(right.get_type(), right);
-}
+#include <algorithm>
+#include <functional>
 
 bool gorc::cog::detail::executor_wait_comp::operator()(
         std::tuple<message_type, value> const &left,
@@ -15,6 +12,20 @@ bool gorc::cog::detail::executor_wait_comp::operator()(
            std::make_tuple(std::get<0>(right), std::get<1>(right).get_type(), std::get<1>(right));
 }
 
+size_t gorc::cog::detail::executor_wait_hash::operator()(
+        std::tuple<message_type, value> const &key) const
+{
+    return std::hash<int>()(static_cast<int>(std::get<0>(key))) ^ (std::get<1>(key).hash() << 1);
+}
+
+bool gorc::cog::detail::executor_wait_same::operator()(
+        std::tuple<message_type, value> const &left,
+        std::tuple<message_type, value> const &right) const
+{
+    return std::get<0>(left) == std::get<0>(right) &&
+           std::get<1>(left).is_identical(std::get<1>(right));
+}
+
 bool gorc::cog::detail::executor_gi_comp::operator()(
         asset_ref<script> left,
         asset_ref<script> right) const
@@ -31,6 +42,21 @@ bool gorc::cog::detail::executor_timer_comp::operator()(
            std::make_tuple(std::get<0>(right), std::get<1>(right).get_type(), std::get<1>(right));
 }
 
+bool gorc::cog::detail::executor_timer_schedule_comp::operator()(
+        executor_timer_map::iterator left,
+        executor_timer_map::iterator right) const
+{
+    return executor_timer_comp()(left->first, right->first);
+}
+
+gorc::cog::detail::executor_broadcast_target::executor_broadcast_target(cog_id instance_id,
+                                                                      size_t address)
+    : instance_id(instance_id)
+    , address(address)
+{
+    return;
+}
+
 gorc::cog::executor::executor(service_registry const &parent)
     : verbs(parent.get<verb_table>())
     , services(&parent)
@@ -51,16 +77,26 @@ gorc::cog::executor::executor(deserialization_constructor_tag, binary_input_stre
             return std::make_unique<instance>(deserialization_constructor, bis);
         });
 
-    binary_deserialize_range(bis, std::back_inserter(sleep_records), [](auto &bis) {
-            return std::make_unique<sleep_record>(deserialization_constructor, bis);
-        });
+    for(size_t i = 0; i < instances.size(); ++i) {
+        add_broadcast_targets(cog_id(i), *instances[i]);
+    }
 
-    binary_deserialize_range(bis, std::inserter(wait_records, wait_records.end()), [](auto &bis) {
-            auto mt = binary_deserialize<message_type>(bis);
-            auto obj = binary_deserialize<value>(bis);
-            auto cont = std::make_unique<continuation>(deserialization_constructor, bis);
-            return std::make_pair(std::make_tuple(mt, obj), std::move(cont));
-        });
+    current_time = binary_deserialize<time_delta>(bis);
+
+    size_t num_sleep_records = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_sleep_records; ++i) {
+        auto sr = std::make_unique<sleep_record>(deserialization_constructor, bis);
+        time_delta expiration_time = sr->expiration_time;
+        sleep_records.insert(expiration_time, std::move(sr));
+    }
+
+    size_t num_wait_records = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_wait_records; ++i) {
+        auto mt = binary_deserialize<message_type>(bis);
+        auto obj = binary_deserialize<value>(bis);
+        auto cont = std::make_unique<continuation>(deserialization_constructor, bis);
+        wait_records[std::make_tuple(mt, obj)].push_back(std::move(cont));
+    }
 
     binary_deserialize_range(bis, std::inserter(pulse_records, pulse_records.end()), [](auto &is) {
             auto inst = binary_deserialize<cog_id>(is);
@@ -74,11 +110,14 @@ gorc::cog::executor::executor(deserialization_constructor_tag, binary_input_stre
                                   timer_record(deserialization_constructor, is));
         });
 
-    binary_deserialize_range(bis, std::inserter(linkages, linkages.end()), [](auto &bis) {
-            auto obj = binary_deserialize<value>(bis);
-            auto st = binary_deserialize<executor_linkage>(bis);
-            return std::make_pair(obj, st);
-        });
+    size_t num_linkages = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_linkages; ++i) {
+        auto obj = binary_deserialize<value>(bis);
+        auto st = binary_deserialize<executor_linkage>(bis);
+        linkages.emplace(obj, st);
+    }
+
+    linkages.compact();
 
     binary_deserialize_range(bis, std::inserter(global_instance_map, global_instance_map.end()),
         [](auto &bis) {
@@ -88,6 +127,8 @@ gorc::cog::executor::executor(deserialization_constructor_tag, binary_input_stre
         });
 
     master_cog = binary_deserialize<cog_id>(bis);
+
+    rebuild_schedules();
 }
 
 void gorc::cog::executor::binary_serialize_object(binary_output_stream &bos) const
@@ -96,13 +137,28 @@ void gorc::cog::executor::binary_serialize_object(binary_output_stream &bos) con
             binary_serialize(bos, *em);
         });
 
+    binary_serialize(bos, current_time);
+
     binary_serialize_range(bos, sleep_records, [](auto &bos, auto const &em) {
-            binary_serialize(bos, *em);
+            binary_serialize(bos, *em.value);
         });
 
-    binary_serialize_range(bos, wait_records, [](auto &bos, auto const &em) {
-            binary_serialize(bos, std::get<0>(em.first));
-            binary_serialize(bos, std::get<1>(em.first));
+    // Hashed iteration order is unspecified. Serialize wait records in key order, and in
+    // insertion order within each key.
+    std::vector<std::pair<std::tuple<message_type, value> const*, continuation const*>> waits;
+    for(auto const &em : wait_records) {
+        for(auto const &cc : em.second) {
+            waits.emplace_back(&em.first, cc.get());
+        }
+    }
+
+    std::stable_sort(waits.begin(), waits.end(), [](auto const &left, auto const &right) {
+            return detail::executor_wait_comp()(*left.first, *right.first);
+        });
+
+    binary_serialize_range(bos, waits, [](auto &bos, auto const &em) {
+            binary_serialize(bos, std::get<0>(*em.first));
+            binary_serialize(bos, std::get<1>(*em.first));
             binary_serialize(bos, *em.second);
         });
 
@@ -140,13 +196,41 @@ void gorc::cog::executor::add_linkage(cog_id id, instance const &inst)
     }
 }
 
+void gorc::cog::executor::add_broadcast_targets(cog_id id, instance const &inst)
+{
+    for(auto const &em : inst.cog->exports) {
+        // Nested instances are created before their parent. Keep targets in instance order.
+        auto &targets = broadcast_targets[em.first];
+        auto it = std::upper_bound(targets.begin(),
+                                   targets.end(),
+                                   id,
+                                   [](cog_id left, detail::executor_broadcast_target const &right) {
+                                       return left < right.instance_id;
+                                   });
+        targets.emplace(it, id, em.second);
+    }
+}
+
+void gorc::cog::executor::rebuild_schedules()
+{
+    for(auto const &pulse : pulse_records) {
+        pulse_schedule.insert(pulse.second.expiration_time, pulse.first);
+    }
+
+    for(auto it = timer_records.begin(); it != timer_records.end(); ++it) {
+        timer_schedule.insert(it->second.expiration_time, it);
+    }
+}
+
 gorc::cog_id gorc::cog::executor::create_instance(asset_ref<cog::script> cog)
 {
     /* Creating this instance may create more instances. Reserve space. */
     cog_id new_cog(static_cast<int>(instances.size()));
     instances.push_back(nullptr);
     at_id(instances, new_cog) = std::make_unique<instance>(services, cog);
-    add_linkage(new_cog, *instances.back());
+    add_linkage(new_cog, *at_id(instances, new_cog));
+    add_broadcast_targets(new_cog, *at_id(instances, new_cog));
+    vm.load_program(*cog);
     return new_cog;
 }
 
@@ -157,7 +241,9 @@ gorc::cog_id gorc::cog::executor::create_instance(asset_ref<cog::script> cog,
     cog_id new_cog(static_cast<int>(instances.size()));
     instances.push_back(nullptr);
     at_id(instances, new_cog) = std::make_unique<instance>(services, cog, values);
-    add_linkage(new_cog, *instances.back());
+    add_linkage(new_cog, *at_id(instances, new_cog));
+    add_broadcast_targets(new_cog, *at_id(instances, new_cog));
+    vm.load_program(*cog);
     return new_cog;
 }
 
@@ -174,7 +260,9 @@ gorc::cog_id gorc::cog::executor::create_global_instance(asset_ref<cog::script>
     global_instance_map.emplace(cog, new_cog);
 
     at_id(instances, new_cog) = std::make_unique<instance>(services, cog);
-    add_linkage(new_cog, *instances.back());
+    add_linkage(new_cog, *at_id(instances, new_cog));
+    add_broadcast_targets(new_cog, *at_id(instances, new_cog));
+    vm.load_program(*cog);
     return new_cog;
 }
 
@@ -185,15 +273,17 @@ gorc::cog::instance& gorc::cog::executor::get_instance(cog_id instance_id)
 
 void gorc::cog::executor::add_sleep_record(std::unique_ptr<sleep_record> &&sr)
 {
-    sleep_records.push_back(std::forward<std::unique_ptr<sleep_record>>(sr));
+    sr->expiration_time += current_time;
+    time_delta expiration_time = sr->expiration_time;
+    sleep_records.insert(expiration_time, std::forward<std::unique_ptr<sleep_record>>(sr));
 }
 
 void gorc::cog::executor::add_wait_record(message_type msg,
                                           value sender,
                                           std::unique_ptr<continuation> &&cc)
 {
-    wait_records.emplace(std::make_tuple(msg, sender),
-                         std::forward<std::unique_ptr<continuation>>(cc));
+    wait_records[std::make_tuple(msg, sender)].push_back(
+            std::forward<std::unique_ptr<continuation>>(cc));
 }
 
 void gorc::cog::executor::add_timer_record(cog_id instance_id,
@@ -202,22 +292,37 @@ void gorc::cog::executor::add_timer_record(cog_id instance_id,
                                            value param0,
                                            value param1)
 {
-    timer_records.emplace(std::make_tuple(instance_id, timer_id),
-                          timer_record(duration, param0, param1));
+    auto it = timer_records.emplace(std::make_tuple(instance_id, timer_id),
+                                    timer_record(duration,
+                                                 current_time + duration,
+                                                 param0,
+                                                 param1));
+    timer_schedule.insert(it->second.expiration_time, it);
 }
 
 void gorc::cog::executor::erase_timer_record(cog_id instance_id,
                                              value timer_id)
 {
-    timer_records.erase(std::make_tuple(instance_id, timer_id));
+    auto rng = timer_records.equal_range(std::make_tuple(instance_id, timer_id));
+    for(auto it = rng.first; it != rng.second; ++it) {
+        timer_schedule.erase(it->second.expiration_time, it);
+    }
+
+    timer_records.erase(rng.first, rng.second);
 }
 
 void gorc::cog::executor::set_pulse(cog_id instance_id,
                                     maybe<time_delta> duration)
 {
-    pulse_records.erase(instance_id);
+    auto it = pulse_records.find(instance_id);
+    if(it != pulse_records.end()) {
+        pulse_schedule.erase(it->second.expiration_time, instance_id);
+        pulse_records.erase(it);
+    }
+
     maybe_if(duration, [&](time_delta dt) {
-            pulse_records.emplace(instance_id, pulse_record(dt));
+            pulse_records.emplace(instance_id, pulse_record(dt, current_time + dt));
+            pulse_schedule.insert(current_time + dt, instance_id);
         });
 }
 
@@ -278,25 +383,30 @@ gorc::cog::value gorc::cog::executor::send(cog_id instance,
         return value();
     }
 
-    diagnostic_context dc(inst->cog->filename.c_str());
-    LOG_DEBUG(format("instance %d received %s message %s "
-                     "from sender %s due to source %s") %
-              static_cast<int>(instance) %
-              send_reason %
-              as_string(t) %
-              as_string(sender) %
-              as_string(source));
-
-    continuation cc(call_stack_frame(instance,
-                                     addr.get_value(),
-                                     sender,
-                                     sender_id,
-                                     source,
-                                     param0,
-                                     param1,
-                                     param2,
-                                     param3));
-    return vm.execute(verbs, *this, services, cc);
+    if(log_level_enabled(log_level::debug)) {
+        diagnostic_context dc(inst->cog->filename.c_str());
+        LOG_DEBUG(format("instance %d received %s message %s "
+                         "from sender %s due to source %s") %
+                  static_cast<int>(instance) %
+                  send_reason %
+                  as_string(t) %
+                  as_string(sender) %
+                  as_string(source));
+    }
+
+    auto cc = continuations.acquire(call_stack_frame(instance,
+                                                     addr.get_value(),
+                                                     sender,
+                                                     sender_id,
+                                                     source,
+                                                     param0,
+                                                     param1,
+                                                     param2,
+                                                     param3));
+    cc->handler = t;
+    value rv = vm.execute(verbs, *this, services, *cc);
+    continuations.release(std::move(cc));
+    return rv;
 }
 
 void gorc::cog::executor::send_to_all(message_type t,
@@ -308,17 +418,55 @@ void gorc::cog::executor::send_to_all(message_type t,
                                       value param2,
                                       value param3)
 {
-    for(size_t i = 0; i < instances.size(); ++i) {
-        send(cog_id(i),
-             t,
-             sender,
-             sender_id,
-             source,
-             param0,
-             param1,
-             param2,
-             param3,
-             "broadcast");
+    auto targets_it = broadcast_targets.find(t);
+    if(targets_it == broadcast_targets.end()) {
+        return;
+    }
+
+    // Handlers may create instances, which are appended to the target list.
+    auto const &targets = targets_it->second;
+    bool log_enabled = log_level_enabled(log_level::debug);
+
+    // Sleeping and waiting handlers copy the continuation, so one buffer serves every target.
+    std::unique_ptr<continuation> cc;
+    for(size_t i = 0; i < targets.size(); ++i) {
+        auto target = targets[i];
+
+        if(log_enabled) {
+            diagnostic_context dc(at_id(instances, target.instance_id)->cog->filename.c_str());
+            LOG_DEBUG(format("instance %d received broadcast message %s "
+                             "from sender %s due to source %s") %
+                      static_cast<int>(target.instance_id) %
+                      as_string(t) %
+                      as_string(sender) %
+                      as_string(source));
+        }
+
+        call_stack_frame frame(target.instance_id,
+                               target.address,
+                               sender,
+                               sender_id,
+                               source,
+                               param0,
+                               param1,
+                               param2,
+                               param3);
+
+        if(cc) {
+            cc->call_stack.clear();
+            cc->data_stack.clear();
+            cc->call_stack.push_back(std::move(frame));
+        }
+        else {
+            cc = continuations.acquire(std::move(frame));
+        }
+
+        cc->handler = t;
+        vm.execute(verbs, *this, services, *cc);
+    }
+
+    if(cc) {
+        continuations.release(std::move(cc));
     }
 }
 
@@ -332,36 +480,73 @@ void gorc::cog::executor::send_to_linked(message_type t,
                                          value param3)
 {
     // Dispatch message to all linked level cogs
-    for(auto const &link : make_range(linkages.equal_range(sender))) {
-        // System source type cannot be masked.
-        if(!(link.second.mask & st) && (st != source_type::system)) {
-            // This source type is masked. Don't dispatch message.
-            continue;
-        }
+    linkages.for_each(sender, [&](executor_linkage const &link) {
+            // System source type cannot be masked.
+            if(!(link.mask & st) && (st != source_type::system)) {
+                // This source type is masked. Don't dispatch message.
+                return;
+            }
 
-        send(link.second.instance_id,
-             t,
-             sender,
-             link.second.sender_link_id,
-             source,
-             param0,
-             param1,
-             param2,
-             param3,
-             "linked");
-    }
+            send(link.instance_id,
+                 t,
+                 sender,
+                 link.sender_link_id,
+                 source,
+                 param0,
+                 param1,
+                 param2,
+                 param3,
+                 "linked");
+        });
 
     // Some cogs may have blocked on a particular message. For example, the
     // WaitForStop verb blocks until the correct arrived message is sent.
-    // Resume any continuations matching this message.
-    auto wait_rng = wait_records.equal_range(std::make_tuple(t, sender));
-    for(auto it = wait_rng.first; it != wait_rng.second;) {
-        auto curr_it = it++;
-        vm.execute(verbs, *this, services, *curr_it->second);
-        wait_records.erase(curr_it);
+    // Resume any continuations matching this message. Continuations which wait
+    // again are resumed by the next matching message.
+    auto wait_key = std::make_tuple(t, sender);
+    auto wait_it = wait_records.find(wait_key);
+    if(wait_it != wait_records.end()) {
+        auto waiting = std::move(wait_it->second);
+        wait_records.erase(wait_it);
+
+        size_t resumed = 0;
+        try {
+            for(; resumed < waiting.size(); ++resumed) {
+                vm.execute(verbs, *this, services, *waiting[resumed]);
+            }
+        }
+        catch(...) {
+            // Continuations which were not resumed keep waiting, ahead of any added during
+            // dispatch.
+            auto &still_waiting = wait_records[wait_key];
+            still_waiting.insert(still_waiting.begin(),
+                                 std::make_move_iterator(waiting.begin() + static_cast<std::ptrdiff_t>(resumed)),
+                                 std::make_move_iterator(waiting.end()));
+            throw;
+        }
     }
 }
 
+void gorc::cog::executor::compact_linkages()
+{
+    linkages.compact();
+}
+
+void gorc::cog::executor::set_fused_tier_enabled(bool enabled)
+{
+    vm.set_fused_tier_enabled(enabled);
+}
+
+void gorc::cog::executor::set_fused_tier_threshold(int threshold)
+{
+    vm.set_fused_tier_threshold(threshold);
+}
+
+void gorc::cog::executor::set_profiler(maybe<profiler *> prof)
+{
+    vm.set_profiler(prof);
+}
+
 void gorc::cog::executor::set_master_cog(cog_id id)
 {
     master_cog = id;
@@ -374,85 +559,59 @@ gorc::cog_id gorc::cog::executor::get_master_cog() const
 
 void gorc::cog::executor::update(time_delta dt)
 {
-    // Decrement times first.
-    // Continuations may insert new records. The new records shouldn't be decremented this frame.
-    for(auto &timer_record : timer_records) {
-        timer_record.second.remaining -= dt;
-    }
+    current_time += dt;
 
-    for(auto &pulse_record : pulse_records) {
-        pulse_record.second.remaining -= dt;
-    }
+    // Handlers may insert and erase records while due records are dispatched. Records which
+    // come due during dispatch are fired in the same update. Records are fired in deadline
+    // order, so a timer set with a shorter delay fires first even if it has a later key.
+    while(true) {
+        auto due = timer_schedule.pop_due(current_time);
+        if(!due.has_value()) {
+            break;
+        }
+
+        auto it = due.get_value();
+        cog_id instance = std::get<0>(it->first);
+        value sender_id = std::get<1>(it->first);
+        value param0 = it->second.param0;
+        value param1 = it->second.param1;
 
-    for(auto &sleep_record : sleep_records) {
-        sleep_record->expiration_time -= dt;
+        timer_records.erase(it);
+
+        send(instance,
+             message_type::timer,
+             /* sender */ value(),
+             sender_id,
+             /* source */ value(),
+             param0,
+             param1);
     }
 
-    // Intentionally quadratic. The timer records data structure may be modified by timer event
-    // handlers. Repeatedly searching the map is still more efficient than copying this data.
     while(true) {
-        bool seen_any = false;
-        for(auto it = timer_records.begin(); it != timer_records.end(); ++it) {
-            if(it->second.remaining <= 0.0s) {
-                cog_id instance = std::get<0>(it->first);
-                value sender_id = std::get<1>(it->first);
-                value param0 = it->second.param0;
-                value param1 = it->second.param1;
-
-                timer_records.erase(it);
-
-                send(instance,
-                     message_type::timer,
-                     /* sender */ value(),
-                     sender_id,
-                     /* source */ value(),
-                     param0,
-                     param1);
-
-                seen_any = true;
-                break;
-            }
-        }
-
-        if(!seen_any) {
+        auto due = pulse_schedule.pop_due(current_time);
+        if(!due.has_value()) {
             break;
         }
+
+        cog_id instance = due.get_value();
+        auto &pulse = pulse_records.at(instance);
+        pulse.expiration_time += pulse.duration;
+        pulse_schedule.insert(pulse.expiration_time, instance);
+
+        send(instance,
+             message_type::pulse,
+             /* sender */ value(),
+             /* sender id */ value(),
+             /* source */ value());
     }
 
-    // Intentionally quadratic. The pulse records data structure may be modified by pulse event
-    // handlers. Repeatedly searching the map is still more efficient than copying this data.
     while(true) {
-        bool seen_any = false;
-        for(auto it = pulse_records.begin(); it != pulse_records.end(); ++it) {
-            if(it->second.remaining <= 0.0s) {
-                it->second.remaining += it->second.duration;
-
-                send(it->first,
-                     message_type::pulse,
-                     /* sender */ value(),
-                     /* sender id */ value(),
-                     /* source */ value());
-
-                seen_any = true;
-                break;
-            }
-        }
-
-        if(!seen_any) {
+        auto due = sleep_records.pop_due(current_time);
+        if(!due.has_value()) {
             break;
         }
-    }
-
-    for(auto it = sleep_records.begin(); it != sleep_records.end(); ) {
-        if((*it)->expiration_time <= 0.0s) {
-            auto sr = std::move(*it);
-            std::swap(*it, sleep_records.back());
-            sleep_records.pop_back();
 
-            vm.execute(verbs, *this, services, sr->cc);
-        }
-        else {
-            ++it;
-        }
+        auto sr = std::move(due.get_value());
+        vm.execute(verbs, *this, services, sr->cc);
     }
 }
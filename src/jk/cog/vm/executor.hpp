@@ -11,24 +11,34 @@
 #include "jk/cog/script/verb_table.hpp"
 #include "utility/service_registry.hpp"
 #include "call_stack_frame.hpp"
+#include "continuation_pool.hpp"
+#include "deadline_schedule.hpp"
+#include "value_index.hpp"
 #include "content/asset_ref.hpp"
 #include "io/binary_input_stream.hpp"
 #include "io/binary_output_stream.hpp"
 #include "utility/range.hpp"
+#include "utility/enum_hash.hpp"
 #include <vector>
 #include <memory>
 #include <map>
 #include <tuple>
+#include <unordered_map>
 
 namespace gorc {
     namespace cog {
 
         namespace detail {
-            struct executor_link_comp {
-                bool operator()(value left, value right) const;
+            struct executor_wait_comp {
+                bool operator()(std::tuple<message_type, value> const&,
+                                std::tuple<message_type, value> const&) const;
             };
 
-            struct executor_wait_comp {
+            struct executor_wait_hash {
+                size_t operator()(std::tuple<message_type, value> const&) const;
+            };
+
+            struct executor_wait_same {
                 bool operator()(std::tuple<message_type, value> const&,
                                 std::tuple<message_type, value> const&) const;
             };
@@ -41,31 +51,62 @@ namespace gorc {
                 bool operator()(std::tuple<cog_id, value> const &,
                                 std::tuple<cog_id, value> const &) const;
             };
+
+            using executor_timer_map = std::multimap<std::tuple<cog_id, value>,
+                                                     timer_record,
+                                                     executor_timer_comp>;
+
+            struct executor_timer_schedule_comp {
+                bool operator()(executor_timer_map::iterator left,
+                                executor_timer_map::iterator right) const;
+            };
+
+            struct executor_broadcast_target {
+                cog_id instance_id;
+                size_t address;
+
+                executor_broadcast_target(cog_id instance_id, size_t address);
+            };
         }
 
         class executor {
         private:
             verb_table &verbs;
             virtual_machine vm;
+            continuation_pool continuations;
             service_registry services;
 
             std::vector<std::unique_ptr<instance>> instances;
 
-            std::vector<std::unique_ptr<sleep_record>> sleep_records;
-            std::multimap<std::tuple<message_type, value>,
-                          std::unique_ptr<continuation>,
-                          detail::executor_wait_comp> wait_records;
+            // Time elapsed since the executor was created. Sleep, pulse and timer records
+            // expire at absolute times, so update does not need to visit pending records.
+            time_delta current_time = 0.0s;
+
+            deadline_schedule<std::unique_ptr<sleep_record>> sleep_records;
+            std::unordered_map<std::tuple<message_type, value>,
+                               std::vector<std::unique_ptr<continuation>>,
+                               detail::executor_wait_hash,
+                               detail::executor_wait_same> wait_records;
             std::map<cog_id, pulse_record> pulse_records;
-            std::multimap<std::tuple<cog_id, value>,
-                          timer_record,
-                          detail::executor_timer_comp> timer_records;
+            deadline_schedule<cog_id, std::less<cog_id>> pulse_schedule;
+            detail::executor_timer_map timer_records;
+            deadline_schedule<detail::executor_timer_map::iterator,
+                              detail::executor_timer_schedule_comp> timer_schedule;
 
-            std::multimap<value, executor_linkage, detail::executor_link_comp> linkages;
+            value_index<executor_linkage> linkages;
             std::map<asset_ref<script>, cog_id, detail::executor_gi_comp> global_instance_map;
 
+            // Instances exporting each message, in instance order. Derived from the instances,
+            // so it is not serialized.
+            std::unordered_map<message_type,
+                               std::vector<detail::executor_broadcast_target>,
+                               enum_hash<message_type>> broadcast_targets;
+
             cog_id master_cog;
 
             void add_linkage(cog_id id, instance const &inst);
+            void add_broadcast_targets(cog_id id, instance const &inst);
+            void rebuild_schedules();
 
         public:
             executor(service_registry const &svc);
@@ -79,6 +120,7 @@ namespace gorc {
 
             instance& get_instance(cog_id instance_id);
 
+            // The sleep record's expiration time is relative to the current time.
             void add_sleep_record(std::unique_ptr<sleep_record> &&);
             void add_wait_record(message_type msg, value sender, std::unique_ptr<continuation>&&);
             void add_timer_record(cog_id, value id, time_delta, value param0, value param1);
@@ -124,9 +166,21 @@ namespace gorc {
                                 value param2 = value(),
                                 value param3 = value());
 
+            // Rebuilds the linkage index with a flat layout. Call once level cogs are created.
+            void compact_linkages();
+
+            // Fused tier and profiler settings are not serialized.
+            void set_fused_tier_enabled(bool enabled);
+            void set_fused_tier_threshold(int threshold);
+            void set_profiler(maybe<profiler *> prof);
+
             void set_master_cog(cog_id);
             cog_id get_master_cog() const;
 
+            // Fires every timer and pulse, and resumes every sleep, which has come due. Records
+            // are dispatched in order of expiration time, even when several expire in one
+            // update. Timers expiring at the same time fire in (cog, id) order, and pulses in
+            // cog order.
             void update(time_delta dt);
 
             inline auto get_linkages() const
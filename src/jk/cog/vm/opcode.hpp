@@ -5,6 +5,11 @@
 namespace gorc {
     namespace cog {
 
+        // Version of the compiled program format. Increment whenever the opcode set, the
+        // instruction encoding, or the code emitted by codegen or the IR optimizer changes.
+        // Cached compiled scripts written under another version are never loaded.
+        constexpr uint32_t compiled_format_version = 1;
+
         enum class opcode : uint8_t {
             push = 1,       // PUSH [immediate] : push immediate
             dup,            // DUP : duplicate top value
@@ -45,6 +50,14 @@ namespace gorc {
             ge,             // GE : greater or equal
             lt,             // LT : less than
             le,             // LE : less or equal
+
+            // Fused instructions are produced by the decoder for programs in the fused tier.
+            // They are not valid in program text.
+            load_load_op,       // LOAD a; LOAD b; <op>
+            load_push_op,       // LOAD a; PUSH [immediate]; <op>
+            load_push_op_stor,  // LOAD a; PUSH [immediate]; <op>; STOR b
+            load_push_op_bt,    // LOAD a; PUSH [immediate]; <op>; BT [address]
+            load_push_op_bf,    // LOAD a; PUSH [immediate]; <op>; BF [address]
         };
 
     }
@@ -0,0 +1,78 @@
+#include "profiler.hpp"
+#include <boost/format.hpp>
+#include <algorithm>
+#include <vector>
+
+size_t gorc::cog::handler_profile::total_verb_calls() const
+{
+    size_t rv = 0;
+    for(auto const &em : verb_calls) {
+        rv += em.second;
+    }
+
+    return rv;
+}
+
+gorc::cog::handler_profile& gorc::cog::profiler::get_handler_profile(std::string const &filename,
+                                                                     message_type msg)
+{
+    return handlers[std::make_tuple(filename, msg)];
+}
+
+void gorc::cog::profiler::write_report(std::ostream &os, verb_table const &verbs) const
+{
+    using handler_entry = decltype(handlers)::value_type;
+
+    // Ties keep the filename and message order of the handler map.
+    std::vector<handler_entry const *> sorted_handlers;
+    for(auto const &em : handlers) {
+        sorted_handlers.push_back(&em);
+    }
+
+    std::stable_sort(sorted_handlers.begin(),
+                     sorted_handlers.end(),
+                     [](handler_entry const *left, handler_entry const *right) {
+            return left->second.wall_time > right->second.wall_time;
+        });
+
+    os << boost::format("%-24s %-12s %10s %14s %10s %12s\n") %
+          "script" %
+          "handler" %
+          "calls" %
+          "instructions" %
+          "verbs" %
+          "time (ms)";
+
+    for(auto const *em : sorted_handlers) {
+        auto const &profile = em->second;
+        double wall_time_ms =
+            std::chrono::duration<double, std::milli>(profile.wall_time).count();
+
+        os << boost::format("%-24s %-12s %10d %14d %10d %12.3f\n") %
+              std::get<0>(em->first) %
+              as_string(std::get<1>(em->first)) %
+              profile.invocations %
+              profile.instructions %
+              profile.total_verb_calls() %
+              wall_time_ms;
+
+        std::vector<std::pair<int, size_t>> sorted_verbs(profile.verb_calls.begin(),
+                                                         profile.verb_calls.end());
+        std::stable_sort(sorted_verbs.begin(),
+                         sorted_verbs.end(),
+                         [](auto const &left, auto const &right) {
+                return left.second > right.second;
+            });
+
+        for(auto const &verb_call : sorted_verbs) {
+            os << boost::format("    %-33s %10d\n") %
+                  verbs.get_verb(verb_id(verb_call.first)).name %
+                  verb_call.second;
+        }
+    }
+}
+
+void gorc::cog::profiler::clear()
+{
+    handlers.clear();
+}
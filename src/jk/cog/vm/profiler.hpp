@@ -0,0 +1,49 @@
+#pragma once
+
+#include "jk/cog/script/message_type.hpp"
+#include "jk/cog/script/verb_table.hpp"
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+
+namespace gorc {
+    namespace cog {
+
+        class handler_profile {
+        public:
+            // Messages sent to the handler, and resumptions of its suspended continuations.
+            size_t invocations = 0;
+
+            // Instructions of the program text, counted as they are dispatched. A fused instruction
+            // counts the instructions it replaces, so the count does not depend on the tier.
+            size_t instructions = 0;
+
+            // Verb calls, by verb id
+            std::map<int, size_t> verb_calls;
+
+            // Includes the time spent in messages sent synchronously by the handler.
+            std::chrono::steady_clock::duration wall_time = std::chrono::steady_clock::duration::zero();
+
+            size_t total_verb_calls() const;
+        };
+
+        // Execution counters for each script and message handler. Profiles are keyed by script
+        // filename, so that they outlive the content manager which loaded the script.
+        class profiler {
+        private:
+            std::map<std::tuple<std::string, message_type>, handler_profile> handlers;
+
+        public:
+            handler_profile& get_handler_profile(std::string const &filename, message_type msg);
+
+            // Writes one row per handler, in decreasing order of wall time, followed by the
+            // handler's verb calls in decreasing order of count.
+            void write_report(std::ostream &os, verb_table const &verbs) const;
+
+            void clear();
+        };
+
+    }
+}
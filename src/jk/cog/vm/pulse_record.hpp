@@ -9,9 +9,11 @@ namespace gorc {
         class pulse_record {
         public:
             time_delta duration;
-            time_delta remaining;
 
-            explicit pulse_record(time_delta const &duration);
+            // Absolute executor time of the next pulse.
+            time_delta expiration_time;
+
+            pulse_record(time_delta const &duration, time_delta const &expiration_time);
 
             pulse_record(deserialization_constructor_tag, binary_input_stream &bis);
 
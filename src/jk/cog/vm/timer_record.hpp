@@ -10,11 +10,14 @@ namespace gorc {
         class timer_record {
         public:
             time_delta duration;
-            time_delta remaining;
+
+            // Absolute executor time at which the timer fires.
+            time_delta expiration_time;
             value param0;
             value param1;
 
             timer_record(time_delta const &duration,
+                         time_delta const &expiration_time,
                          value param0,
                          value param1);
 
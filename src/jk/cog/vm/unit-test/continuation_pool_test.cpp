@@ -0,0 +1,61 @@
+#include "test/test.hpp"
+#include "jk/cog/vm/continuation_pool.hpp"
+
+using namespace gorc;
+using namespace gorc::cog;
+
+namespace {
+    call_stack_frame make_frame(int instance_id)
+    {
+        return call_stack_frame(cog_id(instance_id),
+                                0,
+                                value(),
+                                value(),
+                                value(),
+                                value(),
+                                value(),
+                                value(),
+                                value());
+    }
+}
+
+begin_suite(continuation_pool_test);
+
+test_case(acquire_release_reuse)
+{
+    continuation_pool pool;
+
+    auto cc = pool.acquire(make_frame(5));
+    assert_eq(cc->call_stack.size(), size_t(1));
+    assert_eq(cc->frame().instance_id, cog_id(5));
+    assert_true(cc->data_stack.empty());
+
+    cc->data_stack.push_back(value(10));
+    cc->call_stack.push_back(make_frame(6));
+
+    continuation *first = cc.get();
+    pool.release(std::move(cc));
+    assert_eq(pool.size(), size_t(1));
+
+    auto dd = pool.acquire(make_frame(7));
+    assert_eq(dd.get(), first);
+    assert_eq(pool.size(), size_t(0));
+    assert_eq(dd->call_stack.size(), size_t(1));
+    assert_eq(dd->frame().instance_id, cog_id(7));
+    assert_true(dd->data_stack.empty());
+}
+
+test_case(nested_acquire)
+{
+    continuation_pool pool;
+
+    auto outer = pool.acquire(make_frame(1));
+    auto inner = pool.acquire(make_frame(2));
+    assert_ne(outer.get(), inner.get());
+
+    pool.release(std::move(inner));
+    pool.release(std::move(outer));
+    assert_eq(pool.size(), size_t(2));
+}
+
+end_suite(continuation_pool_test);
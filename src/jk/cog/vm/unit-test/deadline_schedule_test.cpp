@@ -0,0 +1,152 @@
+#include "test/test.hpp"
+#include "jk/cog/vm/deadline_schedule.hpp"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::cog;
+
+namespace {
+    std::vector<int> pop_all_due(deadline_schedule<int> &schedule, time_delta now)
+    {
+        std::vector<int> rv;
+        while(true) {
+            auto due = schedule.pop_due(now);
+            if(!due.has_value()) {
+                break;
+            }
+
+            rv.push_back(due.get_value());
+        }
+
+        return rv;
+    }
+}
+
+begin_suite(deadline_schedule_test);
+
+test_case(deadline_order)
+{
+    deadline_schedule<int> schedule;
+    schedule.insert(3.0s, 3);
+    schedule.insert(1.0s, 1);
+    schedule.insert(2.0s, 2);
+    schedule.insert(1.0s, 4);
+
+    assert_eq(pop_all_due(schedule, 0.5s), std::vector<int>());
+    assert_eq(pop_all_due(schedule, 2.0s), (std::vector<int> { 1, 4, 2 }));
+    assert_eq(schedule.size(), size_t(1));
+    assert_eq(pop_all_due(schedule, 10.0s), (std::vector<int> { 3 }));
+}
+
+test_case(erase)
+{
+    deadline_schedule<int> schedule;
+    schedule.insert(1.0s, 1);
+    schedule.insert(1.0s, 2);
+    schedule.insert(2.0s, 3);
+
+    schedule.erase(1.0s, 2);
+    schedule.erase(1.0s, 3);
+    assert_eq(schedule.size(), size_t(2));
+
+    assert_eq(pop_all_due(schedule, 5.0s), (std::vector<int> { 1, 3 }));
+}
+
+test_case(tie_order)
+{
+    deadline_schedule<int, std::greater<int>> schedule;
+    schedule.insert(1.0s, 2);
+    schedule.insert(1.0s, 5);
+    schedule.insert(0.5s, 1);
+    schedule.insert(1.0s, 3);
+    schedule.insert(1.0s, 5);
+
+    std::vector<int> fired;
+    while(true) {
+        auto due = schedule.pop_due(1.0s);
+        if(!due.has_value()) {
+            break;
+        }
+
+        fired.push_back(due.get_value());
+    }
+
+    assert_eq(fired, (std::vector<int> { 1, 5, 5, 3, 2 }));
+}
+
+test_case(erase_among_equal_deadlines)
+{
+    deadline_schedule<int, std::less<int>> schedule;
+    for(int i = 999; i >= 0; --i) {
+        schedule.insert(1.0s, i);
+    }
+
+    schedule.insert(1.0s, 500);
+
+    for(int i = 0; i < 1000; i += 2) {
+        schedule.erase(1.0s, i);
+    }
+
+    schedule.erase(2.0s, 1);
+    assert_eq(schedule.size(), size_t(501));
+
+    std::vector<int> expected;
+    for(int i = 1; i < 1000; i += 2) {
+        expected.push_back(i);
+    }
+
+    expected.insert(std::find(expected.begin(), expected.end(), 501), 500);
+
+    std::vector<int> fired;
+    while(true) {
+        auto due = schedule.pop_due(1.0s);
+        if(!due.has_value()) {
+            break;
+        }
+
+        fired.push_back(due.get_value());
+    }
+
+    assert_eq(fired, expected);
+}
+
+test_case(insert_during_dispatch)
+{
+    deadline_schedule<int> schedule;
+    schedule.insert(1.0s, 1);
+
+    std::vector<int> fired;
+    while(true) {
+        auto due = schedule.pop_due(1.0s);
+        if(!due.has_value()) {
+            break;
+        }
+
+        int v = due.get_value();
+        fired.push_back(v);
+        if(v < 3) {
+            schedule.insert(0.5s, v + 1);
+        }
+
+        schedule.insert(4.0s, 10 * v);
+    }
+
+    assert_eq(fired, (std::vector<int> { 1, 2, 3 }));
+    assert_eq(schedule.size(), size_t(3));
+}
+
+test_case(move_only_values)
+{
+    deadline_schedule<std::unique_ptr<int>> schedule;
+    schedule.insert(1.0s, std::make_unique<int>(5));
+
+    auto due = schedule.pop_due(1.0s);
+    assert_true(due.has_value());
+    assert_eq(*due.get_value(), 5);
+    assert_eq(schedule.size(), size_t(0));
+}
+
+end_suite(deadline_schedule_test);
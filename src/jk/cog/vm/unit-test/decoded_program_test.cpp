@@ -0,0 +1,232 @@
+#include "test/test.hpp"
+#include "jk/cog/vm/decoded_program.hpp"
+#include "io/binary_output_stream.hpp"
+
+using namespace gorc;
+using namespace gorc::cog;
+
+begin_suite(decoded_program_test);
+
+test_case(decode_and_resolve_branches)
+{
+    memory_file program;
+    memory_file::writer w(program);
+    binary_output_stream bos(w);
+
+    binary_serialize(bos, opcode::push);
+    binary_serialize(bos, value(5));
+
+    size_t stor_offset = w.position();
+    binary_serialize(bos, opcode::stor);
+    binary_serialize(bos, size_t(2));
+
+    size_t branch_offset = w.position();
+    binary_serialize(bos, opcode::bf);
+    size_t branch_target_site = w.position();
+    binary_serialize(bos, size_t(0));
+
+    binary_serialize(bos, opcode::jmp);
+    binary_serialize(bos, size_t(0));
+
+    size_t ret_offset = w.position();
+    binary_serialize(bos, opcode::ret);
+
+    w.set_position(branch_target_site);
+    binary_serialize(bos, ret_offset);
+
+    decoded_program p(program);
+    assert_eq(p.size(), size_t(6));
+
+    auto const *code = p.data();
+    assert_eq(code[0].op, opcode::push);
+    assert_eq(static_cast<int>(code[0].immediate), 5);
+    assert_eq(code[0].next_program_counter, stor_offset);
+
+    assert_eq(code[1].op, opcode::stor);
+    assert_eq(code[1].address, size_t(2));
+    assert_eq(code[1].next_program_counter, branch_offset);
+
+    assert_eq(code[2].op, opcode::bf);
+    assert_eq(code[2].address, ret_offset);
+    assert_eq(code[2].target, size_t(4));
+
+    assert_eq(code[3].op, opcode::jmp);
+    assert_eq(code[3].target, size_t(0));
+
+    assert_eq(p.index_of(0), size_t(0));
+    assert_eq(p.index_of(branch_offset), size_t(2));
+    assert_eq(p.index_of(ret_offset), size_t(4));
+
+    assert_eq(code[5].op, opcode::ret);
+    assert_eq(p.index_of(program.size()), size_t(5));
+}
+
+test_case(invalid_program_counter)
+{
+    memory_file program;
+    memory_file::writer w(program);
+    binary_output_stream bos(w);
+
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(0));
+    binary_serialize(bos, opcode::ret);
+
+    decoded_program p(program);
+    assert_throws_logged(p.index_of(1));
+    assert_throws_logged(p.index_of(program.size() + 1));
+}
+
+test_case(sentinel_return)
+{
+    memory_file program;
+    memory_file::writer w(program);
+    binary_output_stream bos(w);
+
+    // No trailing return
+    binary_serialize(bos, opcode::push);
+    binary_serialize(bos, value(1));
+    binary_serialize(bos, opcode::stor);
+    binary_serialize(bos, size_t(0));
+
+    decoded_program baseline(program);
+    assert_eq(baseline.size(), size_t(3));
+    assert_eq(baseline.data()[2].op, opcode::ret);
+    assert_eq(baseline.data()[1].next_program_counter, program.size());
+    assert_eq(baseline.index_of(program.size()), size_t(2));
+
+    decoded_program fused(baseline, message_table());
+    assert_eq(fused.data()[fused.size() - 1].op, opcode::ret);
+    assert_eq(fused.index_of(program.size()), fused.size() - 1);
+}
+
+test_case(invalid_opcode)
+{
+    memory_file program;
+    memory_file::writer w(program);
+    binary_output_stream bos(w);
+
+    binary_serialize(bos, uint8_t(0));
+
+    assert_throws_logged(decoded_program(program));
+}
+
+test_case(fused_opcode_not_valid_in_program_text)
+{
+    memory_file program;
+    memory_file::writer w(program);
+    binary_output_stream bos(w);
+
+    binary_serialize(bos, opcode::load_load_op);
+
+    assert_throws_logged(decoded_program(program));
+}
+
+test_case(fuse_sequences)
+{
+    memory_file program;
+    memory_file::writer w(program);
+    binary_output_stream bos(w);
+
+    // x = x + 1
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(1));
+    size_t push_offset = w.position();
+    binary_serialize(bos, opcode::push);
+    binary_serialize(bos, value(1));
+    binary_serialize(bos, opcode::add);
+    binary_serialize(bos, opcode::stor);
+    binary_serialize(bos, size_t(1));
+
+    // if(x < 10) goto loop
+    size_t loop_offset = w.position();
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(1));
+    binary_serialize(bos, opcode::push);
+    binary_serialize(bos, value(10));
+    binary_serialize(bos, opcode::lt);
+    binary_serialize(bos, opcode::bt);
+    binary_serialize(bos, loop_offset);
+
+    // z = x * y
+    size_t load_load_offset = w.position();
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(1));
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(2));
+    binary_serialize(bos, opcode::mul);
+    size_t stor_offset = w.position();
+    binary_serialize(bos, opcode::stor);
+    binary_serialize(bos, size_t(3));
+
+    binary_serialize(bos, opcode::ret);
+
+    decoded_program baseline(program);
+    decoded_program p(baseline, message_table());
+    assert_eq(p.size(), size_t(6));
+
+    auto const *code = p.data();
+    assert_eq(code[0].op, opcode::load_push_op_stor);
+    assert_eq(code[0].operation, opcode::add);
+    assert_eq(code[0].address, size_t(1));
+    assert_eq(static_cast<int>(code[0].immediate), 1);
+    assert_eq(code[0].second_address, size_t(1));
+    assert_eq(code[0].next_program_counter, loop_offset);
+    assert_eq(code[0].source_instructions, size_t(4));
+
+    assert_eq(code[1].op, opcode::load_push_op_bt);
+    assert_eq(code[1].operation, opcode::lt);
+    assert_eq(code[1].target, size_t(1));
+    assert_eq(code[1].next_program_counter, load_load_offset);
+    assert_eq(code[1].source_instructions, size_t(4));
+
+    assert_eq(code[2].op, opcode::load_load_op);
+    assert_eq(code[2].operation, opcode::mul);
+    assert_eq(code[2].address, size_t(1));
+    assert_eq(code[2].second_address, size_t(2));
+    assert_eq(code[2].source_instructions, size_t(3));
+
+    assert_eq(code[3].op, opcode::stor);
+    assert_eq(code[3].source_instructions, size_t(1));
+    assert_eq(code[4].op, opcode::ret);
+    assert_eq(code[5].op, opcode::ret);
+
+    assert_eq(p.index_of(loop_offset), size_t(1));
+    assert_eq(p.index_of(stor_offset), size_t(3));
+    assert_throws_logged(p.index_of(push_offset));
+}
+
+test_case(fusion_stops_at_entry_points)
+{
+    memory_file program;
+    memory_file::writer w(program);
+    binary_output_stream bos(w);
+
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(1));
+    size_t branch_target_offset = w.position();
+    binary_serialize(bos, opcode::push);
+    binary_serialize(bos, value(1));
+    binary_serialize(bos, opcode::add);
+
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(1));
+    binary_serialize(bos, opcode::load);
+    binary_serialize(bos, size_t(2));
+    size_t export_offset = w.position();
+    binary_serialize(bos, opcode::add);
+
+    binary_serialize(bos, opcode::jmp);
+    binary_serialize(bos, branch_target_offset);
+
+    message_table exports;
+    exports.set_offset(message_type::startup, export_offset);
+
+    decoded_program baseline(program);
+    decoded_program p(baseline, exports);
+    assert_eq(p.size(), baseline.size());
+    assert_eq(p.index_of(branch_target_offset), size_t(1));
+    assert_eq(p.index_of(export_offset), size_t(5));
+    assert_eq(p.data()[6].target, size_t(1));
+}
+
+end_suite(decoded_program_test);
@@ -0,0 +1,69 @@
+#include "test/test.hpp"
+#include "jk/cog/vm/profiler.hpp"
+#include <sstream>
+
+using namespace gorc;
+using namespace gorc::cog;
+
+begin_suite(profiler_test);
+
+test_case(handler_profiles_are_distinct)
+{
+    profiler prof;
+
+    prof.get_handler_profile("foo.cog", message_type::startup).invocations = 1;
+    prof.get_handler_profile("foo.cog", message_type::pulse).invocations = 2;
+    prof.get_handler_profile("bar.cog", message_type::startup).invocations = 3;
+
+    assert_eq(prof.get_handler_profile("foo.cog", message_type::startup).invocations, size_t(1));
+    assert_eq(prof.get_handler_profile("foo.cog", message_type::pulse).invocations, size_t(2));
+    assert_eq(prof.get_handler_profile("bar.cog", message_type::startup).invocations, size_t(3));
+
+    prof.clear();
+
+    assert_eq(prof.get_handler_profile("foo.cog", message_type::startup).invocations, size_t(0));
+}
+
+test_case(total_verb_calls)
+{
+    handler_profile profile;
+    assert_eq(profile.total_verb_calls(), size_t(0));
+
+    profile.verb_calls[0] = 3;
+    profile.verb_calls[5] = 4;
+    assert_eq(profile.total_verb_calls(), size_t(7));
+}
+
+test_case(report_sorted_by_wall_time)
+{
+    verb_table verbs;
+    verbs.add_verb("first", []() { });
+    verbs.add_verb("second", []() { });
+
+    profiler prof;
+
+    auto &fast = prof.get_handler_profile("fast.cog", message_type::startup);
+    fast.invocations = 1;
+    fast.instructions = 10;
+    fast.wall_time = std::chrono::milliseconds(1);
+
+    auto &slow = prof.get_handler_profile("slow.cog", message_type::pulse);
+    slow.invocations = 20;
+    slow.instructions = 5000;
+    slow.verb_calls[static_cast<int>(verbs.get_verb_id("first"))] = 2;
+    slow.verb_calls[static_cast<int>(verbs.get_verb_id("second"))] = 7;
+    slow.wall_time = std::chrono::milliseconds(25);
+
+    std::stringstream ss;
+    prof.write_report(ss, verbs);
+
+    std::string expected =
+        "script                   handler           calls   instructions      verbs    time (ms)\n"
+        "slow.cog                 pulse                20           5000          9       25.000\n"
+        "    second                                     7\n"
+        "    first                                      2\n"
+        "fast.cog                 startup               1             10          0        1.000\n";
+    assert_eq(ss.str(), expected);
+}
+
+end_suite(profiler_test);
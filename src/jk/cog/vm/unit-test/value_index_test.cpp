@@ -0,0 +1,76 @@
+#include "test/test.hpp"
+#include "jk/cog/vm/value_index.hpp"
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::cog;
+
+namespace {
+    std::vector<int> entries_of(value_index<int> const &idx, value key)
+    {
+        std::vector<int> rv;
+        idx.for_each(key, [&](int em) { rv.push_back(em); });
+        return rv;
+    }
+}
+
+begin_suite(value_index_test);
+
+test_case(lookup_by_type_and_payload)
+{
+    value_index<int> idx;
+    idx.emplace(thing_id(5), 1);
+    idx.emplace(sector_id(5), 2);
+    idx.emplace(thing_id(5), 3);
+    idx.emplace(thing_id(6), 4);
+
+    assert_eq(idx.size(), size_t(4));
+    assert_eq(entries_of(idx, thing_id(5)), (std::vector<int> { 1, 3 }));
+    assert_eq(entries_of(idx, sector_id(5)), (std::vector<int> { 2 }));
+    assert_eq(entries_of(idx, thing_id(6)), (std::vector<int> { 4 }));
+    assert_eq(entries_of(idx, surface_id(5)), std::vector<int>());
+}
+
+test_case(insert_during_traversal)
+{
+    value_index<int> idx;
+    idx.emplace(thing_id(1), 1);
+
+    std::vector<int> visited;
+    idx.for_each(thing_id(1), [&](int em) {
+            visited.push_back(em);
+            if(em < 40) {
+                idx.emplace(thing_id(1), em * 2);
+                idx.emplace(thing_id(2), em);
+            }
+        });
+
+    assert_eq(visited, (std::vector<int> { 1, 2, 4, 8, 16, 32, 64 }));
+}
+
+test_case(compact)
+{
+    value_index<int> idx;
+    idx.emplace(thing_id(1), 1);
+    idx.emplace(thing_id(2), 2);
+    idx.emplace(thing_id(1), 3);
+    idx.emplace(thing_id(3), 4);
+    idx.emplace(thing_id(2), 5);
+
+    idx.compact();
+
+    std::vector<int> layout;
+    for(auto const &em : idx) {
+        layout.push_back(em.second);
+    }
+
+    assert_eq(layout, (std::vector<int> { 1, 3, 2, 5, 4 }));
+    assert_eq(entries_of(idx, thing_id(1)), (std::vector<int> { 1, 3 }));
+    assert_eq(entries_of(idx, thing_id(2)), (std::vector<int> { 2, 5 }));
+    assert_eq(entries_of(idx, thing_id(3)), (std::vector<int> { 4 }));
+
+    idx.emplace(thing_id(1), 6);
+    assert_eq(entries_of(idx, thing_id(1)), (std::vector<int> { 1, 3, 6 }));
+}
+
+end_suite(value_index_test);
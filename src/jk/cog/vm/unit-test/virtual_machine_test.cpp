@@ -1,6 +1,9 @@
 #include "test/test.hpp"
 #include "jk/cog/vm/virtual_machine.hpp"
 #include "jk/cog/vm/executor.hpp"
+#include "io/binary_output_stream.hpp"
+#include <new>
+#include <type_traits>
 
 using namespace gorc;
 using namespace gorc::cog;
@@ -21,4 +24,35 @@ test_case(empty_continuation)
     vm.execute(verbs, exec, services, empty_continuation);
 }
 
+test_case(reused_script_address)
+{
+    virtual_machine vm;
+
+    // Construct two scripts in turn at the same address
+    std::aligned_storage<sizeof(script), alignof(script)>::type storage;
+
+    script *first = new(&storage) script();
+    {
+        memory_file::writer w(first->program);
+        binary_output_stream bos(w);
+        binary_serialize(bos, opcode::ret);
+    }
+
+    assert_eq(vm.load_program(*first).size(), size_t(2));
+    first->~script();
+
+    script *second = new(&storage) script();
+    {
+        memory_file::writer w(second->program);
+        binary_output_stream bos(w);
+        binary_serialize(bos, opcode::push);
+        binary_serialize(bos, value(1));
+        binary_serialize(bos, opcode::ret);
+    }
+
+    assert_eq(static_cast<void*>(second), static_cast<void*>(first));
+    assert_eq(vm.load_program(*second).size(), size_t(3));
+    second->~script();
+}
+
 end_suite(virtual_machine_test);
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "jk/cog/script/value.hpp"
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        // Hashed multimap from values to entries. Entries are stored in a flat vector and chained
+        // per key in insertion order. Entries may be added while a key is being visited; entries
+        // added under the visited key are visited by the same traversal.
+        template <typename EntryT>
+        class value_index {
+        public:
+            using element = std::pair<value, EntryT>;
+
+        private:
+            static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+            class chain {
+            public:
+                size_t first;
+                size_t last;
+            };
+
+            std::vector<element> elements;
+            std::vector<size_t> next_element;
+            std::unordered_map<value, chain, value_hash, value_identical> chains;
+
+            void link(size_t index)
+            {
+                next_element.push_back(npos);
+
+                auto it = chains.find(elements[index].first);
+                if(it == chains.end()) {
+                    chains.emplace(elements[index].first, chain { index, index });
+                }
+                else {
+                    next_element[it->second.last] = index;
+                    it->second.last = index;
+                }
+            }
+
+        public:
+            void emplace(value key, EntryT const &entry)
+            {
+                elements.emplace_back(key, entry);
+                link(elements.size() - 1);
+            }
+
+            // Calls fn with a copy of each entry stored under key, in insertion order.
+            template <typename FnT>
+            void for_each(value key, FnT fn) const
+            {
+                auto it = chains.find(key);
+                if(it == chains.end()) {
+                    return;
+                }
+
+                for(size_t i = it->second.first; i != npos; i = next_element[i]) {
+                    EntryT entry = elements[i].second;
+                    fn(entry);
+                }
+            }
+
+            // Rebuilds the flat layout so that each key's entries are contiguous. Keys keep the
+            // order of their first insertion, and entries keep their order within each key.
+            void compact()
+            {
+                std::vector<element> old_elements;
+                std::swap(old_elements, elements);
+
+                std::vector<size_t> old_next;
+                std::swap(old_next, next_element);
+
+                std::unordered_map<value, chain, value_hash, value_identical> old_chains;
+                std::swap(old_chains, chains);
+
+                elements.reserve(old_elements.size());
+                next_element.reserve(old_elements.size());
+
+                for(auto const &em : old_elements) {
+                    auto it = old_chains.find(em.first);
+                    if(it == old_chains.end()) {
+                        // Key already emitted
+                        continue;
+                    }
+
+                    for(size_t i = it->second.first; i != npos; i = old_next[i]) {
+                        elements.push_back(old_elements[i]);
+                        link(elements.size() - 1);
+                    }
+
+                    old_chains.erase(it);
+                }
+            }
+
+            inline size_t size() const
+            {
+                return elements.size();
+            }
+
+            inline typename std::vector<element>::const_iterator begin() const
+            {
+                return elements.begin();
+            }
+
+            inline typename std::vector<element>::const_iterator end() const
+            {
+                return elements.end();
+            }
+        };
+
+        template <typename EntryT>
+        constexpr size_t value_index<EntryT>::npos;
+
+    }
+}
@@ -5,12 +5,206 @@
 #include "suspend_exception.hpp"
 #include "executor.hpp"
 #include "instance.hpp"
-#include "io/binary_input_stream.hpp"
+#include "log/log.hpp"
+
+// Handlers are dispatched through a table of label addresses when the compiler supports it, so
+// that each handler ends in its own indirect branch. Otherwise, dispatch falls back to a switch.
+#if defined(__GNUC__)
+#define COG_VM_THREADED_DISPATCH
+#endif
+
+#ifdef COG_VM_THREADED_DISPATCH
+#define VM_DISPATCH_BEGIN() VM_NEXT();
+#define VM_DISPATCH_END()
+#define VM_HANDLER(x) handle_##x
+#define VM_NEXT() { VM_COUNT_INSTRUCTION(); goto *dispatch_table[static_cast<size_t>(ip->op)]; }
+#else
+#define VM_DISPATCH_BEGIN() while(true) { VM_COUNT_INSTRUCTION(); switch(ip->op) {
+#define VM_DISPATCH_END() } }
+#define VM_HANDLER(x) case opcode::x
+#define VM_NEXT() continue
+#endif
+
+#define VM_COUNT_INSTRUCTION() if(Profiling) { profile->instructions += ip->source_instructions; }
+
+namespace {
+    using namespace gorc;
+    using namespace gorc::cog;
+
+    // Computes the diagnostic location of the verb call in progress, if any.
+    class call_site_resolver : public diagnostic_context_resolver {
+    public:
+        script const *cog = nullptr;
+        decoded_instruction const *call = nullptr;
+
+        virtual diagnostic_context_location get_diagnostic_context_location() const override
+        {
+            diagnostic_context_location rv(cog->filename.c_str(), 0, 0);
+            if(call) {
+                maybe_if(cog->call_sites.get_range(call->program_counter),
+                         [&](diagnostic_context_location const *loc) {
+                        rv = *loc;
+                        rv.filename = cog->filename.c_str();
+                    });
+            }
+
+            return rv;
+        }
+    };
+
+    // Evaluates the operator of a fused instruction exactly as its own handler does.
+    inline value apply_fused_operator(opcode op, value const &x, value const &y)
+    {
+        switch(op) {
+        case opcode::add:
+            return x + y;
+        case opcode::sub:
+            return x - y;
+        case opcode::mul:
+            return x * y;
+        case opcode::div:
+            return x / y;
+        case opcode::mod:
+            return x % y;
+        case opcode::bor:
+            return x | y;
+        case opcode::band:
+            return x & y;
+        case opcode::bxor:
+            return x ^ y;
+        case opcode::lor:
+            return x || y;
+        case opcode::land:
+            return x && y;
+        case opcode::eq:
+            return x == y;
+        case opcode::ne:
+            return x != y;
+        case opcode::gt:
+            return x > y;
+        case opcode::ge:
+            return x >= y;
+        case opcode::lt:
+            return x < y;
+        case opcode::le:
+            return x <= y;
+        default:
+            // Unreachable: the decoder only fuses binary operators.
+            LOG_FATAL("invalid fused operator"); // LCOV_EXCL_LINE
+        }
+    }
+
+    class profile_timer {
+    private:
+        handler_profile &profile;
+        std::chrono::steady_clock::time_point start_time;
+
+    public:
+        explicit profile_timer(handler_profile &profile)
+            : profile(profile)
+            , start_time(std::chrono::steady_clock::now())
+        {
+            return;
+        }
+
+        ~profile_timer()
+        {
+            profile.wall_time += std::chrono::steady_clock::now() - start_time;
+        }
+    };
+
+    // Verbs may send messages synchronously, which replaces the continuation service with the
+    // nested continuation. Restores the caller's continuation when the nested execution ends.
+    class continuation_service_guard {
+    private:
+        service_registry &services;
+        continuation *&active_continuation;
+        continuation *caller_continuation;
+
+    public:
+        continuation_service_guard(service_registry &services,
+                                   continuation *&active_continuation,
+                                   continuation &cc)
+            : services(services)
+            , active_continuation(active_continuation)
+            , caller_continuation(active_continuation)
+        {
+            active_continuation = &cc;
+        }
+
+        ~continuation_service_guard()
+        {
+            active_continuation = caller_continuation;
+            if(caller_continuation) {
+                services.add_or_replace(*caller_continuation);
+            }
+        }
+    };
+}
+
+gorc::cog::virtual_machine::loaded_program& gorc::cog::virtual_machine::get_loaded_program(script const &cog)
+{
+    auto it = programs.find(cog.serial);
+    if(it == programs.end()) {
+        it = programs.emplace(cog.serial, loaded_program()).first;
+        it->second.baseline = std::make_unique<decoded_program>(cog.program);
+    }
+
+    return it->second;
+}
+
+gorc::cog::decoded_program const& gorc::cog::virtual_machine::load_program(script const &cog)
+{
+    return *get_loaded_program(cog).baseline;
+}
+
+gorc::cog::decoded_program const& gorc::cog::virtual_machine::select_program(script const &cog)
+{
+    auto &lp = get_loaded_program(cog);
+    if(fused_tier_enabled && lp.fused) {
+        return *lp.fused;
+    }
+
+    return *lp.baseline;
+}
+
+gorc::cog::decoded_program const& gorc::cog::virtual_machine::enter_program(script const &cog)
+{
+    auto &lp = get_loaded_program(cog);
+    if(fused_tier_enabled && !lp.fused && ++lp.entry_count >= fused_tier_threshold) {
+        lp.fused = std::make_unique<decoded_program>(*lp.baseline, cog.exports);
+    }
+
+    return select_program(cog);
+}
+
+void gorc::cog::virtual_machine::set_fused_tier_enabled(bool enabled)
+{
+    fused_tier_enabled = enabled;
+}
+
+void gorc::cog::virtual_machine::set_fused_tier_threshold(int threshold)
+{
+    fused_tier_threshold = threshold;
+}
+
+void gorc::cog::virtual_machine::set_profiler(maybe<profiler *> prof)
+{
+    active_profiler = prof;
+}
+
+#ifdef COG_VM_THREADED_DISPATCH
+// Label addresses and computed gotos are compiler extensions.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
 
+template <bool Profiling>
 gorc::cog::value gorc::cog::virtual_machine::internal_execute(verb_table &verbs,
                                                               executor &exec,
                                                               service_registry &services,
-                                                              continuation &cc)
+                                                              continuation &cc,
+                                                              handler_profile *profile)
 {
     if(cc.call_stack.empty()) {
         // Cannot execute in empty continuation
@@ -22,348 +216,436 @@ gorc::cog::value gorc::cog::virtual_machine::internal_execute(verb_table &verbs,
     services.add_or_replace(cc);
 
     instance *current_instance = &exec.get_instance(cc.frame().instance_id);
-    memory_file::reader sr(current_instance->cog->program);
-    sr.set_position(cc.frame().program_counter);
+    decoded_program const *program = &enter_program(*current_instance->cog);
+    decoded_instruction const *code = program->data();
+    decoded_instruction const *ip = code + program->index_of(cc.frame().program_counter);
+
+    // Source locations are only looked up if a verb logs a message.
+    call_site_resolver call_site;
+    call_site.cog = &*current_instance->cog;
+    lazy_diagnostic_context dc(call_site);
+
+#ifdef COG_VM_THREADED_DISPATCH
+    static void* const dispatch_table[] = {
+        &&handle_invalid,
+        &&handle_push,
+        &&handle_dup,
+        &&handle_load,
+        &&handle_loadi,
+        &&handle_stor,
+        &&handle_stori,
+        &&handle_jmp,
+        &&handle_jal,
+        &&handle_bt,
+        &&handle_bf,
+        &&handle_call,
+        &&handle_callv,
+        &&handle_ret,
+        &&handle_neg,
+        &&handle_lnot,
+        &&handle_add,
+        &&handle_sub,
+        &&handle_mul,
+        &&handle_div,
+        &&handle_mod,
+        &&handle_bor,
+        &&handle_band,
+        &&handle_bxor,
+        &&handle_lor,
+        &&handle_land,
+        &&handle_eq,
+        &&handle_ne,
+        &&handle_gt,
+        &&handle_ge,
+        &&handle_lt,
+        &&handle_le,
+        &&handle_load_load_op,
+        &&handle_load_push_op,
+        &&handle_load_push_op_stor,
+        &&handle_load_push_op_bt,
+        &&handle_load_push_op_bf,
+    };
+
+    static_assert(sizeof(dispatch_table) / sizeof(*dispatch_table) ==
+                  static_cast<size_t>(opcode::load_push_op_bf) + 1,
+                  "dispatch table does not match opcode table");
+#endif
+
+    VM_DISPATCH_BEGIN()
+
+#ifdef COG_VM_THREADED_DISPATCH
+    handle_invalid:
+        // Unreachable: opcodes are validated when the program is decoded.
+        LOG_FATAL("invalid opcode");
+#endif
+
+    VM_HANDLER(push): {
+            cc.data_stack.push_back(ip->immediate);
+            ++ip;
+        }
+        VM_NEXT();
 
-    binary_input_stream bsr(sr);
+    VM_HANDLER(dup): {
+            cog::value v(cc.data_stack.back());
+            cc.data_stack.push_back(v);
+            ++ip;
+        }
+        VM_NEXT();
 
-    while(true) {
-        opcode op = binary_deserialize<opcode>(bsr);
-        switch(op) {
-        case opcode::push: {
-                cog::value v(deserialization_constructor, bsr);
-                cc.data_stack.push_back(v);
-            }
-            break;
+    VM_HANDLER(load): {
+            cc.data_stack.push_back(current_instance->memory[ip->address]);
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::dup: {
-                cog::value v(cc.data_stack.back());
-                cc.data_stack.push_back(v);
-            }
-            break;
+    VM_HANDLER(loadi): {
+            int addr = static_cast<int>(ip->address);
+            int idx = static_cast<int>(cc.data_stack.back());
+            cc.data_stack.pop_back();
 
-        case opcode::load: {
-                size_t addr = binary_deserialize<size_t>(bsr);
-                cc.data_stack.push_back(current_instance->memory[addr]);
-            }
-            break;
+            cc.data_stack.push_back(current_instance->memory[static_cast<size_t>(addr + idx)]);
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::loadi: {
-                int addr = static_cast<int>(binary_deserialize<size_t>(bsr));
-                int idx = static_cast<int>(cc.data_stack.back());
-                cc.data_stack.pop_back();
+    VM_HANDLER(stor): {
+            current_instance->memory[ip->address] = cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-                cc.data_stack.push_back(current_instance->memory[static_cast<size_t>(addr + idx)]);
-            }
-            break;
+    VM_HANDLER(stori): {
+            int addr = static_cast<int>(ip->address);
+            int idx = static_cast<int>(cc.data_stack.back());
+            cc.data_stack.pop_back();
 
-        case opcode::stor: {
-                size_t addr = binary_deserialize<size_t>(bsr);
-                current_instance->memory[addr] = cc.data_stack.back();
-                cc.data_stack.pop_back();
-            }
-            break;
+            current_instance->memory[static_cast<size_t>(addr + idx)] = cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::stori: {
-                int addr = static_cast<int>(binary_deserialize<size_t>(bsr));
-                int idx = static_cast<int>(cc.data_stack.back());
-                cc.data_stack.pop_back();
+    VM_HANDLER(jmp): {
+            ip = code + ip->target;
+        }
+        VM_NEXT();
+
+    VM_HANDLER(jal): {
+            // Store current offset in current continuation
+            cc.call_stack.back().program_counter = ip->next_program_counter;
+
+            // Create new stack frame
+            cc.call_stack.push_back(call_stack_frame(cc.frame().instance_id,
+                                                     ip->address,
+                                                     cc.frame().sender,
+                                                     cc.frame().sender_id,
+                                                     cc.frame().source,
+                                                     cc.frame().param0,
+                                                     cc.frame().param1,
+                                                     cc.frame().param2,
+                                                     cc.frame().param3));
+
+            // Jump
+            ip = code + ip->target;
+        }
+        VM_NEXT();
+
+    VM_HANDLER(bt): {
+            cog::value v(cc.data_stack.back());
+            cc.data_stack.pop_back();
 
-                current_instance->memory[static_cast<size_t>(addr + idx)] = cc.data_stack.back();
-                cc.data_stack.pop_back();
+            if(static_cast<bool>(v)) {
+                ip = code + ip->target;
             }
-            break;
+            else {
+                ++ip;
+            }
+        }
+        VM_NEXT();
+
+    VM_HANDLER(bf): {
+            cog::value v(cc.data_stack.back());
+            cc.data_stack.pop_back();
 
-        case opcode::jmp: {
-                size_t addr = binary_deserialize<size_t>(bsr);
-                sr.set_position(addr);
+            if(!static_cast<bool>(v)) {
+                ip = code + ip->target;
             }
-            break;
+            else {
+                ++ip;
+            }
+        }
+        VM_NEXT();
 
-        case opcode::jal: {
-                size_t addr = binary_deserialize<size_t>(bsr);
-
-                // Store current offset in current continuation
-                cc.call_stack.back().program_counter = sr.position();
-
-                // Create new stack frame
-                cc.call_stack.push_back(call_stack_frame(cc.frame().instance_id,
-                                                         addr,
-                                                         cc.frame().sender,
-                                                         cc.frame().sender_id,
-                                                         cc.frame().source,
-                                                         cc.frame().param0,
-                                                         cc.frame().param1,
-                                                         cc.frame().param2,
-                                                         cc.frame().param3));
-
-                // Jump
-                sr.set_position(addr);
+    VM_HANDLER(call): {
+            // Store current offset in current continuation
+            cc.call_stack.back().program_counter = ip->next_program_counter;
+
+            if(Profiling) {
+                ++profile->verb_calls[ip->verb];
             }
-            break;
 
-        case opcode::bt: {
-                size_t addr = binary_deserialize<size_t>(bsr);
-                cog::value v(cc.data_stack.back());
-                cc.data_stack.pop_back();
+            call_site.call = ip;
+            verbs.get_verb(verb_id(ip->verb)).invoke(cc.data_stack,
+                                                     services,
+                                                     /* expects value */ false);
+            call_site.call = nullptr;
+            ++ip;
+        }
+        VM_NEXT();
 
-                if(static_cast<bool>(v)) {
-                    sr.set_position(addr);
-                }
+    VM_HANDLER(callv): {
+            // Store current offset in current continuation
+            cc.call_stack.back().program_counter = ip->next_program_counter;
+
+            if(Profiling) {
+                ++profile->verb_calls[ip->verb];
             }
-            break;
 
-        case opcode::bf: {
-                size_t addr = binary_deserialize<size_t>(bsr);
-                cog::value v(cc.data_stack.back());
-                cc.data_stack.pop_back();
+            call_site.call = ip;
+            cog::value rv = verbs.get_verb(verb_id(ip->verb)).invoke(cc.data_stack,
+                                                                     services,
+                                                                     /* expects value */ true);
+            call_site.call = nullptr;
+            cc.data_stack.push_back(rv);
+            ++ip;
+        }
+        VM_NEXT();
+
+    VM_HANDLER(ret): {
+            // Retire top stack frame.
+            value return_register = cc.frame().return_register;
+            bool save_return_register = cc.frame().save_return_register;
+            bool push_return_register = cc.frame().push_return_register;
+
+            cc.call_stack.pop_back();
 
-                if(!static_cast<bool>(v)) {
-                    sr.set_position(addr);
-                }
+            if(cc.call_stack.empty()) {
+                return return_register;
             }
-            break;
 
-        case opcode::call: {
-                int vid = binary_deserialize<int>(bsr);
-
-                int first_line = binary_deserialize<int>(bsr);
-                int first_col = binary_deserialize<int>(bsr);
-                int last_line = binary_deserialize<int>(bsr);
-                int last_col = binary_deserialize<int>(bsr);
-                diagnostic_context dc(current_instance->cog->filename.c_str(),
-                                      first_line,
-                                      first_col,
-                                      last_line,
-                                      last_col);
-
-                // Store current offset in current continuation
-                cc.call_stack.back().program_counter = sr.position();
-
-                verbs.get_verb(verb_id(vid)).invoke(cc.data_stack,
-                                                    services,
-                                                    /* expects value */ false);
+            current_instance = &exec.get_instance(cc.call_stack.back().instance_id);
+            call_site.cog = &*current_instance->cog;
+            program = &select_program(*current_instance->cog);
+            code = program->data();
+            ip = code + program->index_of(cc.call_stack.back().program_counter);
+
+            if(save_return_register) {
+                cc.frame().return_register = return_register;
             }
-            break;
 
-        case opcode::callv: {
-                int vid = binary_deserialize<int>(bsr);
-
-                int first_line = binary_deserialize<int>(bsr);
-                int first_col = binary_deserialize<int>(bsr);
-                int last_line = binary_deserialize<int>(bsr);
-                int last_col = binary_deserialize<int>(bsr);
-                diagnostic_context dc(current_instance->cog->filename.c_str(),
-                                      first_line,
-                                      first_col,
-                                      last_line,
-                                      last_col);
-
-                // Store current offset in current continuation
-                cc.call_stack.back().program_counter = sr.position();
-
-                cog::value rv = verbs.get_verb(verb_id(vid)).invoke(cc.data_stack,
-                                                                    services,
-                                                                    /* expects value */ true);
-                cc.data_stack.push_back(rv);
+            if(push_return_register) {
+                cc.data_stack.push_back(return_register);
             }
-            break;
+        }
+        VM_NEXT();
 
-        case opcode::ret: {
-                // Retire top stack frame.
-                value return_register = cc.frame().return_register;
-                bool save_return_register = cc.frame().save_return_register;
-                bool push_return_register = cc.frame().push_return_register;
+    VM_HANDLER(neg): {
+            cog::value &v = cc.data_stack.back();
+            v = -v;
+            ++ip;
+        }
+        VM_NEXT();
 
-                cc.call_stack.pop_back();
+    VM_HANDLER(lnot): {
+            cog::value &v = cc.data_stack.back();
+            v = !v;
+            ++ip;
+        }
+        VM_NEXT();
 
-                if(cc.call_stack.empty()) {
-                    return return_register;
-                }
+    VM_HANDLER(add): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x + cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-                current_instance = &exec.get_instance(cc.call_stack.back().instance_id);
-                sr = memory_file::reader(current_instance->cog->program);
-                sr.set_position(cc.call_stack.back().program_counter);
+    VM_HANDLER(sub): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x - cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-                if(save_return_register) {
-                    cc.frame().return_register = return_register;
-                }
+    VM_HANDLER(mul): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x * cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-                if(push_return_register) {
-                    cc.data_stack.push_back(return_register);
-                }
-            }
-            break;
+    VM_HANDLER(div): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x / cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::neg: {
-                cog::value v = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(-v);
-            }
-            break;
+    VM_HANDLER(mod): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x % cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::lnot: {
-                cog::value v = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(!v);
-            }
-            break;
+    VM_HANDLER(bor): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x | cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::add: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x + y);
-            }
-            break;
+    VM_HANDLER(band): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x & cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::sub: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x - y);
-            }
-            break;
+    VM_HANDLER(bxor): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x ^ cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::mul: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x * y);
-            }
-            break;
+    VM_HANDLER(lor): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x || cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::div: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x / y);
-            }
-            break;
+    VM_HANDLER(land): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x && cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::mod: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x % y);
-            }
-            break;
+    VM_HANDLER(eq): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x == cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::bor: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x | y);
-            }
-            break;
+    VM_HANDLER(ne): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x != cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::band: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x & y);
-            }
-            break;
+    VM_HANDLER(gt): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x > cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::bxor: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x ^ y);
-            }
-            break;
+    VM_HANDLER(ge): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x >= cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::lor: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x || y);
-            }
-            break;
+    VM_HANDLER(lt): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x < cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::land: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x && y);
-            }
-            break;
+    VM_HANDLER(le): {
+            cog::value &x = cc.data_stack[cc.data_stack.size() - 2];
+            x = x <= cc.data_stack.back();
+            cc.data_stack.pop_back();
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::eq: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x == y);
-            }
-            break;
+    // Heap accesses may grow the heap, so fused handlers read each operand by value.
 
-        case opcode::ne: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x != y);
-            }
-            break;
+    VM_HANDLER(load_load_op): {
+            cog::value x = current_instance->memory[ip->address];
+            cog::value y = current_instance->memory[ip->second_address];
+            cc.data_stack.push_back(apply_fused_operator(ip->operation, x, y));
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::gt: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x > y);
-            }
-            break;
+    VM_HANDLER(load_push_op): {
+            cog::value x = current_instance->memory[ip->address];
+            cc.data_stack.push_back(apply_fused_operator(ip->operation, x, ip->immediate));
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::ge: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x >= y);
-            }
-            break;
+    VM_HANDLER(load_push_op_stor): {
+            cog::value x = current_instance->memory[ip->address];
+            cog::value rv = apply_fused_operator(ip->operation, x, ip->immediate);
+            current_instance->memory[ip->second_address] = rv;
+            ++ip;
+        }
+        VM_NEXT();
 
-        case opcode::lt: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x < y);
+    VM_HANDLER(load_push_op_bt): {
+            cog::value x = current_instance->memory[ip->address];
+            if(static_cast<bool>(apply_fused_operator(ip->operation, x, ip->immediate))) {
+                ip = code + ip->target;
             }
-            break;
+            else {
+                ++ip;
+            }
+        }
+        VM_NEXT();
 
-        case opcode::le: {
-                cog::value y = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cog::value x = cc.data_stack.back();
-                cc.data_stack.pop_back();
-                cc.data_stack.push_back(x <= y);
+    VM_HANDLER(load_push_op_bf): {
+            cog::value x = current_instance->memory[ip->address];
+            if(!static_cast<bool>(apply_fused_operator(ip->operation, x, ip->immediate))) {
+                ip = code + ip->target;
+            }
+            else {
+                ++ip;
             }
-            break;
         }
-    }
+        VM_NEXT();
+
+    VM_DISPATCH_END()
 }
 
-gorc::cog::value gorc::cog::virtual_machine::execute(verb_table &verbs,
-                                                     executor &exec,
-                                                     service_registry &services,
-                                                     continuation &cc)
+#ifdef COG_VM_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+template <bool Profiling>
+gorc::cog::value gorc::cog::virtual_machine::execute_continuation(verb_table &verbs,
+                                                                  executor &exec,
+                                                                  service_registry &services,
+                                                                  continuation &cc,
+                                                                  handler_profile *profile)
 {
     while(true) {
         try {
-            return internal_execute(verbs, exec, services, cc);
+            return internal_execute<Profiling>(verbs, exec, services, cc, profile);
         }
         catch(restart_exception const &) {
             // Some engine component has changed the current continuation and
@@ -383,3 +665,23 @@ gorc::cog::value gorc::cog::virtual_machine::execute(verb_table &verbs,
     // return register.
     return cc.frame().return_register;
 }
+
+gorc::cog::value gorc::cog::virtual_machine::execute(verb_table &verbs,
+                                                     executor &exec,
+                                                     service_registry &services,
+                                                     continuation &cc)
+{
+    continuation_service_guard guard(services, active_continuation, cc);
+
+    if(!active_profiler.has_value() || cc.call_stack.empty()) {
+        return execute_continuation<false>(verbs, exec, services, cc, nullptr);
+    }
+
+    auto &handler_cog = *exec.get_instance(cc.call_stack.front().instance_id).cog;
+    auto &profile = active_profiler.get_value()->get_handler_profile(handler_cog.filename,
+                                                                     cc.handler);
+    ++profile.invocations;
+
+    profile_timer timer(profile);
+    return execute_continuation<true>(verbs, exec, services, cc, &profile);
+}
@@ -2,17 +2,75 @@
 
 #include "jk/cog/script/verb_table.hpp"
 #include "continuation.hpp"
+#include "decoded_program.hpp"
+#include "profiler.hpp"
+#include "utility/maybe.hpp"
+#include <memory>
+#include <unordered_map>
 
 namespace gorc {
     namespace cog {
 
         class executor;
 
+        constexpr int default_fused_tier_threshold = 16;
+
+        // Scripts are interpreted from their decoded program text. Scripts which are entered
+        // often are promoted to the fused tier, which interprets a copy of the program with
+        // common instruction sequences fused. Both tiers share program offsets, so a script may
+        // be promoted while continuations are suspended in it.
         class virtual_machine {
         private:
-            value internal_execute(verb_table &, executor &, service_registry &, continuation &cc);
+            class loaded_program {
+            public:
+                std::unique_ptr<decoded_program> baseline;
+                std::unique_ptr<decoded_program> fused;
+                int entry_count = 0;
+            };
+
+            // Keyed by script serial, so a script allocated at a destroyed script's address
+            // is never given the destroyed script's program.
+            std::unordered_map<uint64_t, loaded_program> programs;
+            continuation *active_continuation = nullptr;
+
+            bool fused_tier_enabled = true;
+            int fused_tier_threshold = default_fused_tier_threshold;
+
+            maybe<profiler *> active_profiler;
+
+            loaded_program& get_loaded_program(script const &);
+            decoded_program const& select_program(script const &);
+            decoded_program const& enter_program(script const &);
+
+            // Profiling builds a separate copy of the interpreter, so that counters cost nothing
+            // while profiling is disabled.
+            template <bool Profiling>
+            value internal_execute(verb_table &,
+                                   executor &,
+                                   service_registry &,
+                                   continuation &cc,
+                                   handler_profile *profile);
+
+            template <bool Profiling>
+            value execute_continuation(verb_table &,
+                                       executor &,
+                                       service_registry &,
+                                       continuation &cc,
+                                       handler_profile *profile);
 
         public:
+            // Decodes the script's program text, if it has not already been decoded.
+            decoded_program const& load_program(script const &);
+
+            void set_fused_tier_enabled(bool enabled);
+
+            // Number of entries after which a script is promoted to the fused tier.
+            void set_fused_tier_threshold(int threshold);
+
+            // Executions are counted against the script of the continuation's first frame and
+            // the message which started the continuation.
+            void set_profiler(maybe<profiler *> prof);
+
             value execute(verb_table &, executor &, service_registry &, continuation &cc);
         };
 
@@ -1,19 +1,76 @@
 #pragma once
 
 #include "content/id.hpp"
+#include "component_pool_listener.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <vector>
 
 namespace gorc {
 
     template <typename IdT>
     class abstract_component_pool {
+    private:
+        std::vector<component_pool_listener<IdT>*> listeners;
+
+        bool notifications_deferred = false;
+        std::vector<IdT> deferred_notifications;
+
+        void deliver_component_changed(IdT entity)
+        {
+            for(auto *listener : listeners) {
+                listener->component_changed(entity);
+            }
+        }
+
+    protected:
+        void notify_component_changed(IdT entity)
+        {
+            if(notifications_deferred) {
+                deferred_notifications.push_back(entity);
+                return;
+            }
+
+            deliver_component_changed(entity);
+        }
+
     public:
         virtual ~abstract_component_pool()
         {
             return;
         }
 
+        void insert_listener(component_pool_listener<IdT> &listener)
+        {
+            listeners.push_back(&listener);
+        }
+
+        void erase_listener(component_pool_listener<IdT> &listener)
+        {
+            listeners.erase(std::remove(listeners.begin(), listeners.end(), &listener),
+                            listeners.end());
+        }
+
+        // Listeners may be shared between pools. While aspects are updated concurrently,
+        // notifications are held by the pool and delivered later on the calling thread.
+        void defer_notifications()
+        {
+            notifications_deferred = true;
+        }
+
+        void flush_deferred_notifications()
+        {
+            notifications_deferred = false;
+            for(auto entity : deferred_notifications) {
+                deliver_component_changed(entity);
+            }
+
+            deferred_notifications.clear();
+        }
+
         virtual void erase_equal_range(IdT entity) = 0;
         virtual void flush_erase_queue() = 0;
+        virtual void compact() = 0;
     };
 
 }
@@ -1,6 +1,25 @@
 #include "aspect.hpp"
+#include <algorithm>
+
+namespace {
+    bool intersects(std::vector<uint32_t> const &a, std::vector<uint32_t> const &b)
+    {
+        return std::find_first_of(a.begin(), a.end(), b.begin(), b.end()) != a.end();
+    }
+}
 
 gorc::aspect::~aspect()
 {
     return;
 }
+
+bool gorc::aspect::conflicts_with(aspect const &other) const
+{
+    if(!declares_component_access || !other.declares_component_access) {
+        return true;
+    }
+
+    return intersects(write_components, other.write_components) ||
+           intersects(write_components, other.read_components) ||
+           intersects(read_components, other.write_components);
+}
@@ -1,13 +1,42 @@
 #pragma once
 
 #include "utility/time.hpp"
+#include "utility/uid.hpp"
+#include <cstdint>
+#include <vector>
 
 namespace gorc {
 
     class aspect {
+    private:
+        bool declares_component_access = false;
+        std::vector<uint32_t> read_components;
+        std::vector<uint32_t> write_components;
+
+    protected:
+        // Aspects which declare their component access may be updated concurrently with
+        // other non-conflicting aspects. Such an aspect must not touch any other shared
+        // state, and must declare every component type it emplaces or erases as written.
+        // Aspects which declare nothing are always updated alone.
+        template <typename CompT>
+        void reads_component()
+        {
+            declares_component_access = true;
+            read_components.push_back(uid_of<CompT>());
+        }
+
+        template <typename CompT>
+        void writes_component()
+        {
+            declares_component_access = true;
+            write_components.push_back(uid_of<CompT>());
+        }
+
     public:
         virtual ~aspect();
         virtual void update(time_delta) = 0;
+
+        bool conflicts_with(aspect const &other) const;
     };
 
 }
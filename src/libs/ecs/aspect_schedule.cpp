@@ -0,0 +1,49 @@
+#include "aspect_schedule.hpp"
+#include <algorithm>
+
+void gorc::aspect_schedule::rebuild(std::vector<std::unique_ptr<aspect>> const &aspects)
+{
+    stages.clear();
+
+    std::vector<size_t> aspect_stage;
+    aspect_stage.reserve(aspects.size());
+
+    for(size_t i = 0; i < aspects.size(); ++i) {
+        size_t stage = 0;
+        for(size_t j = 0; j < i; ++j) {
+            if(aspects[i]->conflicts_with(*aspects[j])) {
+                stage = std::max(stage, aspect_stage[j] + 1);
+            }
+        }
+
+        aspect_stage.push_back(stage);
+        if(stage >= stages.size()) {
+            stages.resize(stage + 1);
+        }
+
+        stages[stage].push_back(aspects[i].get());
+    }
+}
+
+void gorc::aspect_schedule::update(time_delta dt,
+                                   worker_pool &workers,
+                                   std::function<void()> const &stage_completed)
+{
+    for(auto const &stage : stages) {
+        stage_jobs.clear();
+        for(auto *asp : stage) {
+            stage_jobs.push_back([asp, dt] { asp->update(dt); });
+        }
+
+        workers.run(stage_jobs);
+
+        if(stage_completed) {
+            stage_completed();
+        }
+    }
+}
+
+size_t gorc::aspect_schedule::stage_count() const
+{
+    return stages.size();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "aspect.hpp"
+#include "utility/worker_pool.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace gorc {
+
+    // Groups aspects into stages of mutually non-conflicting aspects. Each aspect is placed
+    // in the stage after the last earlier aspect it conflicts with, so conflicting aspects
+    // are always updated in registration order.
+    class aspect_schedule {
+    private:
+        std::vector<std::vector<aspect*>> stages;
+        std::vector<std::function<void()>> stage_jobs;
+
+    public:
+        void rebuild(std::vector<std::unique_ptr<aspect>> const &aspects);
+
+        // Calls stage_completed on the calling thread after each stage has finished.
+        void update(time_delta dt,
+                    worker_pool &workers,
+                    std::function<void()> const &stage_completed = nullptr);
+
+        size_t stage_count() const;
+    };
+
+}
@@ -0,0 +1,142 @@
+#include "ecs/entity_component_system.hpp"
+#include "ecs/join_view.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Compares the cost of joining two component types by per-entity lookup against iterating
+// a cached join_view.
+
+using namespace gorc;
+
+namespace {
+
+    class head_component {
+    public:
+        uid(1);
+        int value;
+
+        head_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class paged_component {
+    public:
+        uid(2);
+        int value;
+
+        paged_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class dense_component {
+    public:
+        uid(3);
+        dense_storage();
+
+        int value;
+
+        dense_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    using bench_clock = std::chrono::steady_clock;
+
+    int const iterations = 20;
+
+    template <typename CompT>
+    long long lookup_join(entity_component_system<thing_id> &ecs)
+    {
+        long long sum = 0;
+        for(auto &head : ecs.all_components<head_component>()) {
+            for(auto &comp : ecs.find_component<CompT>(head.first)) {
+                sum += head.second->value + comp.second->value;
+            }
+        }
+
+        return sum;
+    }
+
+    template <typename CompT>
+    long long view_join(join_view<thing_id, head_component, CompT> &view)
+    {
+        long long sum = 0;
+        view.refresh();
+        for(auto const &r : view) {
+            sum += std::get<1>(r)->value + std::get<2>(r)->value;
+        }
+
+        return sum;
+    }
+
+    template <typename FnT>
+    double time_per_iteration(FnT fn, long long &sink)
+    {
+        auto start = bench_clock::now();
+        for(int i = 0; i < iterations; ++i) {
+            sink += fn();
+        }
+
+        std::chrono::duration<double, std::micro> elapsed = bench_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+    template <typename CompT>
+    void run_benchmark(char const *name, int entity_count)
+    {
+        event_bus bus;
+        component_registry<thing_id> cr;
+        cr.register_component_type<head_component>();
+        cr.register_component_type<paged_component>();
+        cr.register_component_type<dense_component>();
+
+        service_registry services;
+        services.add(cr);
+        services.add(bus);
+
+        entity_component_system<thing_id> ecs(services);
+        for(int i = 0; i < entity_count; ++i) {
+            auto entity = ecs.emplace_entity();
+            ecs.emplace_component<head_component>(entity, i);
+
+            // Every fourth entity is filtered out by the join
+            if(i % 4) {
+                ecs.emplace_component<CompT>(entity, i);
+            }
+        }
+
+        join_view<thing_id, head_component, CompT> view(ecs);
+        view.refresh();
+
+        long long sink = 0;
+        double lookup_us = time_per_iteration([&] { return lookup_join<CompT>(ecs); }, sink);
+        double view_us = time_per_iteration([&] { return view_join<CompT>(view); }, sink);
+
+        std::printf("%-8s %8d entities: lookup join %10.1f us, cached view %10.1f us (%lld)\n",
+                    name,
+                    entity_count,
+                    lookup_us,
+                    view_us,
+                    sink);
+    }
+
+}
+
+int main(int, char **)
+{
+    for(int entity_count : { 1000, 10000, 100000 }) {
+        run_benchmark<paged_component>("paged", entity_count);
+        run_benchmark<dense_component>("dense", entity_count);
+    }
+
+    return 0;
+}
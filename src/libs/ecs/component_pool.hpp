@@ -3,8 +3,12 @@
 #include "pool.hpp"
 #include "utility/range.hpp"
 #include "abstract_component_pool.hpp"
+#include <algorithm>
+#include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace gorc {
 
@@ -21,7 +25,8 @@ namespace gorc {
     private:
         PoolT components;
         IndexT index;
-        std::unordered_map<CompT*, const_iterator> erase_queue;
+        std::vector<const_iterator> erase_queue;
+        std::vector<std::pair<CompT const*, CompT*>> relocations;
 
     public:
         auto begin()
@@ -39,19 +44,20 @@ namespace gorc {
         {
             auto &em = components.emplace(std::forward<ArgT>(args)...);
             index.emplace(parent, &em);
+            this->notify_component_changed(parent);
             return em;
         }
 
         auto erase(const_iterator it)
         {
-            erase_queue.emplace(it->second, it);
+            erase_queue.push_back(it);
             return ++it;
         }
 
         auto erase(const_iterator begin, const_iterator end)
         {
             for(auto it = begin; it != end; ++it) {
-                erase_queue.emplace(it->second, it);
+                erase_queue.push_back(it);
             }
 
             return end;
@@ -102,15 +108,84 @@ namespace gorc {
 
         virtual void flush_erase_queue() override
         {
+            if(erase_queue.empty()) {
+                return;
+            }
+
+            // The same component may have been queued more than once.
+            auto by_component = [](const_iterator a, const_iterator b) {
+                return std::less<CompT*>()(a->second, b->second);
+            };
+
+            auto same_component = [](const_iterator a, const_iterator b) {
+                return a->second == b->second;
+            };
+
+            std::sort(erase_queue.begin(), erase_queue.end(), by_component);
+            erase_queue.erase(std::unique(erase_queue.begin(), erase_queue.end(), same_component),
+                              erase_queue.end());
+
             for(auto const &em : erase_queue) {
+                IdT entity = em->first;
                 LOG_DEBUG(format("erasing component %s for entity %d") %
                           typeid(CompT).name() %
-                          static_cast<int>(em.second->first));
-                components.erase(*em.second->second);
-                index.erase(em.second);
+                          static_cast<int>(entity));
+                components.erase(*em->second);
+                index.erase(em);
+                this->notify_component_changed(entity);
             }
 
             erase_queue.clear();
+            components.release_empty_pages();
+        }
+
+    private:
+        // Immovable components are never relocated.
+        void compact(std::false_type)
+        {
+            return;
+        }
+
+        void compact(std::true_type)
+        {
+            relocations.clear();
+            components.compact([this](CompT const *from, CompT &to) {
+                    relocations.emplace_back(from, &to);
+                });
+
+            if(relocations.empty()) {
+                return;
+            }
+
+            auto by_source = [](std::pair<CompT const*, CompT*> const &a, CompT const *b) {
+                return std::less<CompT const*>()(a.first, b);
+            };
+
+            std::sort(relocations.begin(),
+                      relocations.end(),
+                      [](std::pair<CompT const*, CompT*> const &a,
+                         std::pair<CompT const*, CompT*> const &b) {
+                          return std::less<CompT const*>()(a.first, b.first);
+                      });
+
+            for(auto &em : index) {
+                auto it = std::lower_bound(relocations.begin(),
+                                           relocations.end(),
+                                           em.second,
+                                           by_source);
+                if(it != relocations.end() && it->first == em.second) {
+                    em.second = it->second;
+                    this->notify_component_changed(em.first);
+                }
+            }
+        }
+
+    public:
+        // Packs live components into as few pages as possible. Component references held
+        // outside of the pool are invalidated; listeners are notified for every moved component.
+        virtual void compact() override
+        {
+            compact(std::is_move_constructible<CompT>());
         }
     };
 
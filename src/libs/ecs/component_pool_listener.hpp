@@ -0,0 +1,18 @@
+#pragma once
+
+namespace gorc {
+
+    // Receives notice whenever the set of components owned by an entity changes, or when a
+    // component is moved to a new address.
+    template <typename IdT>
+    class component_pool_listener {
+    public:
+        virtual ~component_pool_listener()
+        {
+            return;
+        }
+
+        virtual void component_changed(IdT entity) = 0;
+    };
+
+}
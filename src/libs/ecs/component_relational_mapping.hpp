@@ -1,6 +1,6 @@
 #pragma once
 
-#include "component_pool.hpp"
+#include "component_storage.hpp"
 #include "utility/maybe.hpp"
 #include "utility/uid.hpp"
 #include "log/log.hpp"
@@ -15,7 +15,7 @@ namespace gorc {
     class component_relational_mapping {
     private:
         template <typename CompT>
-        using CompPoolT = component_pool<IdT, CompT>;
+        using CompPoolT = component_storage_t<IdT, CompT>;
 
         std::unordered_map<uint32_t, std::unique_ptr<abstract_component_pool<IdT>>> pools;
 
@@ -81,6 +81,18 @@ namespace gorc {
             get_pool<CompT>().erase_if(pred);
         }
 
+        template <typename CompT>
+        void insert_listener(component_pool_listener<IdT> &listener)
+        {
+            get_pool<CompT>().insert_listener(listener);
+        }
+
+        template <typename CompT>
+        void erase_listener(component_pool_listener<IdT> &listener)
+        {
+            get_pool<CompT>().erase_listener(listener);
+        }
+
         void erase_equal_range(IdT entity)
         {
             for(auto &pool : pools) {
@@ -94,6 +106,27 @@ namespace gorc {
                 pool.second->flush_erase_queue();
             }
         }
+
+        void defer_notifications()
+        {
+            for(auto &pool : pools) {
+                pool.second->defer_notifications();
+            }
+        }
+
+        void flush_deferred_notifications()
+        {
+            for(auto &pool : pools) {
+                pool.second->flush_deferred_notifications();
+            }
+        }
+
+        void compact()
+        {
+            for(auto &pool : pools) {
+                pool.second->compact();
+            }
+        }
     };
 
 }
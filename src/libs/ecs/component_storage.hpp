@@ -0,0 +1,37 @@
+#pragma once
+
+#include "component_pool.hpp"
+#include "dense_component_pool.hpp"
+
+// Components declaring dense_storage() are registered in a dense_component_pool.
+#define dense_storage() using ComponentStorage = ::gorc::dense_storage_tag
+
+namespace gorc {
+
+    class dense_storage_tag { };
+
+    namespace detail {
+        template <typename T>
+        struct void_if_valid {
+            using type = void;
+        };
+    }
+
+    template <typename IdT, typename CompT, typename = void>
+    struct component_storage {
+        using type = component_pool<IdT, CompT>;
+    };
+
+    template <typename IdT, typename CompT>
+    struct component_storage<IdT,
+                             CompT,
+                             typename detail::void_if_valid<typename CompT::ComponentStorage>::type> {
+        static_assert(std::is_same<typename CompT::ComponentStorage, dense_storage_tag>::value,
+                      "unknown component storage type");
+        using type = dense_component_pool<IdT, CompT>;
+    };
+
+    template <typename IdT, typename CompT>
+    using component_storage_t = typename component_storage<IdT, CompT>::type;
+
+}
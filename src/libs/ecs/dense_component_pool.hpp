@@ -0,0 +1,312 @@
+#pragma once
+
+#include "utility/range.hpp"
+#include "abstract_component_pool.hpp"
+#include "log/log.hpp"
+#include <vector>
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+
+namespace gorc {
+
+    // Sparse-set component storage. Each entity owns at most one component. Components are
+    // stored contiguously in dense order, so full-pool iteration is a linear scan and lookup
+    // by entity is a single array access.
+    //
+    // Component addresses are stable across emplace, but erased components are replaced by
+    // the last component in the pool when the erase queue is flushed.
+    template <typename IdT, typename CompT, size_t page_size = 128>
+    class dense_component_pool : public abstract_component_pool<IdT> {
+    private:
+        using CompStorageT = typename std::aligned_storage<sizeof(CompT), alignof(CompT)>::type;
+        using CompStoragePageT = std::array<CompStorageT, page_size>;
+        using IndexT = std::vector<std::pair<IdT, CompT*>>;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        // Iterators refer to dense positions rather than addresses, so that components emplaced
+        // while iterating do not invalidate them.
+        template <typename IndexRefT, typename ValueT>
+        class basic_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename std::remove_const<ValueT>::type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = ValueT*;
+            using reference = ValueT&;
+
+        private:
+            IndexRefT *idx = nullptr;
+            size_t pos = 0;
+
+        public:
+            basic_iterator() = default;
+
+            basic_iterator(IndexRefT *idx, size_t pos)
+                : idx(idx)
+                , pos(pos)
+            {
+                return;
+            }
+
+            template <typename OtherIndexRefT, typename OtherValueT>
+            basic_iterator(basic_iterator<OtherIndexRefT, OtherValueT> const &it)
+                : idx(it.idx)
+                , pos(it.pos)
+            {
+                return;
+            }
+
+            ValueT& operator*() const
+            {
+                return (*idx)[pos];
+            }
+
+            ValueT* operator->() const
+            {
+                return &(*idx)[pos];
+            }
+
+            basic_iterator& operator++()
+            {
+                ++pos;
+                return *this;
+            }
+
+            basic_iterator operator++(int)
+            {
+                basic_iterator rv = *this;
+                ++pos;
+                return rv;
+            }
+
+            bool operator==(basic_iterator const &it) const
+            {
+                return pos == it.pos;
+            }
+
+            bool operator!=(basic_iterator const &it) const
+            {
+                return pos != it.pos;
+            }
+
+            template <typename, typename>
+            friend class basic_iterator;
+        };
+
+    public:
+        using iterator = basic_iterator<IndexT, typename IndexT::value_type>;
+        using const_iterator = basic_iterator<IndexT const, typename IndexT::value_type const>;
+
+    private:
+        std::vector<std::unique_ptr<CompStoragePageT>> pages;
+        IndexT index;
+        std::vector<size_t> sparse;
+        std::vector<IdT> erase_queue;
+
+        CompStorageT* get_storage(size_t dense_index)
+        {
+            size_t page = dense_index / page_size;
+            if(page >= pages.size()) {
+                pages.push_back(std::make_unique<CompStoragePageT>());
+            }
+
+            return &(*pages[page])[dense_index % page_size];
+        }
+
+        size_t sparse_index(IdT id) const
+        {
+            auto value = static_cast<int32_t>(id);
+            if(value < 0 || static_cast<size_t>(value) >= sparse.size()) {
+                return npos;
+            }
+
+            return sparse[static_cast<size_t>(value)];
+        }
+
+        void set_sparse_index(IdT id, size_t dense_index)
+        {
+            auto value = static_cast<size_t>(static_cast<int32_t>(id));
+            if(value >= sparse.size()) {
+                sparse.resize(value + 1, size_t(npos));
+            }
+
+            sparse[value] = dense_index;
+        }
+
+        void erase_now(IdT id)
+        {
+            size_t hole = sparse_index(id);
+            if(hole == npos) {
+                // Already erased by an earlier queue entry.
+                return;
+            }
+
+            LOG_DEBUG(format("erasing component %s for entity %d") %
+                      typeid(CompT).name() %
+                      static_cast<int>(id));
+
+            size_t last = index.size() - 1;
+            CompT *hole_comp = index[hole].second;
+            hole_comp->~CompT();
+
+            if(hole != last) {
+                CompT *last_comp = index[last].second;
+                new(hole_comp) CompT(std::move(*last_comp));
+                last_comp->~CompT();
+
+                index[hole].first = index[last].first;
+                set_sparse_index(index[hole].first, hole);
+                this->notify_component_changed(index[hole].first);
+            }
+
+            set_sparse_index(id, npos);
+            index.pop_back();
+            this->notify_component_changed(id);
+        }
+
+    public:
+        ~dense_component_pool()
+        {
+            for(auto &em : index) {
+                em.second->~CompT();
+            }
+        }
+
+        iterator begin()
+        {
+            return iterator(&index, 0);
+        }
+
+        iterator end()
+        {
+            return iterator(&index, index.size());
+        }
+
+        template <typename ...ArgT>
+        CompT& emplace(IdT parent, ArgT &&...args)
+        {
+            size_t existing_index = sparse_index(parent);
+            if(existing_index != npos) {
+                auto queued = std::remove(erase_queue.begin(), erase_queue.end(), parent);
+                if(queued == erase_queue.end()) {
+                    LOG_FATAL(format("entity %d already has a %s component") %
+                              static_cast<int>(parent) %
+                              typeid(CompT).name());
+                }
+
+                // The old component was erased but not yet flushed. Replace it in its dense slot,
+                // so no other component moves while the pool may be iterated. The replacement is
+                // built first, so the pool is unchanged if its constructor throws.
+                CompT replacement(std::forward<ArgT>(args)...);
+
+                CompT *em = index[existing_index].second;
+                *em = std::move(replacement);
+                erase_queue.erase(queued, erase_queue.end());
+
+                this->notify_component_changed(parent);
+                return *em;
+            }
+
+            size_t dense_index = index.size();
+            CompStorageT *storage = get_storage(dense_index);
+            CompT *em = new(storage) CompT(std::forward<ArgT>(args)...);
+
+            index.emplace_back(parent, em);
+            set_sparse_index(parent, dense_index);
+            this->notify_component_changed(parent);
+            return *em;
+        }
+
+        auto erase(const_iterator it)
+        {
+            erase_queue.push_back(it->first);
+            return ++it;
+        }
+
+        auto erase(const_iterator begin, const_iterator end)
+        {
+            for(auto it = begin; it != end; ++it) {
+                erase_queue.push_back(it->first);
+            }
+
+            return end;
+        }
+
+        auto erase(range<const_iterator> const &rng)
+        {
+            erase(rng.begin(), rng.end());
+            return rng.end();
+        }
+
+        auto erase(range<iterator> const &rng)
+        {
+            erase(rng.begin(), rng.end());
+            return rng.end();
+        }
+
+        range<iterator> equal_range(IdT id)
+        {
+            size_t dense_index = sparse_index(id);
+            if(dense_index == npos) {
+                return make_range(end(), end());
+            }
+
+            return make_range(iterator(&index, dense_index), iterator(&index, dense_index + 1));
+        }
+
+        range<const_iterator> equal_range(IdT id) const
+        {
+            size_t dense_index = sparse_index(id);
+            if(dense_index == npos) {
+                dense_index = index.size();
+                return make_range(const_iterator(&index, dense_index),
+                                  const_iterator(&index, dense_index));
+            }
+
+            return make_range(const_iterator(&index, dense_index),
+                              const_iterator(&index, dense_index + 1));
+        }
+
+        virtual void erase_equal_range(IdT id) override
+        {
+            if(sparse_index(id) != npos) {
+                erase_queue.push_back(id);
+            }
+        }
+
+        template <typename PredT>
+        void erase_if(PredT pred)
+        {
+            for(auto const &em : index) {
+                if(pred(em.first, *em.second)) {
+                    erase_queue.push_back(em.first);
+                }
+            }
+        }
+
+        virtual void flush_erase_queue() override
+        {
+            for(auto const &id : erase_queue) {
+                erase_now(id);
+            }
+
+            erase_queue.clear();
+        }
+
+        virtual void compact() override
+        {
+            // Components are always densely packed. Free the pages past the end of the index,
+            // keeping one spare.
+            size_t used_pages = (index.size() + page_size - 1) / page_size;
+            if(pages.size() > used_pages + 1) {
+                pages.resize(used_pages + 1);
+            }
+        }
+    };
+
+}
@@ -4,6 +4,7 @@
 #include "component_relational_mapping.hpp"
 #include "component_registry.hpp"
 #include "aspect.hpp"
+#include "aspect_schedule.hpp"
 #include "entity_destroyed.hpp"
 #include "utility/event_bus.hpp"
 #include "utility/maybe.hpp"
@@ -18,15 +19,28 @@ namespace gorc {
     template <typename IdT>
     class entity_component_system {
     private:
-        sequential_entity_generator<IdT> entities;
+        std::unique_ptr<entity_generator<IdT>> entities;
         component_relational_mapping<IdT> components;
         std::vector<std::unique_ptr<aspect>> aspects;
 
+        maybe<worker_pool*> workers;
+        aspect_schedule schedule;
+        bool schedule_dirty = true;
+
     public:
         event_bus &bus;
 
         explicit entity_component_system(service_registry const &services)
-            : bus(services.get<event_bus>())
+            : entity_component_system(services,
+                                      std::make_unique<sequential_entity_generator<IdT>>())
+        {
+            return;
+        }
+
+        entity_component_system(service_registry const &services,
+                                std::unique_ptr<entity_generator<IdT>> &&entities)
+            : entities(std::move(entities))
+            , bus(services.get<event_bus>())
         {
             services.get<component_registry<IdT>>().register_component_types(components);
             return;
@@ -34,7 +48,7 @@ namespace gorc {
 
         auto emplace_entity()
         {
-            return entities.emplace();
+            return entities->emplace();
         }
 
         void erase_entity(IdT entity)
@@ -42,7 +56,19 @@ namespace gorc {
             LOG_DEBUG(format("erased entity %d") % static_cast<int>(entity));
             bus.fire_event(entity_destroyed<IdT>(entity));
             components.erase_equal_range(entity);
-            entities.erase(entity);
+            entities->erase(entity);
+        }
+
+        // Generation-checked reference to an entity. Hold one instead of a raw ID when the
+        // entity may be erased, and its ID reused, before the reference is read again.
+        entity_handle<IdT> make_entity_handle(IdT entity) const
+        {
+            return entities->make_handle(entity);
+        }
+
+        bool is_current(entity_handle<IdT> const &handle) const
+        {
+            return entities->is_current(handle);
         }
 
         template <typename CompT, typename ...ArgT>
@@ -96,22 +122,75 @@ namespace gorc {
             components.template erase_if<CompT>(pred);
         }
 
+        template <typename CompT>
+        void insert_component_listener(component_pool_listener<IdT> &listener)
+        {
+            components.template insert_listener<CompT>(listener);
+        }
+
+        template <typename CompT>
+        void erase_component_listener(component_pool_listener<IdT> &listener)
+        {
+            components.template erase_listener<CompT>(listener);
+        }
+
         template <typename T, typename ...ArgT>
         void emplace_aspect(ArgT &&...args)
         {
             aspects.push_back(std::make_unique<T>(*this, std::forward<ArgT>(args)...));
+            schedule_dirty = true;
+        }
+
+        // Non-conflicting aspects are updated concurrently on the worker pool. Without a
+        // worker pool, aspects are updated serially in registration order. Component
+        // listeners are only notified on the calling thread, between stages.
+        void set_worker_pool(maybe<worker_pool*> pool)
+        {
+            workers = pool;
         }
 
         void update(time_delta dt)
         {
-            for(auto &aspect : aspects) {
-                aspect->update(dt);
-            }
+            maybe_if_else(workers, [&](worker_pool *pool) {
+                    if(schedule_dirty) {
+                        schedule.rebuild(aspects);
+                        schedule_dirty = false;
+                    }
+
+                    // Aspects in one stage may emplace into pools joined by the same view,
+                    // so listeners are notified between stages instead of from the workers.
+                    components.defer_notifications();
+                    try {
+                        schedule.update(dt, *pool, [&] {
+                                components.flush_deferred_notifications();
+                                components.defer_notifications();
+                            });
+                    }
+                    catch(...) {
+                        components.flush_deferred_notifications();
+                        throw;
+                    }
+
+                    components.flush_deferred_notifications();
+                },
+                [&] {
+                    for(auto &aspect : aspects) {
+                        aspect->update(dt);
+                    }
+                });
 
             components.flush_erase_queue();
-            entities.flush_erase_queue();
+            entities->flush_erase_queue();
             return;
         }
+
+        // Relocates components into as few pages as possible and frees the rest. Invalidates
+        // all component references, so it must not be called from inside an aspect update.
+        void compact_components()
+        {
+            components.flush_erase_queue();
+            components.compact();
+        }
     };
 
 
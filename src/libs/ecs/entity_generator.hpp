@@ -1,9 +1,26 @@
 #pragma once
 
 #include "content/id.hpp"
+#include <cstdint>
 
 namespace gorc {
 
+    // Entity and the generation it was created in. Handles to erased entities become stale
+    // when the entity ID is reused.
+    template <typename IdT>
+    class entity_handle {
+    public:
+        IdT entity;
+        uint32_t generation;
+
+        entity_handle(IdT entity, uint32_t generation)
+            : entity(entity)
+            , generation(generation)
+        {
+            return;
+        }
+    };
+
     template <typename IdT>
     class entity_generator {
     public:
@@ -16,6 +33,12 @@ namespace gorc {
         virtual void erase(IdT entity) = 0;
 
         virtual void flush_erase_queue() = 0;
+
+        // A stale handle is never current. Generators which reuse IDs make handles stale when
+        // their entity is erased and the erase queue is flushed. Other generators may keep them
+        // current, because no other entity can take the ID.
+        virtual entity_handle<IdT> make_handle(IdT entity) const = 0;
+        virtual bool is_current(entity_handle<IdT> const &handle) const = 0;
     };
 
 }
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "entity_component_system.hpp"
+#include "component_pool_listener.hpp"
+#include "utility/range.hpp"
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace gorc {
+
+    namespace detail {
+
+        template <typename IdT, typename ...CompT>
+        struct join_view_append_rows;
+
+        template <typename IdT>
+        struct join_view_append_rows<IdT> {
+            template <typename RowsT, typename ...ArgT>
+            void append(entity_component_system<IdT> &,
+                        IdT entity,
+                        RowsT &rows,
+                        ArgT *...args) const
+            {
+                rows.emplace_back(entity, args...);
+            }
+        };
+
+        template <typename IdT, typename HeadCompT, typename ...CompT>
+        struct join_view_append_rows<IdT, HeadCompT, CompT...> {
+            template <typename RowsT, typename ...ArgT>
+            void append(entity_component_system<IdT> &ecs,
+                        IdT entity,
+                        RowsT &rows,
+                        ArgT *...args) const
+            {
+                for(auto &comp : ecs.template find_component<HeadCompT>(entity)) {
+                    join_view_append_rows<IdT, CompT...>()
+                        .append(ecs, entity, rows, args..., comp.second);
+                }
+            }
+        };
+
+    }
+
+    // Persistent inner join of several component types on entity. The ECS notifies the view
+    // whenever a participating component is emplaced, erased or moved, and the affected
+    // entities are re-joined on the next refresh.
+    template <typename IdT, typename HeadCompT, typename ...CompT>
+    class join_view : public component_pool_listener<IdT> {
+    public:
+        using row = std::tuple<IdT, HeadCompT*, CompT*...>;
+        using iterator = typename std::vector<row>::iterator;
+
+    private:
+        entity_component_system<IdT> &ecs;
+        std::vector<row> rows;
+        std::vector<IdT> dirty_entities;
+        std::vector<char> dirty_flags;
+
+        bool is_dirty(IdT entity) const
+        {
+            auto value = static_cast<size_t>(static_cast<int32_t>(entity));
+            return value < dirty_flags.size() && dirty_flags[value];
+        }
+
+        template <typename ...T>
+        static void ignore(T const &...)
+        {
+            return;
+        }
+
+    public:
+        explicit join_view(entity_component_system<IdT> &ecs)
+            : ecs(ecs)
+        {
+            ecs.template insert_component_listener<HeadCompT>(*this);
+            ignore((ecs.template insert_component_listener<CompT>(*this), 0)...);
+
+            for(auto &comp : ecs.template all_components<HeadCompT>()) {
+                component_changed(comp.first);
+            }
+        }
+
+        join_view(join_view const &) = delete;
+        join_view& operator=(join_view const &) = delete;
+
+        ~join_view()
+        {
+            ecs.template erase_component_listener<HeadCompT>(*this);
+            ignore((ecs.template erase_component_listener<CompT>(*this), 0)...);
+        }
+
+        virtual void component_changed(IdT entity) override
+        {
+            auto value = static_cast<size_t>(static_cast<int32_t>(entity));
+            if(value >= dirty_flags.size()) {
+                dirty_flags.resize(value + 1, 0);
+            }
+
+            if(!dirty_flags[value]) {
+                dirty_flags[value] = 1;
+                dirty_entities.push_back(entity);
+            }
+        }
+
+        void refresh()
+        {
+            if(dirty_entities.empty()) {
+                return;
+            }
+
+            rows.erase(std::remove_if(rows.begin(),
+                                      rows.end(),
+                                      [this](row const &r) { return is_dirty(std::get<0>(r)); }),
+                       rows.end());
+
+            for(auto entity : dirty_entities) {
+                dirty_flags[static_cast<size_t>(static_cast<int32_t>(entity))] = 0;
+                detail::join_view_append_rows<IdT, HeadCompT, CompT...>()
+                    .append(ecs, entity, rows);
+            }
+
+            dirty_entities.clear();
+        }
+
+        iterator begin()
+        {
+            return rows.begin();
+        }
+
+        iterator end()
+        {
+            return rows.end();
+        }
+
+        size_t size() const
+        {
+            return rows.size();
+        }
+    };
+
+}
@@ -3,6 +3,8 @@
 #include <vector>
 #include <array>
 #include <memory>
+#include <algorithm>
+#include <functional>
 #include <type_traits>
 
 namespace gorc {
@@ -11,16 +13,53 @@ namespace gorc {
     class pool {
     private:
         using EmStorageT = typename std::aligned_storage<sizeof(EmT), alignof(EmT)>::type;
-        using EmStoragePageT = std::array<EmStorageT, page_size>;
-        std::vector<std::unique_ptr<EmStoragePageT>> pages;
+
+        class page {
+        public:
+            std::array<EmStorageT, page_size> storage;
+            size_t live = 0;
+            bool releasing = false;
+        };
+
+        // Pages are kept sorted by address so that the owning page of an element can be found
+        // by binary search. The free list is a min-heap on address: slots are handed out lowest
+        // address first, so live elements stay packed toward the front of the pool after churn.
+        std::vector<std::unique_ptr<page>> pages;
         std::vector<EmStorageT*> free_list;
 
+        static bool free_list_order(EmStorageT const *a, EmStorageT const *b)
+        {
+            return std::greater<EmStorageT const*>()(a, b);
+        }
+
+        page& page_of(EmStorageT const *em)
+        {
+            auto it = std::upper_bound(pages.begin(),
+                                       pages.end(),
+                                       em,
+                                       [](EmStorageT const *e, std::unique_ptr<page> const &p) {
+                                           return std::less<EmStorageT const*>()(e, p->storage.data());
+                                       });
+            return **(it - 1);
+        }
+
         void add_page()
         {
             free_list.reserve(free_list.size() + page_size);
-            pages.push_back(std::make_unique<EmStoragePageT>());
-            for(auto &em : *pages.back()) {
+
+            auto new_page = std::make_unique<page>();
+            page *new_page_ptr = new_page.get();
+            auto it = std::lower_bound(pages.begin(),
+                                       pages.end(),
+                                       new_page_ptr,
+                                       [](std::unique_ptr<page> const &p, page *np) {
+                                           return std::less<page*>()(p.get(), np);
+                                       });
+            pages.insert(it, std::move(new_page));
+
+            for(auto &em : new_page_ptr->storage) {
                 free_list.push_back(&em);
+                std::push_heap(free_list.begin(), free_list.end(), free_list_order);
             }
         }
 
@@ -30,9 +69,12 @@ namespace gorc {
                 add_page();
             }
 
+            std::pop_heap(free_list.begin(), free_list.end(), free_list_order);
             EmStorageT *storage = free_list.back();
             free_list.pop_back();
 
+            ++page_of(storage).live;
+
             return storage;
         }
 
@@ -51,7 +93,101 @@ namespace gorc {
             // pool is the assumed owner of the element.
             EmT *em = const_cast<EmT*>(&em_ref);
             em->~EmT();
-            free_list.push_back(reinterpret_cast<EmStorageT*>(em));
+
+            auto *storage = reinterpret_cast<EmStorageT*>(em);
+            --page_of(storage).live;
+            free_list.push_back(storage);
+            std::push_heap(free_list.begin(), free_list.end(), free_list_order);
+        }
+
+        // Frees pages which contain no live elements. One empty page is retained to absorb
+        // spawn/erase churn without returning to the allocator.
+        size_t release_empty_pages()
+        {
+            size_t empty_pages = 0;
+            for(auto &p : pages) {
+                if(p->live == 0 && empty_pages++ > 0) {
+                    p->releasing = true;
+                }
+            }
+
+            if(empty_pages <= 1) {
+                return 0;
+            }
+
+            free_list.erase(std::remove_if(free_list.begin(),
+                                           free_list.end(),
+                                           [this](EmStorageT *em) {
+                                               return page_of(em).releasing;
+                                           }),
+                            free_list.end());
+            std::make_heap(free_list.begin(), free_list.end(), free_list_order);
+
+            pages.erase(std::remove_if(pages.begin(),
+                                       pages.end(),
+                                       [](std::unique_ptr<page> const &p) {
+                                           return p->releasing;
+                                       }),
+                        pages.end());
+
+            return empty_pages - 1;
+        }
+
+        // Moves live elements from the highest-addressed slots into the lowest free slots, then
+        // frees the pages left empty. relocated(from, to) is called after each move, while the
+        // moved-from element has already been destroyed; from must only be compared, never
+        // dereferenced. Returns the number of pages freed.
+        template <typename RelocatedFnT>
+        size_t compact(RelocatedFnT relocated)
+        {
+            // An ascending free list is also a valid min-heap.
+            std::sort(free_list.begin(), free_list.end(), std::less<EmStorageT*>());
+
+            std::vector<EmStorageT*> vacated;
+            auto target = free_list.begin();
+            auto free_above = free_list.end();
+            bool packed = false;
+
+            for(auto pg = pages.rbegin(); !packed && pg != pages.rend(); ++pg) {
+                for(auto em = (*pg)->storage.rbegin(); em != (*pg)->storage.rend(); ++em) {
+                    EmStorageT *source = &*em;
+                    if(free_above != target && *(free_above - 1) == source) {
+                        // Slot is already free
+                        --free_above;
+                        continue;
+                    }
+
+                    if(target == free_above || !std::less<EmStorageT*>()(*target, source)) {
+                        // Every remaining live element is below the lowest free slot
+                        packed = true;
+                        break;
+                    }
+
+                    EmT *from = reinterpret_cast<EmT*>(source);
+                    EmT *to = reinterpret_cast<EmT*>(*target);
+                    new(to) EmT(std::move(*from));
+                    from->~EmT();
+
+                    ++page_of(*target).live;
+                    --(*pg)->live;
+
+                    vacated.push_back(source);
+                    ++target;
+
+                    relocated(static_cast<EmT const*>(from), *to);
+                }
+            }
+
+            free_list.erase(free_list.begin(), target);
+            free_list.insert(free_list.end(), vacated.begin(), vacated.end());
+            std::make_heap(free_list.begin(), free_list.end(), free_list_order);
+
+            return release_empty_pages();
+        }
+
+        size_t page_count() const
+        {
+            return pages.size();
         }
     };
 
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "entity_generator.hpp"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace gorc {
+
+    // Reuses the IDs of erased entities, oldest first, so that the ID space stays bounded by
+    // the peak number of live entities. Each ID carries a generation counter which advances
+    // when the ID is freed.
+    template <typename IdT>
+    class recycling_entity_generator : public entity_generator<IdT> {
+    private:
+        using IdValueT = typename std::underlying_type<IdT>::type;
+        std::vector<uint32_t> generations;
+        std::vector<char> live;
+        std::deque<IdT> free_list;
+        std::vector<IdT> erase_queue;
+
+        static size_t index_of(IdT entity)
+        {
+            return static_cast<size_t>(static_cast<IdValueT>(entity));
+        }
+
+    public:
+        virtual IdT emplace() override
+        {
+            if(free_list.empty()) {
+                IdT rv(generations.size());
+                generations.push_back(0);
+                live.push_back(1);
+                return rv;
+            }
+
+            IdT rv = free_list.front();
+            free_list.pop_front();
+            live[index_of(rv)] = 1;
+            return rv;
+        }
+
+        virtual void erase(IdT entity) override
+        {
+            erase_queue.push_back(entity);
+        }
+
+        virtual void flush_erase_queue() override
+        {
+            for(auto entity : erase_queue) {
+                // Each freed entity advances its generation exactly once, even if it was
+                // erased several times in one update.
+                if(!is_live(entity)) {
+                    continue;
+                }
+
+                ++generations[index_of(entity)];
+                live[index_of(entity)] = 0;
+                free_list.push_back(entity);
+            }
+
+            erase_queue.clear();
+        }
+
+        size_t capacity() const
+        {
+            return generations.size();
+        }
+
+        uint32_t generation_of(IdT entity) const
+        {
+            return generations.at(index_of(entity));
+        }
+
+        virtual entity_handle<IdT> make_handle(IdT entity) const override
+        {
+            auto idx = index_of(entity);
+            return entity_handle<IdT>(entity, (idx < generations.size()) ? generations[idx] : 0U);
+        }
+
+        virtual bool is_current(entity_handle<IdT> const &handle) const override
+        {
+            return is_live(handle.entity) &&
+                   generations[index_of(handle.entity)] == handle.generation;
+        }
+
+        bool is_live(IdT entity) const
+        {
+            auto idx = index_of(entity);
+            return idx < live.size() && live[idx];
+        }
+    };
+
+}
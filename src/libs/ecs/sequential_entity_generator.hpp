@@ -4,6 +4,7 @@
 
 namespace gorc {
 
+    // Never reuses an entity ID, so every handle has generation 0 and stays current.
     template <typename IdT>
     class sequential_entity_generator : public entity_generator<IdT> {
     private:
@@ -25,6 +26,17 @@ namespace gorc {
         {
             return;
         }
+
+        virtual entity_handle<IdT> make_handle(IdT entity) const override
+        {
+            return entity_handle<IdT>(entity, 0U);
+        }
+
+        virtual bool is_current(entity_handle<IdT> const &handle) const override
+        {
+            auto value = static_cast<IdValueT>(handle.entity);
+            return value >= 0 && value < next && handle.generation == 0U;
+        }
     };
 
 }
@@ -0,0 +1,288 @@
+#include "test/test.hpp"
+#include "ecs/aspect_schedule.hpp"
+#include "ecs/entity_component_system.hpp"
+#include "ecs/inner_join_aspect.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace gorc;
+
+namespace {
+
+    class component_a {
+    public:
+        uid(10);
+    };
+
+    class component_b {
+    public:
+        uid(20);
+    };
+
+    class mock_aspect : public aspect {
+    public:
+        std::vector<int> &log;
+        int value;
+
+        mock_aspect(std::vector<int> &log, int value)
+            : log(log)
+            , value(value)
+        {
+            return;
+        }
+
+        virtual void update(time_delta) override
+        {
+            log.push_back(value);
+        }
+    };
+
+    template <typename ReadT, typename WriteT>
+    class mock_declared_aspect : public aspect {
+    public:
+        std::atomic<int> &count;
+
+        mock_declared_aspect(std::atomic<int> &count)
+            : count(count)
+        {
+            reads_component<ReadT>();
+            writes_component<WriteT>();
+        }
+
+        virtual void update(time_delta) override
+        {
+            ++count;
+        }
+    };
+
+    template <typename ReadT>
+    class mock_reader_aspect : public aspect {
+    public:
+        std::atomic<int> &count;
+
+        mock_reader_aspect(std::atomic<int> &count)
+            : count(count)
+        {
+            reads_component<ReadT>();
+        }
+
+        virtual void update(time_delta) override
+        {
+            ++count;
+        }
+    };
+
+    class ecs_mock_aspect : public aspect {
+    public:
+        std::vector<int> &log;
+        int value;
+
+        ecs_mock_aspect(entity_component_system<thing_id> &,
+                        std::vector<int> &log,
+                        int value)
+            : log(log)
+            , value(value)
+        {
+            return;
+        }
+
+        virtual void update(time_delta) override
+        {
+            log.push_back(value);
+        }
+    };
+
+    template <typename CompT>
+    class emplacing_aspect : public aspect {
+    public:
+        entity_component_system<thing_id> &ecs;
+        std::vector<thing_id> entities;
+
+        emplacing_aspect(entity_component_system<thing_id> &ecs,
+                         std::vector<thing_id> const &entities)
+            : ecs(ecs)
+            , entities(entities)
+        {
+            writes_component<CompT>();
+        }
+
+        virtual void update(time_delta) override
+        {
+            for(auto entity : entities) {
+                ecs.emplace_component<CompT>(entity);
+            }
+
+            entities.clear();
+        }
+    };
+
+    class joining_aspect : public inner_join_aspect<thing_id, component_a, component_b> {
+    public:
+        int &rows;
+
+        joining_aspect(entity_component_system<thing_id> &ecs, int &rows)
+            : inner_join_aspect(ecs)
+            , rows(rows)
+        {
+            reads_component<component_a>();
+            reads_component<component_b>();
+        }
+
+        virtual void update(time_delta, thing_id, component_a &, component_b &) override
+        {
+            ++rows;
+        }
+    };
+
+    class thread_listener : public component_pool_listener<thing_id> {
+    public:
+        std::vector<std::thread::id> threads;
+
+        virtual void component_changed(thing_id) override
+        {
+            threads.push_back(std::this_thread::get_id());
+        }
+    };
+
+    class aspect_schedule_fixture : public test::fixture {
+    public:
+        event_bus bus;
+        component_registry<thing_id> cr;
+        service_registry services;
+
+        aspect_schedule_fixture()
+        {
+            cr.register_component_type<component_a>();
+            cr.register_component_type<component_b>();
+
+            services.add(cr);
+            services.add(bus);
+        }
+    };
+
+}
+
+begin_suite_fixture(aspect_schedule_test, aspect_schedule_fixture);
+
+test_case(undeclared_conflicts)
+{
+    std::vector<int> log;
+    std::atomic<int> count(0);
+
+    mock_aspect a(log, 1);
+    mock_reader_aspect<component_a> b(count);
+
+    assert_true(a.conflicts_with(a));
+    assert_true(a.conflicts_with(b));
+    assert_true(b.conflicts_with(a));
+}
+
+test_case(declared_conflicts)
+{
+    std::atomic<int> count(0);
+
+    mock_reader_aspect<component_a> read_a(count);
+    mock_reader_aspect<component_b> read_b(count);
+    mock_declared_aspect<component_a, component_b> read_a_write_b(count);
+    mock_declared_aspect<component_b, component_a> read_b_write_a(count);
+
+    assert_true(!read_a.conflicts_with(read_a));
+    assert_true(!read_a.conflicts_with(read_b));
+    assert_true(read_a.conflicts_with(read_b_write_a));
+    assert_true(read_b_write_a.conflicts_with(read_a));
+    assert_true(read_a_write_b.conflicts_with(read_b_write_a));
+    assert_true(read_a_write_b.conflicts_with(read_a_write_b));
+}
+
+test_case(stages)
+{
+    std::vector<int> log;
+    std::atomic<int> count(0);
+
+    std::vector<std::unique_ptr<aspect>> aspects;
+    aspects.push_back(std::make_unique<mock_reader_aspect<component_a>>(count));
+    aspects.push_back(std::make_unique<mock_reader_aspect<component_b>>(count));
+    aspects.push_back(std::make_unique<mock_declared_aspect<component_b, component_a>>(count));
+    aspects.push_back(std::make_unique<mock_reader_aspect<component_b>>(count));
+    aspects.push_back(std::make_unique<mock_aspect>(log, 1));
+    aspects.push_back(std::make_unique<mock_reader_aspect<component_a>>(count));
+
+    aspect_schedule schedule;
+    schedule.rebuild(aspects);
+    assert_eq(schedule.stage_count(), size_t(4));
+
+    worker_pool workers(4);
+    schedule.update(std::chrono::seconds(0), workers);
+
+    assert_eq(count.load(), 5);
+    assert_eq(log, std::vector<int> { 1 });
+}
+
+test_case(ecs_serial_fallback)
+{
+    std::vector<int> log;
+
+    entity_component_system<thing_id> ecs(services);
+    ecs.emplace_aspect<ecs_mock_aspect>(log, 1);
+    ecs.emplace_aspect<ecs_mock_aspect>(log, 2);
+    ecs.emplace_aspect<ecs_mock_aspect>(log, 3);
+
+    ecs.update(std::chrono::seconds(0));
+    assert_eq(log, (std::vector<int> { 1, 2, 3 }));
+}
+
+test_case(ecs_worker_pool)
+{
+    std::vector<int> log;
+
+    worker_pool workers(4);
+
+    entity_component_system<thing_id> ecs(services);
+    ecs.set_worker_pool(&workers);
+    ecs.emplace_aspect<ecs_mock_aspect>(log, 1);
+    ecs.emplace_aspect<ecs_mock_aspect>(log, 2);
+
+    ecs.update(std::chrono::seconds(0));
+
+    ecs.emplace_aspect<ecs_mock_aspect>(log, 3);
+    ecs.update(std::chrono::seconds(0));
+
+    // Undeclared aspects keep their serial order
+    assert_eq(log, (std::vector<int> { 1, 2, 1, 2, 3 }));
+}
+
+test_case(ecs_worker_pool_defers_notifications)
+{
+    worker_pool workers(4);
+
+    entity_component_system<thing_id> ecs(services);
+    ecs.set_worker_pool(&workers);
+
+    std::vector<thing_id> entities;
+    for(int i = 0; i < 64; ++i) {
+        entities.push_back(ecs.emplace_entity());
+    }
+
+    thread_listener listener;
+    ecs.insert_component_listener<component_a>(listener);
+    ecs.insert_component_listener<component_b>(listener);
+
+    int rows = 0;
+    ecs.emplace_aspect<emplacing_aspect<component_a>>(entities);
+    ecs.emplace_aspect<emplacing_aspect<component_b>>(entities);
+    ecs.emplace_aspect<joining_aspect>(rows);
+
+    ecs.update(std::chrono::seconds(0));
+
+    // Components emplaced in the first stage are joined in the second
+    assert_eq(rows, 64);
+    assert_eq(listener.threads,
+              std::vector<std::thread::id>(128, std::this_thread::get_id()));
+
+    ecs.erase_component_listener<component_a>(listener);
+    ecs.erase_component_listener<component_b>(listener);
+}
+
+end_suite(aspect_schedule_test);
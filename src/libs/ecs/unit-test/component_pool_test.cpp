@@ -17,6 +17,20 @@ namespace {
             return;
         }
     };
+
+    class immovable_component {
+    public:
+        int value = 0;
+
+        immovable_component(int value)
+            : value(value)
+        {
+            return;
+        }
+
+        immovable_component(immovable_component const &) = delete;
+        immovable_component(immovable_component &&) = delete;
+    };
 }
 
 begin_suite(component_pool_test);
@@ -134,4 +148,78 @@ test_case(erase_equal_range)
     assert_true(p.equal_range(thing_id(3)).empty());
 }
 
+test_case(erase_duplicates)
+{
+    component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(i % 2), i);
+    }
+
+    p.erase_equal_range(thing_id(1));
+    p.erase_equal_range(thing_id(1));
+    p.erase(p.equal_range(thing_id(1)));
+    p.flush_erase_queue();
+
+    assert_true(p.equal_range(thing_id(1)).empty());
+
+    std::set<int> values;
+    for(auto const &em : p) {
+        values.insert(em.second->value);
+    }
+
+    std::set<int> expected { 0, 2, 4, 6, 8 };
+    assert_range_eq(values, expected);
+}
+
+test_case(compact)
+{
+    component_pool<thing_id, mock_component, 4> p;
+
+    for(int i = 0; i < 16; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    // Leave one component in each of the first three pages
+    p.erase_if([](thing_id id, mock_component const &) {
+            int value = static_cast<int>(id);
+            return value % 4 != 0 || value == 12;
+        });
+    p.flush_erase_queue();
+    p.compact();
+
+    std::set<mock_component*> pointers;
+    std::set<std::pair<int, int>> values;
+    for(auto const &em : p) {
+        pointers.insert(em.second);
+        values.emplace(static_cast<int>(em.first), em.second->value);
+    }
+
+    std::set<std::pair<int, int>> expected { { 0, 0 }, { 4, 4 }, { 8, 8 } };
+    assert_range_eq(values, expected);
+
+    // All survivors were packed into a single page
+    assert_lt(*pointers.rbegin() - *pointers.begin(), 4);
+}
+
+test_case(compact_immovable)
+{
+    component_pool<thing_id, immovable_component, 4> p;
+
+    for(int i = 0; i < 8; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    auto &last = *p.equal_range(thing_id(7)).begin()->second;
+
+    p.erase_if([](thing_id id, immovable_component const &) {
+            return static_cast<int>(id) < 4;
+        });
+    p.flush_erase_queue();
+    p.compact();
+
+    assert_eq(p.equal_range(thing_id(7)).begin()->second, &last);
+    assert_eq(last.value, 7);
+}
+
 end_suite(component_pool_test);
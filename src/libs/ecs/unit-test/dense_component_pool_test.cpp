@@ -0,0 +1,251 @@
+#include "test/test.hpp"
+#include "ecs/dense_component_pool.hpp"
+#include "ecs/component_relational_mapping.hpp"
+#include "ecs/component_registry.hpp"
+#include "content/id.hpp"
+#include <vector>
+#include <set>
+#include <stdexcept>
+
+using namespace gorc;
+
+namespace {
+    class mock_component {
+    public:
+        int value = 0;
+
+        mock_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class mock_dense_component {
+    public:
+        uid(30);
+        dense_storage();
+
+        int value = 0;
+
+        mock_dense_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class mock_throwing_component {
+    public:
+        int value = 0;
+
+        mock_throwing_component(int value)
+            : value(value)
+        {
+            if(value < 0) {
+                throw std::runtime_error("negative value");
+            }
+        }
+    };
+
+    template <typename RangeT>
+    std::set<int> mock_comp_to_range(RangeT const &rng)
+    {
+        std::set<int> rv;
+        for(auto const &em : rng) {
+            rv.insert(em.second->value);
+        }
+
+        return rv;
+    }
+}
+
+begin_suite(dense_component_pool_test);
+
+test_case(simple_emplace_find)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    auto const &comp = p.emplace(thing_id(5), 2);
+    assert_eq(comp.value, 2);
+
+    assert_range_eq(mock_comp_to_range(p.equal_range(thing_id(5))), std::set<int>({ 2 }));
+    assert_true(p.equal_range(thing_id(4)).empty());
+    assert_true(p.equal_range(thing_id(500)).empty());
+}
+
+test_case(emplace_duplicate)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    p.emplace(thing_id(5), 2);
+    assert_throws_logged(p.emplace(thing_id(5), 3));
+    assert_log_message(log_level::error, "entity 5 already has a " +
+                                         std::string(typeid(mock_component).name()) +
+                                         " component");
+    assert_log_empty();
+}
+
+test_case(iteration_is_dense)
+{
+    dense_component_pool<thing_id, mock_component, 4> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(i * 3), i);
+    }
+
+    std::vector<int> values;
+    std::vector<int> ids;
+    for(auto const &em : p) {
+        ids.push_back(static_cast<int>(em.first));
+        values.push_back(em.second->value);
+    }
+
+    assert_range_eq(values, std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+    assert_range_eq(ids, std::vector<int>({ 0, 3, 6, 9, 12, 15, 18, 21, 24, 27 }));
+}
+
+test_case(component_addresses_stable_across_emplace)
+{
+    dense_component_pool<thing_id, mock_component, 2> p;
+
+    auto *comp = &p.emplace(thing_id(0), 12);
+    for(int i = 1; i < 100; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    assert_eq(comp, p.equal_range(thing_id(0)).begin()->second);
+    assert_eq(comp->value, 12);
+}
+
+test_case(emplace_while_iterating)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    p.emplace(thing_id(0), 0);
+
+    int count = 0;
+    for(auto const &em : p) {
+        ++count;
+        if(em.second->value < 100) {
+            p.emplace(thing_id(em.second->value + 1), em.second->value + 1);
+        }
+    }
+
+    assert_eq(count, 1);
+    assert_eq(mock_comp_to_range(make_range(p)).size(), size_t(2));
+}
+
+test_case(erase_moves_last)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 5; ++i) {
+        p.emplace(thing_id(i), i * 10);
+    }
+
+    p.erase(p.equal_range(thing_id(1)));
+    p.erase_equal_range(thing_id(3));
+    p.erase_equal_range(thing_id(3));
+    p.erase_equal_range(thing_id(7));
+
+    // Erase is deferred until flush
+    assert_eq(mock_comp_to_range(make_range(p)).size(), size_t(5));
+
+    p.flush_erase_queue();
+
+    assert_range_eq(mock_comp_to_range(make_range(p)), std::set<int>({ 0, 20, 40 }));
+    assert_true(p.equal_range(thing_id(1)).empty());
+    assert_true(p.equal_range(thing_id(3)).empty());
+    assert_range_eq(mock_comp_to_range(p.equal_range(thing_id(4))), std::set<int>({ 40 }));
+
+    p.emplace(thing_id(3), 5);
+    assert_range_eq(mock_comp_to_range(p.equal_range(thing_id(3))), std::set<int>({ 5 }));
+}
+
+test_case(emplace_after_queued_erase)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 3; ++i) {
+        p.emplace(thing_id(i), i * 10);
+    }
+
+    auto const *old_addr = &p.equal_range(thing_id(1)).begin()->second->value;
+
+    p.erase_equal_range(thing_id(1));
+    p.erase_equal_range(thing_id(1));
+    auto const &comp = p.emplace(thing_id(1), 15);
+    assert_eq(comp.value, 15);
+    assert_eq(&comp.value, old_addr);
+
+    // The replaced component is not erased by the flush
+    p.flush_erase_queue();
+    assert_range_eq(mock_comp_to_range(make_range(p)), std::set<int>({ 0, 15, 20 }));
+    assert_range_eq(mock_comp_to_range(p.equal_range(thing_id(1))), std::set<int>({ 15 }));
+    assert_log_empty();
+}
+
+test_case(emplace_after_queued_erase_throws)
+{
+    dense_component_pool<thing_id, mock_throwing_component> p;
+
+    for(int i = 0; i < 3; ++i) {
+        p.emplace(thing_id(i), i * 10);
+    }
+
+    p.erase_equal_range(thing_id(1));
+
+    bool threw = false;
+    try {
+        p.emplace(thing_id(1), -1);
+    }
+    catch(std::runtime_error const &) {
+        threw = true;
+    }
+
+    assert_true(threw);
+
+    // The old component is intact and its erase is still queued
+    assert_range_eq(mock_comp_to_range(p.equal_range(thing_id(1))), std::set<int>({ 10 }));
+    p.flush_erase_queue();
+    assert_range_eq(mock_comp_to_range(make_range(p)), std::set<int>({ 0, 20 }));
+}
+
+test_case(erase_if)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    p.erase_if([](thing_id, mock_component const &c) { return c.value % 2; });
+    p.flush_erase_queue();
+
+    assert_range_eq(mock_comp_to_range(make_range(p)), std::set<int>({ 0, 2, 4, 6, 8 }));
+}
+
+test_case(registered_as_dense)
+{
+    component_registry<thing_id> cr;
+    cr.register_component_type<mock_dense_component>();
+
+    component_relational_mapping<thing_id> crm;
+    cr.register_component_types(crm);
+
+    crm.emplace<mock_dense_component>(thing_id(2), 5);
+    crm.emplace<mock_dense_component>(thing_id(3), 12);
+
+    assert_range_eq(mock_comp_to_range(crm.range<mock_dense_component>()),
+                    std::set<int>({ 5, 12 }));
+
+    auto rng = crm.equal_range<mock_dense_component>(thing_id(2));
+    crm.erase(rng.begin(), rng.end());
+    crm.flush_erase_queue();
+
+    assert_range_eq(mock_comp_to_range(crm.range<mock_dense_component>()),
+                    std::set<int>({ 12 }));
+}
+
+end_suite(dense_component_pool_test);
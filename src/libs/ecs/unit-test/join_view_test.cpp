@@ -0,0 +1,152 @@
+#include "ecs/join_view.hpp"
+#include "ecs/entity_component_system.hpp"
+#include "test/test.hpp"
+#include <set>
+#include <tuple>
+
+using namespace gorc;
+
+namespace {
+
+    class mock_health_component {
+    public:
+        uid(10);
+        int value;
+
+        mock_health_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class mock_armor_component {
+    public:
+        uid(20);
+        dense_storage();
+
+        int value;
+
+        mock_armor_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    using mock_view = join_view<thing_id, mock_health_component, mock_armor_component>;
+
+    std::set<std::tuple<int, int, int>> view_values(mock_view &view)
+    {
+        view.refresh();
+
+        std::set<std::tuple<int, int, int>> rv;
+        for(auto const &r : view) {
+            rv.emplace(static_cast<int>(std::get<0>(r)),
+                       std::get<1>(r)->value,
+                       std::get<2>(r)->value);
+        }
+
+        return rv;
+    }
+
+    class join_view_fixture : public test::fixture {
+    public:
+        event_bus bus;
+        component_registry<thing_id> cr;
+        service_registry services;
+
+        join_view_fixture()
+        {
+            cr.register_component_type<mock_health_component>();
+            cr.register_component_type<mock_armor_component>();
+
+            services.add(cr);
+            services.add(bus);
+        }
+    };
+
+}
+
+begin_suite_fixture(join_view_test, join_view_fixture);
+
+test_case(existing_components)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    auto thing0 = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(thing0, 5);
+    ecs.emplace_component<mock_armor_component>(thing0, 10);
+
+    auto thing1 = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(thing1, 15);
+
+    mock_view view(ecs);
+
+    std::set<std::tuple<int, int, int>> expected = {
+            std::make_tuple(0, 5, 10)
+        };
+
+    assert_range_eq(view_values(view), expected);
+}
+
+test_case(incremental_emplace)
+{
+    entity_component_system<thing_id> ecs(services);
+    mock_view view(ecs);
+
+    auto thing0 = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(thing0, 5);
+    assert_true(view_values(view).empty());
+
+    ecs.emplace_component<mock_armor_component>(thing0, 10);
+    ecs.emplace_component<mock_health_component>(thing0, 7);
+
+    std::set<std::tuple<int, int, int>> expected = {
+            std::make_tuple(0, 5, 10),
+            std::make_tuple(0, 7, 10)
+        };
+
+    assert_range_eq(view_values(view), expected);
+}
+
+test_case(incremental_erase)
+{
+    entity_component_system<thing_id> ecs(services);
+    mock_view view(ecs);
+
+    for(int i = 0; i < 4; ++i) {
+        auto thing = ecs.emplace_entity();
+        ecs.emplace_component<mock_health_component>(thing, i);
+        ecs.emplace_component<mock_armor_component>(thing, i * 10);
+    }
+
+    assert_eq(view_values(view).size(), size_t(4));
+
+    // Erasing thing 1 moves the dense armor component of thing 3.
+    ecs.erase_components<mock_armor_component>(thing_id(1));
+    ecs.erase_entity(thing_id(2));
+    ecs.update(std::chrono::seconds(0));
+
+    std::set<std::tuple<int, int, int>> expected = {
+            std::make_tuple(0, 0, 0),
+            std::make_tuple(3, 3, 30)
+        };
+
+    assert_range_eq(view_values(view), expected);
+}
+
+test_case(unregisters_on_destruction)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    {
+        mock_view view(ecs);
+    }
+
+    auto thing0 = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(thing0, 5);
+    ecs.emplace_component<mock_armor_component>(thing0, 10);
+}
+
+end_suite(join_view_test);
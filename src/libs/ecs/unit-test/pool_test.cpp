@@ -1,6 +1,10 @@
 #include "test/test.hpp"
 #include "ecs/pool.hpp"
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <set>
+#include <vector>
 
 namespace {
 
@@ -56,4 +60,105 @@ test_case(page_allocation)
     assert_eq(components.size(), size_t(100));
 }
 
+test_case(release_empty_pages)
+{
+    std::vector<mock_component*> components;
+
+    gorc::pool<mock_component, 4> p;
+    for(int i = 0; i < 16; ++i) {
+        components.push_back(&p.emplace(i));
+    }
+
+    assert_eq(p.page_count(), size_t(4));
+    assert_eq(p.release_empty_pages(), size_t(0));
+
+    for(auto *comp : components) {
+        if(comp->i != 3) {
+            p.erase(*comp);
+        }
+    }
+
+    // One empty page is retained
+    assert_eq(p.release_empty_pages(), size_t(2));
+    assert_eq(p.page_count(), size_t(2));
+    assert_eq(components[3]->i, 3);
+
+    std::set<mock_component*> new_components;
+    for(int i = 0; i < 7; ++i) {
+        auto *comp = &p.emplace(i + 100);
+        new_components.insert(comp);
+        assert_eq(comp->i, i + 100);
+    }
+
+    assert_eq(new_components.size(), size_t(7));
+    assert_eq(new_components.count(components[3]), size_t(0));
+    assert_eq(p.page_count(), size_t(2));
+}
+
+test_case(address_ordered_reuse)
+{
+    std::vector<mock_component*> components;
+
+    gorc::pool<mock_component, 4> p;
+    for(int i = 0; i < 8; ++i) {
+        components.push_back(&p.emplace(i));
+    }
+
+    p.erase(*components[2]);
+    p.erase(*components[6]);
+    p.erase(*components[0]);
+
+    // Freed slots are reused lowest address first
+    std::vector<mock_component*> expected { components[0], components[2], components[6] };
+    std::sort(expected.begin(), expected.end(), std::less<mock_component*>());
+
+    for(auto *slot : expected) {
+        assert_eq(&p.emplace(100), slot);
+    }
+}
+
+test_case(compact)
+{
+    std::vector<mock_component*> components;
+
+    gorc::pool<mock_component, 4> p;
+    for(int i = 0; i < 16; ++i) {
+        components.push_back(&p.emplace(i));
+    }
+
+    std::vector<mock_component*> sorted = components;
+    std::sort(sorted.begin(), sorted.end(), std::less<mock_component*>());
+
+    // Keep the last live element of every page
+    std::set<int> survivors;
+    for(size_t i = 0; i < sorted.size(); ++i) {
+        if(i % 4 == 3) {
+            survivors.insert(sorted[i]->i);
+        }
+        else {
+            p.erase(*sorted[i]);
+        }
+    }
+
+    std::map<mock_component const*, mock_component*> moved;
+    size_t freed = p.compact([&](mock_component const *from, mock_component &to) {
+            moved.emplace(from, &to);
+        });
+
+    // Survivors fill the lowest page, one empty page is retained
+    assert_eq(freed, size_t(2));
+    assert_eq(p.page_count(), size_t(2));
+
+    std::set<int> values;
+    for(size_t i = 3; i < sorted.size(); i += 4) {
+        auto it = moved.find(sorted[i]);
+        mock_component *current = (it == moved.end()) ? sorted[i] : it->second;
+        assert_true(std::find(sorted.begin(), sorted.begin() + 4, current) != sorted.begin() + 4);
+        values.insert(current->i);
+    }
+
+    assert_range_eq(values, survivors);
+    assert_eq(moved.size(), size_t(3));
+}
+
 end_suite(pool_test);
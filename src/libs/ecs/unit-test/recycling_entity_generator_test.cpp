@@ -0,0 +1,129 @@
+#include "test/test.hpp"
+#include "ecs/recycling_entity_generator.hpp"
+#include "ecs/entity_component_system.hpp"
+
+using namespace gorc;
+
+namespace {
+    class mock_component {
+    public:
+        uid(10);
+        int value;
+
+        mock_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+}
+
+begin_suite(recycling_entity_generator_test);
+
+test_case(characteristic)
+{
+    recycling_entity_generator<thing_id> eg;
+    for(int i = 0; i < 10; ++i) {
+        assert_eq(static_cast<int>(eg.emplace()), i);
+    }
+
+    eg.erase(thing_id(5));
+    eg.erase(thing_id(2));
+
+    // Erased IDs are not reused until the queue is flushed
+    assert_eq(static_cast<int>(eg.emplace()), 10);
+
+    eg.flush_erase_queue();
+
+    assert_eq(static_cast<int>(eg.emplace()), 5);
+    assert_eq(static_cast<int>(eg.emplace()), 2);
+    assert_eq(static_cast<int>(eg.emplace()), 11);
+    assert_eq(eg.capacity(), size_t(12));
+}
+
+test_case(generations)
+{
+    recycling_entity_generator<thing_id> eg;
+
+    auto first = eg.emplace();
+    assert_eq(eg.generation_of(first), 0U);
+
+    auto handle = eg.make_handle(first);
+    assert_true(eg.is_current(handle));
+    assert_true(eg.is_live(first));
+
+    eg.erase(first);
+    eg.erase(first);
+    assert_true(eg.is_current(handle));
+
+    eg.flush_erase_queue();
+    assert_true(!eg.is_current(handle));
+    assert_true(!eg.is_live(first));
+    assert_eq(eg.generation_of(first), 1U);
+
+    auto second = eg.emplace();
+    assert_eq(second, first);
+    assert_true(eg.is_live(second));
+    assert_true(!eg.is_current(handle));
+    assert_true(eg.is_current(eg.make_handle(second)));
+}
+
+test_case(invalid_entities)
+{
+    recycling_entity_generator<thing_id> eg;
+
+    assert_true(!eg.is_live(thing_id(3)));
+    assert_true(!eg.is_live(thing_id()));
+    assert_true(!eg.is_current(entity_handle<thing_id>(thing_id(0), 0)));
+}
+
+test_case(bounded_in_ecs)
+{
+    event_bus bus;
+    component_registry<thing_id> cr;
+    cr.register_component_type<mock_component>();
+
+    service_registry services;
+    services.add(cr);
+    services.add(bus);
+
+    entity_component_system<thing_id> ecs(services,
+                                          std::make_unique<recycling_entity_generator<thing_id>>());
+
+    for(int i = 0; i < 100; ++i) {
+        auto entity = ecs.emplace_entity();
+        assert_eq(static_cast<int>(entity), 0);
+
+        ecs.emplace_component<mock_component>(entity, i);
+        ecs.erase_entity(entity);
+        ecs.update(std::chrono::seconds(0));
+    }
+}
+
+test_case(stale_handles_in_ecs)
+{
+    event_bus bus;
+    component_registry<thing_id> cr;
+    cr.register_component_type<mock_component>();
+
+    service_registry services;
+    services.add(cr);
+    services.add(bus);
+
+    entity_component_system<thing_id> ecs(services,
+                                          std::make_unique<recycling_entity_generator<thing_id>>());
+
+    auto first = ecs.emplace_entity();
+    auto handle = ecs.make_entity_handle(first);
+    assert_true(ecs.is_current(handle));
+
+    ecs.erase_entity(first);
+    ecs.update(std::chrono::seconds(0));
+
+    auto second = ecs.emplace_entity();
+    assert_eq(second, first);
+    assert_true(!ecs.is_current(handle));
+    assert_true(ecs.is_current(ecs.make_entity_handle(second)));
+}
+
+end_suite(recycling_entity_generator_test);
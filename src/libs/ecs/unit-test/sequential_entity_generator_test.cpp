@@ -17,4 +17,23 @@ test_case(characteristic)
     assert_eq(static_cast<int>(eg.emplace()), 10);
 }
 
+test_case(handles)
+{
+    sequential_entity_generator<thing_id> eg;
+
+    auto first = eg.emplace();
+    auto handle = eg.make_handle(first);
+    assert_eq(handle.generation, 0U);
+    assert_true(eg.is_current(handle));
+
+    // IDs are never reused, so handles stay current
+    eg.erase(first);
+    eg.flush_erase_queue();
+    assert_true(eg.is_current(handle));
+    assert_true(eg.emplace() != first);
+
+    assert_true(!eg.is_current(entity_handle<thing_id>(thing_id(5), 0)));
+    assert_true(!eg.is_current(entity_handle<thing_id>(thing_id(), 0)));
+}
+
 end_suite(sequential_entity_generator_test);
@@ -0,0 +1,133 @@
+#include "model_face_bvh.hpp"
+#include "model_mesh.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Face bounds are padded so that rounding in transformed queries cannot cull a touching face.
+    float const face_bounds_margin = 0.001f;
+    size_t const max_leaf_faces = 4;
+}
+
+gorc::content::assets::model_face_bvh::model_face_bvh(model_mesh const &mesh)
+{
+    if(mesh.faces.empty()) {
+        return;
+    }
+
+    std::vector<box<3>> face_bounds;
+    std::vector<vector<3>> face_centers;
+    auto margin = make_vector(face_bounds_margin, face_bounds_margin, face_bounds_margin);
+
+    for(auto const &face : mesh.faces) {
+        auto v0 = mesh.vertices[std::get<0>(face.vertices.front())];
+        auto v1 = v0;
+        for(auto const &vx : face.vertices) {
+            auto const &v = mesh.vertices[std::get<0>(vx)];
+            for(size_t i = 0; i < 3; ++i) {
+                v0.begin()[i] = std::min(v0.begin()[i], v.begin()[i]);
+                v1.begin()[i] = std::max(v1.begin()[i], v.begin()[i]);
+            }
+        }
+
+        face_bounds.push_back(make_box(v0 - margin, v1 + margin));
+        face_centers.push_back((v0 + v1) / 2.0f);
+        face_indices.push_back(face_indices.size());
+    }
+
+    build(face_bounds, face_centers, 0, face_indices.size());
+
+    for(auto face : face_indices) {
+        leaf_face_bounds.push_back(face_bounds[face]);
+    }
+}
+
+size_t gorc::content::assets::model_face_bvh::build(std::vector<box<3>> const &face_bounds,
+                                                    std::vector<vector<3>> const &face_centers,
+                                                    size_t begin,
+                                                    size_t end)
+{
+    size_t node_index = nodes.size();
+    nodes.emplace_back();
+
+    auto bounds = face_bounds[face_indices[begin]];
+    auto center_bounds = make_box(face_centers[face_indices[begin]], face_centers[face_indices[begin]]);
+    for(size_t i = begin; i < end; ++i) {
+        auto const &fb = face_bounds[face_indices[i]];
+        auto const &fc = face_centers[face_indices[i]];
+        for(size_t j = 0; j < 3; ++j) {
+            bounds.v0.begin()[j] = std::min(bounds.v0.begin()[j], fb.v0.begin()[j]);
+            bounds.v1.begin()[j] = std::max(bounds.v1.begin()[j], fb.v1.begin()[j]);
+            center_bounds.v0.begin()[j] = std::min(center_bounds.v0.begin()[j], fc.begin()[j]);
+            center_bounds.v1.begin()[j] = std::max(center_bounds.v1.begin()[j], fc.begin()[j]);
+        }
+    }
+
+    nodes[node_index].bounds = bounds;
+
+    if(end - begin <= max_leaf_faces) {
+        nodes[node_index].first_face = begin;
+        nodes[node_index].face_count = end - begin;
+        return node_index;
+    }
+
+    // Split at the median face center along the longest axis.
+    auto extent = center_bounds.v1 - center_bounds.v0;
+    size_t axis = 0;
+    for(size_t j = 1; j < 3; ++j) {
+        if(extent.begin()[j] > extent.begin()[axis]) {
+            axis = j;
+        }
+    }
+
+    size_t mid = begin + (end - begin) / 2;
+    std::nth_element(face_indices.begin() + static_cast<std::ptrdiff_t>(begin),
+                     face_indices.begin() + static_cast<std::ptrdiff_t>(mid),
+                     face_indices.begin() + static_cast<std::ptrdiff_t>(end),
+                     [&](size_t a, size_t b) {
+                         return face_centers[a].begin()[axis] < face_centers[b].begin()[axis];
+                     });
+
+    build(face_bounds, face_centers, begin, mid);
+    auto second_child = build(face_bounds, face_centers, mid, end);
+    nodes[node_index].second_child = second_child;
+
+    return node_index;
+}
+
+bool gorc::content::assets::model_face_bvh::segment_overlaps(box<3> const &bounds,
+                                                             vector<3> const &p0,
+                                                             vector<3> const &dir)
+{
+    // Slab test over the segment parameter range [0, 1].
+    float t_min = 0.0f;
+    float t_max = 1.0f;
+    for(size_t i = 0; i < 3; ++i) {
+        float o = p0.begin()[i];
+        float d = dir.begin()[i];
+        float lo = bounds.v0.begin()[i];
+        float hi = bounds.v1.begin()[i];
+
+        if(std::fpclassify(d) == FP_ZERO) {
+            if(o < lo || o > hi) {
+                return false;
+            }
+
+            continue;
+        }
+
+        float t0 = (lo - o) / d;
+        float t1 = (hi - o) / d;
+        if(t0 > t1) {
+            std::swap(t0, t1);
+        }
+
+        t_min = std::max(t_min, t0);
+        t_max = std::min(t_max, t1);
+        if(t_min > t_max) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "math/vector.hpp"
+#include "math/box.hpp"
+#include <vector>
+
+namespace gorc {
+namespace content {
+namespace assets {
+
+class model_mesh;
+
+// Bounding volume hierarchy over the faces of a mesh, in mesh space.
+class model_face_bvh {
+public:
+    class node {
+    public:
+        box<3> bounds;
+
+        // Leaves list face_count faces starting at first_face in face_indices. The first child of
+        // an inner node follows it, and the second child is at second_child.
+        size_t first_face = 0;
+        size_t face_count = 0;
+        size_t second_child = 0;
+    };
+
+    std::vector<node> nodes;
+    std::vector<size_t> face_indices;
+
+    // Bounds of each face, in face_indices order.
+    std::vector<box<3>> leaf_face_bounds;
+
+    model_face_bvh() = default;
+    explicit model_face_bvh(model_mesh const &mesh);
+
+    // Calls fn with the index of each face whose bounds overlap the box.
+    template <typename FnT>
+    void visit_faces(box<3> const &query, FnT fn) const
+    {
+        visit_nodes([&](box<3> const &bounds) { return bounds.overlaps(query); }, fn);
+    }
+
+    // Calls fn with the index of each face whose bounds the segment passes through.
+    template <typename FnT>
+    void visit_faces(vector<3> const &p0, vector<3> const &p1, FnT fn) const
+    {
+        auto dir = p1 - p0;
+        visit_nodes([&](box<3> const &bounds) { return segment_overlaps(bounds, p0, dir); }, fn);
+    }
+
+private:
+    static bool segment_overlaps(box<3> const &bounds, vector<3> const &p0, vector<3> const &dir);
+
+    template <typename PredT, typename FnT>
+    void visit_nodes(PredT overlaps, FnT fn) const
+    {
+        if(nodes.empty()) {
+            return;
+        }
+
+        // Median splits keep the tree shallow; 64 levels is far beyond any 3DO mesh.
+        size_t stack[64];
+        size_t stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while(stack_size > 0) {
+            auto const &current = nodes[stack[--stack_size]];
+            if(!overlaps(current.bounds)) {
+                continue;
+            }
+
+            if(current.face_count > 0) {
+                for(size_t i = current.first_face; i < current.first_face + current.face_count; ++i) {
+                    if(overlaps(leaf_face_bounds[i])) {
+                        fn(face_indices[i]);
+                    }
+                }
+            }
+            else {
+                stack[stack_size++] = current.second_child;
+                stack[stack_size++] = static_cast<size_t>(&current - nodes.data()) + 1;
+            }
+        }
+    }
+
+    size_t build(std::vector<box<3>> const &face_bounds,
+                 std::vector<vector<3>> const &face_centers,
+                 size_t begin,
+                 size_t end);
+};
+
+}
+}
+}
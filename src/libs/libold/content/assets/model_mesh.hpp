@@ -1,6 +1,7 @@
 #pragma once
 
 #include "model_face.hpp"
+#include "model_face_bvh.hpp"
 #include "math/vector.hpp"
 #include <memory>
 #include <vector>
@@ -25,6 +26,8 @@ public:
     std::vector<model_face> faces;
 
     std::vector<int> mesh_index_buffer;
+
+    model_face_bvh face_bvh;
 };
 
 }
@@ -2,11 +2,17 @@
 #include "level_loader.hpp"
 #include "libold/content/assets/level.hpp"
 #include "content/content_manager.hpp"
+#include "content/loader_registry.hpp"
+#include "vfs/virtual_file_system.hpp"
+#include "io/memory_file.hpp"
+#include "jk/cog/compiler/compiler.hpp"
+#include "jk/cog/compiler/script_loader.hpp"
 #include "libold/content/constants.hpp"
 #include "libold/content/master_colormap.hpp"
 #include "math/vector.hpp"
 #include <boost/format.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
 #include <unordered_map>
 #include <string>
 #include <tuple>
@@ -588,6 +594,81 @@ const std::unordered_map<std::string, LevelSectionParser> LevelSectionParserMap
     {"things", ParseThingsSection}
 };
 
+// Collects the script names in the cogs section. The cogs section must be parsed in order,
+// because the number of values on each line depends on the script's symbols.
+void ScanCogScripts(text::tokenizer& tok, std::vector<std::string>& names) {
+    text::token t;
+    while(true) {
+        SkipToNextSection(tok);
+        tok.get_token(t);
+
+        if(t.type == text::token_type::end_of_file) {
+            return;
+        }
+        else if(boost::iequals(t.value, "cogs")) {
+            break;
+        }
+    }
+
+    tok.assert_identifier("world");
+    tok.assert_identifier("Cogs");
+    tok.get_number<size_t>();
+
+    while(true) {
+        tok.get_token(t);
+
+        if(t.type == text::token_type::end_of_file ||
+           (t.type == text::token_type::identifier && boost::iequals(t.value, "end"))) {
+            return;
+        }
+
+        tok.assert_punctuator(":");
+
+        std::string name = tok.get_space_delimited_string();
+        std::transform(name.begin(), name.end(), name.begin(), tolower);
+        names.push_back(name);
+
+        tok.skip_to_next_line();
+    }
+}
+
+void PrecompileCogScripts(memory_file const& level_source, cog::compiler& compiler, service_registry const& services) {
+    std::vector<cog::script_source> sources;
+
+    {
+        // Malformed levels and missing scripts are reported when the level is parsed.
+        log_capture discarded_diagnostics;
+
+        std::vector<std::string> names;
+        try {
+            memory_file::reader level_reader(level_source);
+            text::tokenizer tok(level_reader);
+            ScanCogScripts(tok, names);
+        }
+        catch(...) {
+            // Precompile the scripts found before the error.
+        }
+
+        auto const& prefixes = services.get<loader_registry>().get_loader(cog::script_loader::type).get_prefixes();
+        auto const& vfs = services.get<virtual_file_system>();
+
+        for(auto const& name : names) {
+            try {
+                auto file = vfs.find(name, prefixes);
+
+                memory_file script_text;
+                std::get<1>(file)->copy_to(script_text);
+                sources.emplace_back(name, std::string(script_text.data(), script_text.size()));
+            }
+            catch(...) {
+                continue;
+            }
+        }
+    }
+
+    compiler.precompile(sources);
+}
+
 void PostprocessLevel(assets::level& lev, content_manager& manager, service_registry const &) {
     // Post-process; load materials and scripts.
     for(auto& mat_entry : lev.materials) {
@@ -644,6 +725,21 @@ void PostprocessLevel(assets::level& lev, content_manager& manager, service_regi
 }
 }
 
+std::unique_ptr<gorc::asset> gorc::content::loaders::level_loader::deserialize(input_stream& file, content_manager& manager, asset_id id, service_registry const& services) const {
+    auto& compiler = services.get<cog::compiler>();
+    if(compiler.get_precompile_threads() == 0) {
+        return text_loader::deserialize(file, manager, id, services);
+    }
+
+    memory_file level_source;
+    file.copy_to(level_source);
+
+    PrecompileCogScripts(level_source, compiler, services);
+
+    memory_file::reader level_reader(level_source);
+    return text_loader::deserialize(level_reader, manager, id, services);
+}
+
 std::unique_ptr<gorc::asset> gorc::content::loaders::level_loader::parse(text::tokenizer& tok, content_manager& manager, service_registry const &services) const {
     std::unique_ptr<assets::level> lev(new assets::level());
 
@@ -10,6 +10,13 @@ class level_loader : public text_loader {
 public:
     static fourcc const type;
 
+    // Scripts named in the cogs section are precompiled first, when the compiler has
+    // precompilation enabled.
+    virtual std::unique_ptr<asset> deserialize(input_stream &,
+                                               content_manager &,
+                                               asset_id,
+                                               service_registry const &) const override;
+
     virtual std::unique_ptr<asset> parse(text::tokenizer& t, content_manager& manager, service_registry const &) const override;
 
     virtual std::vector<path> const& get_prefixes() const override;
@@ -0,0 +1,242 @@
+#include "test/test.hpp"
+#include "libold/content/assets/model_mesh.hpp"
+#include "libold/content/assets/model_face_bvh.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::content::assets;
+
+namespace {
+
+    // Matches the padding applied by model_face_bvh.
+    float const face_bounds_margin = 0.001f;
+
+    class random_floats {
+    public:
+        uint32_t seed = 12345;
+
+        float next(float lo, float hi)
+        {
+            seed = seed * 1103515245 + 12345;
+            return lo + static_cast<float>((seed >> 8) % 10000) / 10000.0f * (hi - lo);
+        }
+
+        vector<3> next_vector(float lo, float hi)
+        {
+            float x = next(lo, hi);
+            float y = next(lo, hi);
+            float z = next(lo, hi);
+            return make_vector(x, y, z);
+        }
+    };
+
+    void add_face(model_mesh &mesh, std::vector<vector<3>> const &points)
+    {
+        model_face face;
+        for(auto const &point : points) {
+            face.vertices.emplace_back(mesh.vertices.size(), 0);
+            mesh.vertices.push_back(point);
+        }
+
+        mesh.faces.push_back(face);
+    }
+
+    // Small triangles scattered through a cube, and faces which are flat along each axis.
+    model_mesh make_mesh(size_t face_count)
+    {
+        model_mesh mesh;
+        random_floats rng;
+
+        for(size_t i = 0; i < face_count; ++i) {
+            auto center = rng.next_vector(-10.0f, 10.0f);
+            add_face(mesh, { center + rng.next_vector(-0.5f, 0.5f),
+                             center + rng.next_vector(-0.5f, 0.5f),
+                             center + rng.next_vector(-0.5f, 0.5f) });
+        }
+
+        add_face(mesh, { make_vector(1.0f, 1.0f, 2.0f), make_vector(2.0f, 1.0f, 2.0f), make_vector(2.0f, 2.0f, 2.0f) });
+        add_face(mesh, { make_vector(1.0f, 3.0f, 1.0f), make_vector(2.0f, 3.0f, 1.0f), make_vector(2.0f, 3.0f, 2.0f) });
+        add_face(mesh, { make_vector(4.0f, 1.0f, 1.0f), make_vector(4.0f, 2.0f, 1.0f), make_vector(4.0f, 2.0f, 2.0f) });
+
+        return mesh;
+    }
+
+    box<3> face_bounds(model_mesh const &mesh, model_face const &face)
+    {
+        auto v0 = mesh.vertices[std::get<0>(face.vertices.front())];
+        auto v1 = v0;
+        for(auto const &vx : face.vertices) {
+            auto const &v = mesh.vertices[std::get<0>(vx)];
+            for(size_t i = 0; i < 3; ++i) {
+                v0.begin()[i] = std::min(v0.begin()[i], v.begin()[i]);
+                v1.begin()[i] = std::max(v1.begin()[i], v.begin()[i]);
+            }
+        }
+
+        auto margin = make_vector(face_bounds_margin, face_bounds_margin, face_bounds_margin);
+        return make_box(v0 - margin, v1 + margin);
+    }
+
+    // Slab test over the segment parameter range [0, 1].
+    bool segment_overlaps(box<3> const &bounds, vector<3> const &p0, vector<3> const &p1)
+    {
+        auto dir = p1 - p0;
+        float t_min = 0.0f;
+        float t_max = 1.0f;
+        for(size_t i = 0; i < 3; ++i) {
+            float o = p0.begin()[i];
+            float d = dir.begin()[i];
+            float lo = bounds.v0.begin()[i];
+            float hi = bounds.v1.begin()[i];
+
+            if(std::fpclassify(d) == FP_ZERO) {
+                if(o < lo || o > hi) {
+                    return false;
+                }
+
+                continue;
+            }
+
+            float t0 = (lo - o) / d;
+            float t1 = (hi - o) / d;
+            t_min = std::max(t_min, std::min(t0, t1));
+            t_max = std::min(t_max, std::max(t0, t1));
+        }
+
+        return t_min <= t_max;
+    }
+
+    template <typename PredT>
+    std::vector<size_t> brute_force_faces(model_mesh const &mesh, PredT overlaps)
+    {
+        std::vector<size_t> rv;
+        for(size_t i = 0; i < mesh.faces.size(); ++i) {
+            if(overlaps(face_bounds(mesh, mesh.faces[i]))) {
+                rv.push_back(i);
+            }
+        }
+
+        return rv;
+    }
+
+    template <typename ...QueryT>
+    std::vector<size_t> visited_faces(model_face_bvh const &bvh, QueryT const &...query)
+    {
+        std::vector<size_t> rv;
+        bvh.visit_faces(query..., [&](size_t face) { rv.push_back(face); });
+        std::sort(rv.begin(), rv.end());
+        return rv;
+    }
+
+}
+
+begin_suite(model_face_bvh_test);
+
+test_case(empty_mesh)
+{
+    model_mesh mesh;
+    model_face_bvh bvh(mesh);
+
+    assert_true(bvh.nodes.empty());
+    assert_true(visited_faces(bvh, make_box(make_vector(-1.0f, -1.0f, -1.0f), make_vector(1.0f, 1.0f, 1.0f))).empty());
+    assert_true(visited_faces(bvh, make_vector(-1.0f, -1.0f, -1.0f), make_vector(1.0f, 1.0f, 1.0f)).empty());
+}
+
+test_case(tree_structure)
+{
+    auto mesh = make_mesh(200);
+    model_face_bvh bvh(mesh);
+
+    // Every face is listed once
+    auto faces = bvh.face_indices;
+    std::sort(faces.begin(), faces.end());
+    assert_eq(faces.size(), mesh.faces.size());
+    for(size_t i = 0; i < faces.size(); ++i) {
+        assert_eq(faces[i], i);
+    }
+
+    // Leaves are within the leaf limit and cover the face list, and children are inside
+    // their parents.
+    size_t leaf_faces = 0;
+    for(size_t i = 0; i < bvh.nodes.size(); ++i) {
+        auto const &n = bvh.nodes[i];
+        if(n.face_count > 0) {
+            assert_le(n.face_count, size_t(4));
+            leaf_faces += n.face_count;
+
+            for(size_t j = n.first_face; j < n.first_face + n.face_count; ++j) {
+                auto const &fb = bvh.leaf_face_bounds[j];
+                assert_true(n.bounds.contains(fb.v0) && n.bounds.contains(fb.v1));
+            }
+        }
+        else {
+            for(auto child : { i + 1, n.second_child }) {
+                auto const &cb = bvh.nodes[child].bounds;
+                assert_true(n.bounds.contains(cb.v0) && n.bounds.contains(cb.v1));
+            }
+        }
+    }
+
+    assert_eq(leaf_faces, mesh.faces.size());
+}
+
+test_case(box_query_matches_brute_force)
+{
+    auto mesh = make_mesh(200);
+    model_face_bvh bvh(mesh);
+    random_floats rng;
+
+    size_t visited = 0;
+    for(int i = 0; i < 200; ++i) {
+        auto center = rng.next_vector(-11.0f, 11.0f);
+        auto extent = rng.next_vector(0.0f, 3.0f);
+        auto query = make_box(center - extent, center + extent);
+
+        auto expected = brute_force_faces(mesh, [&](box<3> const &fb) { return fb.overlaps(query); });
+        auto actual = visited_faces(bvh, query);
+        assert_eq(actual, expected);
+        visited += actual.size();
+    }
+
+    assert_gt(visited, size_t(0));
+}
+
+test_case(segment_query_matches_brute_force)
+{
+    auto mesh = make_mesh(200);
+    model_face_bvh bvh(mesh);
+    random_floats rng;
+
+    std::vector<std::tuple<vector<3>, vector<3>>> segments;
+    for(int i = 0; i < 200; ++i) {
+        segments.emplace_back(rng.next_vector(-11.0f, 11.0f), rng.next_vector(-11.0f, 11.0f));
+    }
+
+    // Directions with zero components, through the flat faces and along their planes
+    segments.emplace_back(make_vector(1.5f, 1.5f, 5.0f), make_vector(1.5f, 1.5f, -5.0f));
+    segments.emplace_back(make_vector(1.5f, -5.0f, 1.5f), make_vector(1.5f, 5.0f, 1.5f));
+    segments.emplace_back(make_vector(5.0f, 1.5f, 1.5f), make_vector(-5.0f, 1.5f, 1.5f));
+    segments.emplace_back(make_vector(0.0f, 1.5f, 2.0f), make_vector(3.0f, 1.5f, 2.0f));
+    segments.emplace_back(make_vector(4.0f, 1.5f, 5.0f), make_vector(4.0f, 1.5f, -5.0f));
+    segments.emplace_back(make_vector(4.5f, 1.5f, 5.0f), make_vector(4.5f, 1.5f, -5.0f));
+
+    // Zero length
+    segments.emplace_back(make_vector(1.5f, 1.5f, 2.0f), make_vector(1.5f, 1.5f, 2.0f));
+
+    size_t visited = 0;
+    for(auto const &seg : segments) {
+        auto const &p0 = std::get<0>(seg);
+        auto const &p1 = std::get<1>(seg);
+
+        auto expected = brute_force_faces(mesh, [&](box<3> const &fb) { return segment_overlaps(fb, p0, p1); });
+        auto actual = visited_faces(bvh, p0, p1);
+        assert_eq(actual, expected);
+        visited += actual.size();
+    }
+
+    assert_gt(visited, size_t(0));
+}
+
+end_suite(model_face_bvh_test);
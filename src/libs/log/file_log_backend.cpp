@@ -15,6 +15,10 @@ void gorc::file_log_backend::write_message(std::string const &filename,
          << line_number << "|"
          << log_level_to_string(level) << "> "
          << message
-         << std::endl;
+         << "\n";
+}
+
+void gorc::file_log_backend::flush()
+{
     file.flush();
 }
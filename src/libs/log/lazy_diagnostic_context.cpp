@@ -0,0 +1,17 @@
+#include "log_frontend.hpp"
+#include "lazy_diagnostic_context.hpp"
+
+gorc::diagnostic_context_resolver::~diagnostic_context_resolver()
+{
+    return;
+}
+
+gorc::lazy_diagnostic_context::lazy_diagnostic_context(diagnostic_context_resolver const &resolver)
+{
+    diagnostic_context_handle = get_local<log_frontend>()->push_lazy_diagnostic_context(resolver);
+}
+
+gorc::lazy_diagnostic_context::~lazy_diagnostic_context()
+{
+    get_local<log_frontend>()->release_diagnostic_context(diagnostic_context_handle);
+}
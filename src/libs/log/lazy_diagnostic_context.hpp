@@ -0,0 +1,31 @@
+#pragma once
+
+#include "diagnostic_context_location.hpp"
+#include <cstddef>
+
+namespace gorc {
+
+    class diagnostic_context_resolver {
+    public:
+        virtual ~diagnostic_context_resolver();
+
+        virtual diagnostic_context_location get_diagnostic_context_location() const = 0;
+    };
+
+    // Diagnostic context whose location is only computed when a message is logged. The
+    // resolver must outlive the context.
+    class [[gnu::unused]] lazy_diagnostic_context {
+    private:
+        size_t diagnostic_context_handle = 0;
+
+    public:
+        explicit lazy_diagnostic_context(diagnostic_context_resolver const &resolver);
+        ~lazy_diagnostic_context();
+
+        lazy_diagnostic_context(lazy_diagnostic_context const &) = delete;
+        lazy_diagnostic_context(lazy_diagnostic_context&&) = delete;
+        lazy_diagnostic_context& operator=(lazy_diagnostic_context const &) = delete;
+        lazy_diagnostic_context& operator=(lazy_diagnostic_context&&) = delete;
+    };
+
+}
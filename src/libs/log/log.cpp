@@ -5,6 +5,21 @@ void gorc::erase_log_backends()
     get_global<log_midend>()->erase_log_backends();
 }
 
+void gorc::enable_async_logging(size_t capacity, log_overflow_policy policy)
+{
+    get_global<log_midend>()->enable_async_logging(capacity, policy);
+}
+
+void gorc::disable_async_logging()
+{
+    get_global<log_midend>()->disable_async_logging();
+}
+
+void gorc::flush_log_messages()
+{
+    get_global<log_midend>()->flush_log_messages();
+}
+
 void gorc::write_log_message(char const *file,
                              int line,
                              log_level level,
@@ -3,6 +3,7 @@
 #include "log_frontend.hpp"
 #include "log_midend.hpp"
 #include "log_backend.hpp"
+#include "log_capture.hpp"
 #include "utility/flag_set.hpp"
 #include "logged_runtime_error.hpp"
 #include <memory>
@@ -23,6 +24,31 @@ namespace gorc {
 
     void erase_log_backends();
 
+    void enable_async_logging(size_t capacity, log_overflow_policy policy);
+    void disable_async_logging();
+    void flush_log_messages();
+
+    // Returns false if a message at this level would be discarded. Errors and warnings are
+    // always written, because diagnostic contexts count them.
+    inline bool log_level_enabled(log_level level)
+    {
+        switch(level) {
+        case log_level::error:
+        case log_level::warning:
+            return true;
+
+#ifdef LOG_DISABLE_DEBUG
+        case log_level::debug:
+        case log_level::trace:
+            return false;
+#endif
+
+        default:
+            return detail::accepted_log_levels.load(std::memory_order_relaxed) &
+                   static_cast<int>(level);
+        }
+    }
+
     void write_log_message(char const *file,
                            int line,
                            log_level level,
@@ -35,8 +61,14 @@ namespace gorc {
 
 }
 
+// The message is only evaluated when its level is enabled. Define LOG_DISABLE_DEBUG to compile
+// out debug and trace messages.
 #define LOG_WITH_LEVEL(x, y) \
-    ::gorc::write_log_message(__FILE__, __LINE__, (x), (y))
+    do { \
+        if(::gorc::log_level_enabled(x)) { \
+            ::gorc::write_log_message(__FILE__, __LINE__, (x), (y)); \
+        } \
+    } while(false)
 
 #define LOG_ERROR(x) \
     LOG_WITH_LEVEL(::gorc::log_level::error, (x))
@@ -54,7 +86,7 @@ namespace gorc {
     LOG_WITH_LEVEL(::gorc::log_level::trace, (x))
 
 #define LOG_FATAL(x) \
-    LOG_ERROR(x); throw ::gorc::logged_runtime_error()
+    LOG_ERROR(x); ::gorc::flush_log_messages(); throw ::gorc::logged_runtime_error()
 
 #define LOG_FATAL_ASSERT(x, y) \
     do { if(!(x)) { LOG_FATAL(y); } } while(false)
@@ -4,3 +4,8 @@ gorc::log_backend::~log_backend()
 {
     return;
 }
+
+void gorc::log_backend::flush()
+{
+    return;
+}
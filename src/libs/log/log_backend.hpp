@@ -13,6 +13,9 @@ namespace gorc {
                                    int line_number,
                                    log_level level,
                                    std::string const &message) = 0;
+
+        // Called after each message, or after each batch of messages in async mode.
+        virtual void flush();
     };
 
 }
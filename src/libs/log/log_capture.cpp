@@ -0,0 +1,41 @@
+#include "log_capture.hpp"
+#include "log_frontend.hpp"
+
+gorc::captured_log_message::captured_log_message()
+    : line_number(0)
+    , level(log_level::info)
+{
+    return;
+}
+
+gorc::captured_log_message::captured_log_message(std::string const &filename,
+                                                 int line_number,
+                                                 log_level level,
+                                                 std::string const &message)
+    : filename(filename)
+    , line_number(line_number)
+    , level(level)
+    , message(message)
+{
+    return;
+}
+
+gorc::log_capture::log_capture()
+    : frontend(get_local<log_frontend>())
+    , previous_capture(frontend->capture)
+{
+    frontend->capture = &messages;
+}
+
+gorc::log_capture::~log_capture()
+{
+    frontend->capture = previous_capture;
+}
+
+void gorc::replay_log_messages(std::vector<captured_log_message> const &messages)
+{
+    auto frontend = get_local<log_frontend>();
+    for(auto const &msg : messages) {
+        frontend->replay_log_message(msg);
+    }
+}
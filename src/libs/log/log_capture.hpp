@@ -0,0 +1,50 @@
+#pragma once
+
+#include "log_level.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gorc {
+
+    class log_frontend;
+
+    class captured_log_message {
+    public:
+        std::string filename;
+        int line_number;
+        log_level level;
+        std::string message;
+
+        captured_log_message();
+        captured_log_message(std::string const &filename,
+                             int line_number,
+                             log_level level,
+                             std::string const &message);
+    };
+
+    // Collects the messages written by the current thread while the capture is alive, instead
+    // of writing them to the log backends. Messages are still counted against the current
+    // diagnostic context, and already include its preamble.
+    class [[gnu::unused]] log_capture {
+    private:
+        std::shared_ptr<log_frontend> frontend;
+        std::vector<captured_log_message> *previous_capture;
+
+    public:
+        std::vector<captured_log_message> messages;
+
+        log_capture();
+        ~log_capture();
+
+        log_capture(log_capture const &) = delete;
+        log_capture(log_capture&&) = delete;
+        log_capture& operator=(log_capture const &) = delete;
+        log_capture& operator=(log_capture&&) = delete;
+    };
+
+    // Writes captured messages to the log backends in order, counting them against the current
+    // diagnostic context of the calling thread.
+    void replay_log_messages(std::vector<captured_log_message> const &messages);
+
+}
@@ -1,4 +1,5 @@
 #include "log_frontend.hpp"
+#include "log_capture.hpp"
 #include <sstream>
 
 gorc::log_frontend::diagnostic_context_frame::diagnostic_context_frame(maybe<char const*> filename,
@@ -23,6 +24,20 @@ gorc::log_frontend::log_frontend()
     return;
 }
 
+gorc::diagnostic_context_location
+    gorc::log_frontend::location_of(diagnostic_context_frame const &frame) const
+{
+    if(frame.resolver) {
+        return frame.resolver->get_diagnostic_context_location();
+    }
+
+    return diagnostic_context_location(frame.filename,
+                                       frame.first_line,
+                                       frame.first_col,
+                                       frame.last_line,
+                                       frame.last_col);
+}
+
 void gorc::log_frontend::update_diagnostic_preamble()
 {
     diagnostic_preamble_dirty = false;
@@ -32,7 +47,7 @@ void gorc::log_frontend::update_diagnostic_preamble()
         return;
     }
 
-    auto const &context = diagnostic_context.back();
+    auto const context = location_of(diagnostic_context.back());
 
     std::stringstream ss;
     ss << gorc::maybe_if(context.filename, "<BUFFER>", [](char const *p) { return p; });
@@ -56,23 +71,52 @@ void gorc::log_frontend::update_diagnostic_preamble()
     computed_diagnostic_preamble = ss.str();
 }
 
+void gorc::log_frontend::count_log_message(log_level level)
+{
+    if(!diagnostic_context.empty()) {
+        auto &counts = diagnostic_context[diagnostic_context.back().error_count_index];
+        if(level == log_level::error) {
+            ++counts.internal_error_count;
+        }
+        else if(level == log_level::warning) {
+            ++counts.internal_warning_count;
+        }
+    }
+}
+
 void gorc::log_frontend::write_log_message(std::string const &filename,
                                            int line_number,
                                            log_level level,
                                            std::string const &message)
 {
-    if((level == log_level::error) &&
-       !diagnostic_context.empty()) {
-        ++diagnostic_context[diagnostic_context.back().error_count_index].internal_error_count;
-    }
+    count_log_message(level);
 
-    if(diagnostic_preamble_dirty) {
+    // Lazy contexts may have moved since the preamble was computed.
+    if(diagnostic_preamble_dirty ||
+       (!diagnostic_context.empty() && diagnostic_context.back().resolver)) {
         update_diagnostic_preamble();
     }
 
+    if(capture) {
+        capture->emplace_back(filename, line_number, level, computed_diagnostic_preamble + message);
+        return;
+    }
+
     midend->write_log_message(filename, line_number, level, computed_diagnostic_preamble + message);
 }
 
+void gorc::log_frontend::replay_log_message(captured_log_message const &msg)
+{
+    count_log_message(msg.level);
+
+    if(capture) {
+        capture->push_back(msg);
+        return;
+    }
+
+    midend->write_log_message(msg.filename, msg.line_number, msg.level, msg.message);
+}
+
 size_t gorc::log_frontend::push_diagnostic_context(maybe<char const *> filename,
                                                    int first_line,
                                                    int first_col,
@@ -84,7 +128,7 @@ size_t gorc::log_frontend::push_diagnostic_context(maybe<char const *> filename,
     size_t error_count_index = next_element;
     if(!filename.has_value() &&
        !diagnostic_context.empty()) {
-        filename = diagnostic_context.back().filename;
+        filename = location_of(diagnostic_context.back()).filename;
         error_count_index = diagnostic_context.back().error_count_index;
     }
 
@@ -99,6 +143,22 @@ size_t gorc::log_frontend::push_diagnostic_context(maybe<char const *> filename,
     return next_element;
 }
 
+size_t gorc::log_frontend::push_lazy_diagnostic_context(diagnostic_context_resolver const &resolver)
+{
+    size_t next_element = diagnostic_context.size();
+
+    diagnostic_context.emplace_back(nothing,
+                                    0,
+                                    0,
+                                    0,
+                                    0,
+                                    next_element);
+    diagnostic_context.back().resolver = &resolver;
+    diagnostic_preamble_dirty = true;
+
+    return next_element;
+}
+
 void gorc::log_frontend::release_diagnostic_context(size_t index)
 {
     if(index < diagnostic_context.size()) {
@@ -122,13 +182,22 @@ int gorc::log_frontend::diagnostic_file_error_count() const
     return 0;
 }
 
+int gorc::log_frontend::diagnostic_file_warning_count() const
+{
+    if(!diagnostic_context.empty()) {
+        return diagnostic_context[diagnostic_context.back().error_count_index].internal_warning_count;
+    }
+
+    return 0;
+}
+
 std::string gorc::log_frontend::diagnostic_file_name() const
 {
     if(diagnostic_context.empty()) {
         return "";
     }
 
-    auto const &context = diagnostic_context.back();
+    auto const context = location_of(diagnostic_context.back());
     return gorc::maybe_value(context.filename, "<BUFFER>");
 }
 
@@ -137,6 +206,11 @@ int gorc::diagnostic_file_error_count()
     return get_local<log_frontend>()->diagnostic_file_error_count();
 }
 
+int gorc::diagnostic_file_warning_count()
+{
+    return get_local<log_frontend>()->diagnostic_file_warning_count();
+}
+
 std::string gorc::diagnostic_file_name()
 {
     return get_local<log_frontend>()->diagnostic_file_name();
@@ -4,15 +4,20 @@
 #include "utility/local.hpp"
 #include "log_level.hpp"
 #include "diagnostic_context.hpp"
+#include "lazy_diagnostic_context.hpp"
 #include "utility/maybe.hpp"
 #include <memory>
 #include <stack>
 
 namespace gorc {
 
+    class captured_log_message;
+
     class log_frontend : public local {
         template <typename LocalT> friend class local_factory;
         friend class diagnostic_context;
+        friend class lazy_diagnostic_context;
+        friend class log_capture;
     private:
         class diagnostic_context_frame {
         public:
@@ -23,8 +28,12 @@ namespace gorc {
             int last_line;
             int last_col;
             int internal_error_count = 0;
+            int internal_warning_count = 0;
             size_t error_count_index;
 
+            // Location is computed on demand when set.
+            diagnostic_context_resolver const *resolver = nullptr;
+
             diagnostic_context_frame(maybe<char const *> filename,
                                      int first_line,
                                      int first_col,
@@ -37,9 +46,13 @@ namespace gorc {
         std::vector<diagnostic_context_frame> diagnostic_context;
         bool diagnostic_preamble_dirty = false;
         std::string computed_diagnostic_preamble;
+        std::vector<captured_log_message> *capture = nullptr;
 
         log_frontend();
 
+        void count_log_message(log_level level);
+
+        diagnostic_context_location location_of(diagnostic_context_frame const &) const;
         void update_diagnostic_preamble();
 
         size_t push_diagnostic_context(maybe<char const *> filename,
@@ -48,6 +61,8 @@ namespace gorc {
                                        int last_line,
                                        int last_col);
 
+        size_t push_lazy_diagnostic_context(diagnostic_context_resolver const &resolver);
+
         void release_diagnostic_context(size_t index);
 
     public:
@@ -56,10 +71,15 @@ namespace gorc {
                                log_level level,
                                std::string const &message);
 
+        // Writes a message captured on another thread, without adding a preamble.
+        void replay_log_message(captured_log_message const &message);
+
         int diagnostic_file_error_count() const;
+        int diagnostic_file_warning_count() const;
         std::string diagnostic_file_name() const;
     };
 
     int diagnostic_file_error_count();
+    int diagnostic_file_warning_count();
     std::string diagnostic_file_name();
 }
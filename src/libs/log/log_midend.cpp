@@ -1,21 +1,188 @@
 #include "log_midend.hpp"
+#include <boost/format.hpp>
+#include <unistd.h>
+
+std::atomic<int> gorc::detail::accepted_log_levels(0);
 
 gorc::log_midend::log_midend()
+    : writer_running(false)
+    , writer_waiting(false)
+    , pushed_messages(0)
+    , dropped_messages(0)
 {
     return;
 }
 
+gorc::log_midend::~log_midend()
+{
+    disable_async_logging();
+}
+
 void gorc::log_midend::insert_log_backend(flag_set<log_level> filter,
                                           std::unique_ptr<log_backend>&& b)
 {
     std::lock_guard<std::mutex> lock(log_backend_lock);
     log_backends.emplace_back(filter, std::move(b));
+    detail::accepted_log_levels.fetch_or(static_cast<int>(filter),
+                                         std::memory_order_relaxed);
 }
 
 void gorc::log_midend::erase_log_backends()
 {
+    // Queued messages belong to the backends being erased.
+    flush_log_messages();
+
     std::lock_guard<std::mutex> lock(log_backend_lock);
     log_backends.clear();
+    detail::accepted_log_levels.store(0, std::memory_order_relaxed);
+}
+
+void gorc::log_midend::enable_async_logging(size_t capacity, log_overflow_policy policy)
+{
+    disable_async_logging();
+
+    async_buffer = std::make_unique<log_ring_buffer>(capacity);
+    overflow_policy = policy;
+    writer_running = true;
+    writer_process = ::getpid();
+    writer_thread = std::make_unique<std::thread>([this] { run_writer(); });
+}
+
+bool gorc::log_midend::owns_writer() const
+{
+    return writer_thread && writer_process == ::getpid();
+}
+
+void gorc::log_midend::disable_async_logging()
+{
+    if(!writer_thread) {
+        return;
+    }
+
+    if(!owns_writer()) {
+        // Forked child. The writer thread only exists in the parent, and writer_lock may have
+        // been held when the process was forked. Leak the thread handle: destroying a
+        // joinable thread terminates the process.
+        writer_thread.release();
+        async_buffer.reset();
+        return;
+    }
+
+    // The writer drains the buffer before it stops.
+    {
+        std::lock_guard<std::mutex> lock(writer_lock);
+        writer_running = false;
+    }
+
+    writer_wake.notify_one();
+    writer_thread->join();
+    writer_thread.reset();
+    async_buffer.reset();
+}
+
+void gorc::log_midend::flush_log_messages()
+{
+    if(!async_buffer || !owns_writer()) {
+        return;
+    }
+
+    size_t target = pushed_messages.load();
+
+    std::unique_lock<std::mutex> lock(writer_lock);
+    writer_idle.wait(lock, [&] { return written_messages >= target; });
+}
+
+void gorc::log_midend::write_to_backends(captured_log_message const &msg)
+{
+    for(auto &b : log_backends) {
+        if(std::get<0>(b) & msg.level) {
+            std::get<1>(b)->write_message(msg.filename, msg.line_number, msg.level, msg.message);
+        }
+    }
+}
+
+void gorc::log_midend::flush_backends()
+{
+    for(auto &b : log_backends) {
+        std::get<1>(b)->flush();
+    }
+}
+
+void gorc::log_midend::wake_writer()
+{
+    // The writer sets writer_waiting before it checks for work under writer_lock. Either it
+    // sees the new work, or it is waiting by the time the lock is acquired here.
+    if(writer_waiting.load()) {
+        std::lock_guard<std::mutex> lock(writer_lock);
+        writer_wake.notify_one();
+    }
+}
+
+void gorc::log_midend::run_writer()
+{
+    std::vector<captured_log_message> batch;
+    captured_log_message msg;
+
+    while(true) {
+        while(batch.size() < async_buffer->capacity() && async_buffer->try_pop(msg)) {
+            batch.push_back(std::move(msg));
+        }
+
+        if(!batch.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(writer_lock);
+                popped_messages += batch.size();
+            }
+
+            buffer_space.notify_all();
+        }
+
+        size_t dropped = dropped_messages.exchange(0);
+
+        if(batch.empty() && dropped == 0) {
+            std::unique_lock<std::mutex> lock(writer_lock);
+            if(!writer_running) {
+                return;
+            }
+
+            // A message is counted as pushed after it enters the buffer, so the writer may
+            // have popped it before it was counted.
+            writer_waiting = true;
+            writer_wake.wait(lock, [&] {
+                    return pushed_messages.load() > popped_messages ||
+                           dropped_messages.load() != 0 ||
+                           !writer_running;
+                });
+            writer_waiting = false;
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(log_backend_lock);
+            for(auto const &em : batch) {
+                write_to_backends(em);
+            }
+
+            if(dropped > 0) {
+                write_to_backends(captured_log_message(
+                        __FILE__,
+                        __LINE__,
+                        log_level::warning,
+                        boost::str(boost::format("log buffer full: %d messages were dropped") %
+                                   dropped)));
+            }
+
+            flush_backends();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(writer_lock);
+            written_messages += batch.size();
+        }
+
+        writer_idle.notify_all();
+        batch.clear();
+    }
 }
 
 void gorc::log_midend::write_log_message(std::string const &filename,
@@ -23,11 +190,35 @@ void gorc::log_midend::write_log_message(std::string const &filename,
                                          log_level level,
                                          std::string const &message)
 {
+    if(async_buffer) {
+        captured_log_message msg(filename, line_number, level, message);
+        if(!async_buffer->try_push(msg)) {
+            if(overflow_policy == log_overflow_policy::drop) {
+                dropped_messages.fetch_add(1);
+                wake_writer();
+                return;
+            }
+
+            // The writer counts popped messages under writer_lock, so a push which fails
+            // under the lock is retried after the writer has made room.
+            std::unique_lock<std::mutex> lock(writer_lock);
+            while(!async_buffer->try_push(msg)) {
+                size_t popped = popped_messages;
+                buffer_space.wait(lock, [&] { return popped_messages != popped; });
+            }
+        }
+
+        pushed_messages.fetch_add(1);
+        wake_writer();
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(log_backend_lock);
 
     for(auto &b : log_backends) {
         if(std::get<0>(b) & level) {
             std::get<1>(b)->write_message(filename, line_number, level, message);
+            std::get<1>(b)->flush();
         }
     }
 }
@@ -1,27 +1,84 @@
 #pragma once
 
 #include "log_backend.hpp"
+#include "log_ring_buffer.hpp"
 #include "utility/global.hpp"
 #include "utility/flag_set.hpp"
 #include "log_level.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 #include <tuple>
+#include <sys/types.h>
 
 namespace gorc {
 
+    namespace detail {
+        // Union of the log backend filters. Written by the midend, read without locking.
+        extern std::atomic<int> accepted_log_levels;
+    }
+
+    // Behavior of an asynchronous log when its buffer is full.
+    enum class log_overflow_policy {
+        // Wait for the writer thread to make room
+        block,
+
+        // Discard the message. The number of discarded messages is logged later.
+        drop
+    };
+
     class log_midend : public global {
         template <typename GlobalT> friend class global_factory;
     private:
         std::vector<std::tuple<flag_set<log_level>, std::unique_ptr<log_backend>>> log_backends;
         std::mutex log_backend_lock;
 
+        // Asynchronous mode state. Messages are written by writer_thread.
+        std::unique_ptr<log_ring_buffer> async_buffer;
+        log_overflow_policy overflow_policy = log_overflow_policy::block;
+        std::unique_ptr<std::thread> writer_thread;
+        ::pid_t writer_process = 0;
+        std::atomic<bool> writer_running;
+        std::atomic<bool> writer_waiting;
+        std::atomic<size_t> pushed_messages;
+        std::atomic<size_t> dropped_messages;
+
+        // Guarded by writer_lock
+        size_t popped_messages = 0;
+        size_t written_messages = 0;
+
+        std::mutex writer_lock;
+        std::condition_variable writer_wake;
+        std::condition_variable writer_idle;
+        std::condition_variable buffer_space;
+
         log_midend();
 
+        void write_to_backends(captured_log_message const &msg);
+        void flush_backends();
+        void wake_writer();
+        void run_writer();
+        bool owns_writer() const;
+
     public:
+        ~log_midend();
+
         void insert_log_backend(flag_set<log_level>, std::unique_ptr<log_backend>&&);
         void erase_log_backends();
 
+        // Messages are queued and written by a background thread until async logging is
+        // disabled. Do not change modes while other threads are logging. A forked child does
+        // not inherit the writer thread: disabling async logging there abandons the writer
+        // without waiting for it.
+        void enable_async_logging(size_t capacity, log_overflow_policy policy);
+        void disable_async_logging();
+
+        // Blocks until every queued message has been written.
+        void flush_log_messages();
+
         void write_log_message(std::string const &filename,
                                int line_number,
                                log_level level,
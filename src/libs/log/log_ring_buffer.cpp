@@ -0,0 +1,68 @@
+#include "log_ring_buffer.hpp"
+#include <cstddef>
+
+gorc::log_ring_buffer::log_ring_buffer(size_t requested_capacity)
+    : push_index(0)
+{
+    // A single cell cannot distinguish a full buffer from an empty one.
+    size_t actual_capacity = 2;
+    while(actual_capacity < requested_capacity) {
+        actual_capacity <<= 1;
+    }
+
+    cells = std::make_unique<cell[]>(actual_capacity);
+    index_mask = actual_capacity - 1;
+
+    // A cell is ready for the push at index i when its sequence is i, and ready for the pop at
+    // index i when its sequence is i + 1.
+    for(size_t i = 0; i < actual_capacity; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+size_t gorc::log_ring_buffer::capacity() const
+{
+    return index_mask + 1;
+}
+
+bool gorc::log_ring_buffer::try_push(captured_log_message &record)
+{
+    size_t index = push_index.load(std::memory_order_relaxed);
+    cell *target;
+
+    while(true) {
+        target = &cells[index & index_mask];
+        size_t sequence = target->sequence.load(std::memory_order_acquire);
+        auto distance = static_cast<std::ptrdiff_t>(sequence - index);
+
+        if(distance == 0) {
+            if(push_index.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if(distance < 0) {
+            // The consumer has not yet released this cell.
+            return false;
+        }
+        else {
+            index = push_index.load(std::memory_order_relaxed);
+        }
+    }
+
+    target->record = std::move(record);
+    target->sequence.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+bool gorc::log_ring_buffer::try_pop(captured_log_message &record)
+{
+    cell &target = cells[pop_index & index_mask];
+    if(target.sequence.load(std::memory_order_acquire) != pop_index + 1) {
+        return false;
+    }
+
+    record = std::move(target.record);
+    target.sequence.store(pop_index + index_mask + 1, std::memory_order_release);
+    ++pop_index;
+    return true;
+}
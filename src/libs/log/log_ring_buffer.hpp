@@ -0,0 +1,35 @@
+#pragma once
+
+#include "log_capture.hpp"
+#include <atomic>
+#include <memory>
+
+namespace gorc {
+
+    // Bounded lock-free queue of log records. Any number of threads may push, but only one
+    // thread may pop.
+    class log_ring_buffer {
+    private:
+        class cell {
+        public:
+            std::atomic<size_t> sequence;
+            captured_log_message record;
+        };
+
+        std::unique_ptr<cell[]> cells;
+        size_t index_mask;
+        std::atomic<size_t> push_index;
+        size_t pop_index = 0;
+
+    public:
+        // Capacity is rounded up to a power of two, and is at least 2.
+        explicit log_ring_buffer(size_t capacity);
+
+        size_t capacity() const;
+
+        // Returns false without consuming the record if the buffer is full.
+        bool try_push(captured_log_message &record);
+        bool try_pop(captured_log_message &record);
+    };
+
+}
@@ -32,5 +32,10 @@ void gorc::stdio_log_backend::write_message(std::string const & /*filename*/,
         break;
     }
 
-    std::cerr << wrapped(tag, message, wrap_width) << std::endl;
+    std::cerr << wrapped(tag, message, wrap_width) << "\n";
+}
+
+void gorc::stdio_log_backend::flush()
+{
+    std::cerr.flush();
 }
@@ -15,5 +15,7 @@ namespace gorc {
                                    int line_number,
                                    log_level level,
                                    std::string const &message) override;
+
+        virtual void flush() override;
     };
 }
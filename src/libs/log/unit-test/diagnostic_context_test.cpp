@@ -4,6 +4,18 @@
 
 using namespace gorc;
 
+namespace {
+    class mock_resolver : public diagnostic_context_resolver {
+    public:
+        diagnostic_context_location location;
+
+        virtual diagnostic_context_location get_diagnostic_context_location() const override
+        {
+            return location;
+        }
+    };
+}
+
 begin_suite(diagnostic_context_test);
 
 test_case(filename_only)
@@ -179,6 +191,26 @@ test_case(error_count_includes_errors_only)
     assert_eq(gorc::diagnostic_file_error_count(), 1);
 }
 
+test_case(warning_count_includes_warnings_only)
+{
+    gorc::diagnostic_context dc("foo");
+
+    LOG_INFO("foo");
+    LOG_ERROR("foo");
+
+    assert_eq(gorc::diagnostic_file_warning_count(), 0);
+
+    LOG_WARNING("foo");
+
+    do {
+        gorc::diagnostic_context dd(gorc::nothing, 5, 10);
+        LOG_WARNING("bar");
+    } while(false);
+
+    assert_eq(gorc::diagnostic_file_warning_count(), 2);
+    assert_eq(gorc::diagnostic_file_error_count(), 1);
+}
+
 test_case(error_count_excludes_child)
 {
     gorc::diagnostic_context dc("foo");
@@ -303,4 +335,30 @@ test_case(diagnostic_file_name_nested)
     assert_eq(gorc::diagnostic_file_name(), std::string("foobarbaz"));
 }
 
+test_case(lazy_context)
+{
+    mock_resolver resolver;
+    resolver.location = diagnostic_context_location("foo.cog", 5, 10);
+
+    lazy_diagnostic_context dc(resolver);
+
+    LOG_ERROR("first message");
+    assert_log_message(log_level::error, "foo.cog:5:10: first message");
+
+    resolver.location = diagnostic_context_location("bar.cog", 6, 2, 6, 9);
+
+    LOG_ERROR("second message");
+    assert_log_message(log_level::error, "bar.cog:6:2-6:9: second message");
+    assert_eq(gorc::diagnostic_file_name(), std::string("bar.cog"));
+    assert_eq(gorc::diagnostic_file_error_count(), 2);
+
+    {
+        diagnostic_context ec(nothing, 12);
+        LOG_ERROR("nested message");
+        assert_log_message(log_level::error, "bar.cog:12: nested message");
+    }
+
+    assert_log_empty();
+}
+
 end_suite(diagnostic_context_test);
@@ -0,0 +1,139 @@
+#include "test/test.hpp"
+#include "log/log.hpp"
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace gorc;
+
+begin_suite(log_async_test);
+
+test_case(messages_written_in_order)
+{
+    enable_async_logging(4, log_overflow_policy::block);
+
+    for(int i = 0; i < 10; ++i) {
+        LOG_INFO(format("message %d") % i);
+    }
+
+    flush_log_messages();
+    disable_async_logging();
+
+    for(int i = 0; i < 10; ++i) {
+        assert_log_message(log_level::info, str(format("message %d") % i));
+    }
+
+    assert_log_empty();
+}
+
+test_case(block_preserves_per_thread_order)
+{
+    int const num_threads = 4;
+    int const num_messages = 500;
+
+    enable_async_logging(16, log_overflow_policy::block);
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([i, num_messages] {
+                for(int j = 0; j < num_messages; ++j) {
+                    LOG_INFO(format("%d %d") % i % j);
+                }
+            });
+    }
+
+    for(auto &thread : threads) {
+        thread.join();
+    }
+
+    flush_log_messages();
+
+    std::vector<int> next_message(num_threads, 0);
+    while(!log_message_queue.empty()) {
+        std::stringstream ss(std::get<1>(log_message_queue.front()));
+        log_message_queue.pop();
+
+        int thread_index, message_index;
+        ss >> thread_index >> message_index;
+        assert_eq(message_index, next_message.at(static_cast<size_t>(thread_index))++);
+    }
+
+    for(int count : next_message) {
+        assert_eq(count, num_messages);
+    }
+
+    disable_async_logging();
+}
+
+test_case(drop_reports_dropped_messages)
+{
+    enable_async_logging(1, log_overflow_policy::drop);
+
+    for(int i = 0; i < 1000; ++i) {
+        LOG_INFO("message");
+    }
+
+    disable_async_logging();
+
+    // Dropped messages are counted in a final warning
+    int written = 0;
+    int dropped = 0;
+    while(!log_message_queue.empty()) {
+        auto const &msg = log_message_queue.front();
+        if(std::get<0>(msg) == log_level::info) {
+            ++written;
+        }
+        else {
+            std::stringstream ss(std::get<1>(msg));
+            std::string prefix;
+            int count;
+            ss >> prefix >> prefix >> prefix >> count;
+            dropped += count;
+        }
+
+        log_message_queue.pop();
+    }
+
+    assert_eq(written + dropped, 1000);
+}
+
+test_case(erase_backends_flushes)
+{
+    enable_async_logging(4, log_overflow_policy::block);
+
+    LOG_INFO("message");
+    erase_log_backends();
+    assert_log_message(log_level::info, "message");
+    assert_log_empty();
+
+    disable_async_logging();
+}
+
+test_case(forked_child_does_not_wait_for_writer)
+{
+    enable_async_logging(4, log_overflow_policy::block);
+
+    ::pid_t child = ::fork();
+    if(child == 0) {
+        // Killed if it waits for the parent's writer thread
+        ::alarm(10);
+        flush_log_messages();
+        disable_async_logging();
+        ::_exit(0);
+    }
+
+    int status = 0;
+    assert_eq(::waitpid(child, &status, 0), child);
+    assert_true(WIFEXITED(status));
+    assert_eq(WEXITSTATUS(status), 0);
+
+    LOG_INFO("message");
+    disable_async_logging();
+    assert_log_message(log_level::info, "message");
+    assert_log_empty();
+}
+
+end_suite(log_async_test);
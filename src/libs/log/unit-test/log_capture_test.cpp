@@ -0,0 +1,102 @@
+#include "test/test.hpp"
+#include "log/log.hpp"
+#include <thread>
+
+using namespace gorc;
+
+begin_suite(log_capture_test);
+
+test_case(capture_withholds_messages)
+{
+    std::vector<captured_log_message> messages;
+
+    {
+        diagnostic_context dc("foo.cog", 5);
+        log_capture capture;
+
+        LOG_WARNING("first message");
+        LOG_ERROR("second message");
+
+        assert_eq(diagnostic_file_warning_count(), 1);
+        assert_eq(diagnostic_file_error_count(), 1);
+
+        messages = capture.messages;
+    }
+
+    assert_log_empty();
+
+    LOG_INFO("unrelated");
+    replay_log_messages(messages);
+
+    assert_log_message(log_level::info, "unrelated");
+    assert_log_message(log_level::warning, "foo.cog:5: first message");
+    assert_log_message(log_level::error, "foo.cog:5: second message");
+    assert_log_empty();
+}
+
+test_case(replay_counts_messages)
+{
+    std::vector<captured_log_message> messages;
+
+    {
+        log_capture capture;
+        LOG_WARNING("first message");
+        LOG_ERROR("second message");
+        LOG_ERROR("third message");
+        messages = capture.messages;
+    }
+
+    diagnostic_context dc("bar.cog");
+    replay_log_messages(messages);
+
+    assert_eq(diagnostic_file_warning_count(), 1);
+    assert_eq(diagnostic_file_error_count(), 2);
+
+    assert_log_message(log_level::warning, "first message");
+    assert_log_message(log_level::error, "second message");
+    assert_log_message(log_level::error, "third message");
+    assert_log_empty();
+}
+
+test_case(nested_capture)
+{
+    log_capture outer;
+    std::vector<captured_log_message> messages;
+
+    {
+        log_capture inner;
+        LOG_ERROR("inner message");
+        messages = inner.messages;
+    }
+
+    replay_log_messages(messages);
+    LOG_ERROR("outer message");
+
+    assert_log_empty();
+    assert_eq(outer.messages.size(), size_t(2));
+    assert_eq(outer.messages[0].message, std::string("inner message"));
+    assert_eq(outer.messages[1].message, std::string("outer message"));
+}
+
+test_case(capture_is_per_thread)
+{
+    std::vector<captured_log_message> messages;
+
+    auto thread_proc = [&messages]() {
+        diagnostic_context dc("foo.cog");
+        log_capture capture;
+        LOG_ERROR("worker message");
+        messages = capture.messages;
+    };
+
+    log_capture capture;
+
+    std::thread th(thread_proc);
+    th.join();
+
+    assert_true(capture.messages.empty());
+    assert_eq(messages.size(), size_t(1));
+    assert_eq(messages[0].message, std::string("foo.cog: worker message"));
+}
+
+end_suite(log_capture_test);
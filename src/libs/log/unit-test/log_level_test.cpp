@@ -1,5 +1,5 @@
 #include "test/test.hpp"
-#include "log/log_level.hpp"
+#include "log/log.hpp"
 
 begin_suite(log_level_test);
 
@@ -24,4 +24,40 @@ test_case(log_level_to_string_return_values)
               std::string("trace"));
 }
 
+test_case(log_level_enabled_follows_backends)
+{
+    // The test fixture backend accepts errors, warnings and info
+    assert_true(gorc::log_level_enabled(gorc::log_level::error));
+    assert_true(gorc::log_level_enabled(gorc::log_level::info));
+    assert_true(!gorc::log_level_enabled(gorc::log_level::debug));
+    assert_true(!gorc::log_level_enabled(gorc::log_level::trace));
+}
+
+test_case(errors_and_warnings_always_enabled)
+{
+    gorc::erase_log_backends();
+
+    assert_true(gorc::log_level_enabled(gorc::log_level::error));
+    assert_true(gorc::log_level_enabled(gorc::log_level::warning));
+    assert_true(!gorc::log_level_enabled(gorc::log_level::info));
+}
+
+test_case(disabled_message_not_evaluated)
+{
+    int evaluated = 0;
+    auto make_message = [&] {
+        ++evaluated;
+        return std::string("message");
+    };
+
+    LOG_DEBUG(make_message());
+    LOG_TRACE(make_message());
+    assert_eq(evaluated, 0);
+
+    LOG_INFO(make_message());
+    assert_eq(evaluated, 1);
+    assert_log_message(gorc::log_level::info, "message");
+    assert_log_empty();
+}
+
 end_suite(log_level_test);
@@ -6,6 +6,10 @@
 
 #include <limits>
 
+namespace {
+    constexpr size_t async_log_capacity = 4096;
+}
+
 gorc::program::program()
 {
     // Initialize logging
@@ -38,6 +42,15 @@ gorc::program::program()
             // the same log file.
             set_environment_variable("GORC_LOG_FILE", "");
         });
+
+    // Write log messages from a background thread. When the buffer is full, messages are
+    // dropped if the variable is 'drop', or logging threads wait for space otherwise.
+    maybe<std::string> maybe_async_log = get_environment_variable("GORC_ASYNC_LOG");
+    maybe_if(maybe_async_log, [](std::string const &policy) {
+            enable_async_logging(async_log_capacity,
+                                 (policy == "drop") ? log_overflow_policy::drop :
+                                                      log_overflow_policy::block);
+        });
 }
 
 int gorc::program::start(range<char**> const &args)
@@ -117,7 +117,9 @@ void gorc::process::internal_inside_child(path const &executable,
     std::cerr << "[ERROR] Cannot execute: "
               << std::generic_category().message(errno)
               << std::endl;
-    exit(126);
+
+    // Skip exit handlers and global destructors. They belong to the parent process.
+    ::_exit(126);
 }
 // LCOV_EXCL_STOP
 
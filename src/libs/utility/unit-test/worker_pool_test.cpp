@@ -0,0 +1,91 @@
+#include "test/test.hpp"
+#include "utility/worker_pool.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+begin_suite(worker_pool_test);
+
+test_case(runs_all_jobs)
+{
+    gorc::worker_pool pool(4);
+    assert_eq(pool.concurrency(), size_t(4));
+
+    std::vector<int> results(100, 0);
+    std::vector<std::function<void()>> jobs;
+    for(size_t i = 0; i < results.size(); ++i) {
+        jobs.push_back([&results, i] { results[i] = static_cast<int>(i) * 2; });
+    }
+
+    for(int batch = 0; batch < 10; ++batch) {
+        pool.run(jobs);
+    }
+
+    for(size_t i = 0; i < results.size(); ++i) {
+        assert_eq(results[i], static_cast<int>(i) * 2);
+    }
+}
+
+test_case(serial_pool)
+{
+    gorc::worker_pool pool(1);
+    assert_eq(pool.concurrency(), size_t(1));
+
+    std::vector<int> order;
+    pool.run({ [&] { order.push_back(1); },
+               [&] { order.push_back(2); },
+               [&] { order.push_back(3); } });
+
+    assert_eq(order, (std::vector<int> { 1, 2, 3 }));
+}
+
+test_case(empty_batch)
+{
+    gorc::worker_pool pool(2);
+    pool.run({ });
+}
+
+test_case(nested_batch)
+{
+    gorc::worker_pool pool(4);
+    std::atomic<int> count(0);
+
+    std::vector<std::function<void()>> inner_jobs;
+    for(int i = 0; i < 4; ++i) {
+        inner_jobs.push_back([&count] { ++count; });
+    }
+
+    std::vector<std::function<void()>> jobs;
+    for(int i = 0; i < 4; ++i) {
+        jobs.push_back([&] { pool.run(inner_jobs); });
+    }
+
+    pool.run(jobs);
+    assert_eq(count.load(), 16);
+}
+
+test_case(rethrows_exception)
+{
+    gorc::worker_pool pool(3);
+    std::atomic<int> count(0);
+
+    std::vector<std::function<void()>> jobs;
+    for(int i = 0; i < 8; ++i) {
+        jobs.push_back([&count, i] {
+                ++count;
+                if(i == 5) {
+                    throw std::runtime_error("job failed");
+                }
+            });
+    }
+
+    assert_throws(pool.run(jobs), std::runtime_error, "job failed");
+    assert_eq(count.load(), 8);
+
+    // Pool remains usable after a failed batch
+    count = 0;
+    pool.run({ [&] { ++count; }, [&] { ++count; } });
+    assert_eq(count.load(), 2);
+}
+
+end_suite(worker_pool_test);
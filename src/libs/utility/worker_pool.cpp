@@ -0,0 +1,142 @@
+#include "worker_pool.hpp"
+#include <algorithm>
+
+namespace {
+    // Pool whose batch the current thread is running jobs from.
+    thread_local gorc::worker_pool const *running_pool = nullptr;
+}
+
+gorc::worker_pool::worker_pool(size_t concurrency)
+    : next_job(0)
+{
+    if(concurrency == 0) {
+        concurrency = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+    }
+
+    for(size_t i = 1; i < concurrency; ++i) {
+        threads.emplace_back([this] { worker_main(); });
+    }
+}
+
+gorc::worker_pool::~worker_pool()
+{
+    {
+        std::lock_guard<std::mutex> lg(batch_lock);
+        stopping = true;
+    }
+
+    batch_started.notify_all();
+    for(auto &thread : threads) {
+        thread.join();
+    }
+}
+
+size_t gorc::worker_pool::concurrency() const
+{
+    return threads.size() + 1;
+}
+
+void gorc::worker_pool::run_jobs(std::vector<std::function<void()>> const &batch)
+{
+    auto previous_pool = running_pool;
+    running_pool = this;
+
+    size_t completed = 0;
+    while(true) {
+        size_t job = next_job++;
+        if(job >= batch.size()) {
+            break;
+        }
+
+        try {
+            batch[job]();
+        }
+        catch(...) {
+            std::lock_guard<std::mutex> lg(batch_lock);
+            if(!first_exception) {
+                first_exception = std::current_exception();
+            }
+        }
+
+        ++completed;
+    }
+
+    running_pool = previous_pool;
+
+    if(completed > 0) {
+        std::lock_guard<std::mutex> lg(batch_lock);
+        remaining_jobs -= completed;
+    }
+}
+
+void gorc::worker_pool::worker_main()
+{
+    size_t seen_generation = 0;
+    while(true) {
+        std::vector<std::function<void()>> const *batch = nullptr;
+
+        {
+            std::unique_lock<std::mutex> ul(batch_lock);
+            batch_started.wait(ul, [&] {
+                    return stopping || (current_batch && generation != seen_generation);
+                });
+
+            if(stopping) {
+                return;
+            }
+
+            seen_generation = generation;
+            batch = current_batch;
+            ++active_workers;
+        }
+
+        run_jobs(*batch);
+
+        {
+            std::lock_guard<std::mutex> lg(batch_lock);
+            --active_workers;
+        }
+
+        batch_finished.notify_all();
+    }
+}
+
+void gorc::worker_pool::run(std::vector<std::function<void()>> const &jobs)
+{
+    if(jobs.empty()) {
+        return;
+    }
+
+    if(threads.empty() || jobs.size() == 1 || running_pool == this) {
+        for(auto const &job : jobs) {
+            job();
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(batch_lock);
+        current_batch = &jobs;
+        next_job = 0;
+        remaining_jobs = jobs.size();
+        first_exception = nullptr;
+        ++generation;
+    }
+
+    batch_started.notify_all();
+    run_jobs(jobs);
+
+    std::exception_ptr ex;
+
+    {
+        std::unique_lock<std::mutex> ul(batch_lock);
+        batch_finished.wait(ul, [&] { return remaining_jobs == 0 && active_workers == 0; });
+        current_batch = nullptr;
+        std::swap(ex, first_exception);
+    }
+
+    if(ex) {
+        std::rethrow_exception(ex);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "uncopyable.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gorc {
+
+    // Fixed set of worker threads which execute batches of independent jobs. The calling
+    // thread participates in each batch, so a pool with zero workers runs jobs serially.
+    class worker_pool : private uncopyable {
+    private:
+        std::vector<std::thread> threads;
+
+        std::mutex batch_lock;
+        std::condition_variable batch_started;
+        std::condition_variable batch_finished;
+
+        std::vector<std::function<void()>> const *current_batch = nullptr;
+        std::atomic<size_t> next_job;
+        size_t remaining_jobs = 0;
+        size_t active_workers = 0;
+        size_t generation = 0;
+        bool stopping = false;
+        std::exception_ptr first_exception;
+
+        void worker_main();
+        void run_jobs(std::vector<std::function<void()>> const &batch);
+
+    public:
+        // Creates one fewer worker than the requested concurrency. Zero selects the
+        // hardware concurrency.
+        explicit worker_pool(size_t concurrency = 0);
+        virtual ~worker_pool();
+
+        size_t concurrency() const;
+
+        // Runs every job and blocks until all have completed. The first exception thrown by
+        // a job is rethrown on the calling thread. A job may call run on the same pool; the
+        // nested batch runs on the job's thread.
+        void run(std::vector<std::function<void()>> const &jobs);
+    };
+
+}
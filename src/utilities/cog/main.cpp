@@ -1,6 +1,7 @@
 #include "program/program.hpp"
 #include "jk/cog/compiler/compiler.hpp"
 #include "jk/cog/compiler/script_loader.hpp"
+#include "jk/cog/compiler/script_cache.hpp"
 #include "io/native_file.hpp"
 #include "jk/cog/vm/executor.hpp"
 #include "jk/cog/vm/default_verbs.hpp"
@@ -75,7 +76,13 @@ namespace gorc {
         service_registry services;
 
         std::string scenario_file;
+        std::string cache_directory;
+        bool no_fused_tier = false;
+        int fused_tier_threshold = cog::default_fused_tier_threshold;
+        size_t precompile_threads = 0;
+        bool profile = false;
         cog::verb_table verbs;
+        cog::profiler profiler;
 
         std::unique_ptr<cog_scenario_state> state;
 
@@ -85,6 +92,13 @@ namespace gorc {
         virtual void create_options(options &opts) override
         {
             opts.insert(make_value_option("scenario", scenario_file));
+            opts.insert(make_value_option("cog-cache", cache_directory));
+            opts.insert(make_switch_option("no-fused-tier", no_fused_tier));
+            opts.insert(make_value_option("fused-tier-threshold",
+                                          fused_tier_threshold,
+                                          cog::default_fused_tier_threshold));
+            opts.insert(make_value_option("precompile-threads", precompile_threads, size_t(0)));
+            opts.insert(make_switch_option("profile", profile));
             opts.emplace_constraint<required_option>("scenario");
         }
 
@@ -102,8 +116,15 @@ namespace gorc {
             services.add(loaders);
 
             cog::compiler compiler(verbs, constants);
+            compiler.set_precompile_threads(precompile_threads);
             services.add(compiler);
 
+            std::unique_ptr<cog::script_cache> cache;
+            if(!cache_directory.empty()) {
+                cache = std::make_unique<cog::script_cache>(cache_directory);
+                compiler.set_cache(cache.get());
+            }
+
             native_file_system vfs;
             services.add<virtual_file_system>(vfs);
 
@@ -116,8 +137,13 @@ namespace gorc {
             cog_scenario_value_mapping val_map(scenario);
             services.add<cog::default_value_mapping>(val_map);
 
+            if(precompile_threads > 0) {
+                precompile_scripts(compiler, vfs, loaders, scenario);
+            }
+
             // Construct instances:
             state = std::make_unique<cog_scenario_state>(scenario, services);
+            configure_executor(*state->executor);
 
             // Execute startup messages:
             state->executor->send_to_all(cog::message_type::startup,
@@ -133,6 +159,10 @@ namespace gorc {
                 event->accept(*this);
             }
 
+            if(profile) {
+                profiler.write_report(std::cout, verbs);
+            }
+
             return EXIT_SUCCESS;
         }
 
@@ -172,9 +202,47 @@ namespace gorc {
             state = std::make_unique<cog_scenario_state>(deserialization_constructor,
                                                          mr,
                                                          services);
+            configure_executor(*state->executor);
             std::cout << "LOAD: " << e.key << std::endl;
         }
 
+        void precompile_scripts(cog::compiler &compiler,
+                                virtual_file_system const &vfs,
+                                loader_registry const &loaders,
+                                cog_scenario const &scenario)
+        {
+            auto const &prefixes = loaders.get_loader(cog::script_loader::type).get_prefixes();
+
+            std::vector<cog::script_source> sources;
+            for(auto const &file : scenario.cog_files) {
+                // Missing scripts are reported when the instances are constructed
+                log_capture discarded_diagnostics;
+                try {
+                    auto f = vfs.find(file.cog_filename, prefixes);
+
+                    memory_file source;
+                    std::get<1>(f)->copy_to(source);
+                    sources.emplace_back(file.cog_filename,
+                                         std::string(source.data(), source.size()));
+                }
+                catch(...) {
+                    continue;
+                }
+            }
+
+            compiler.precompile(sources);
+        }
+
+        void configure_executor(cog::executor &executor)
+        {
+            executor.set_fused_tier_enabled(!no_fused_tier);
+            executor.set_fused_tier_threshold(fused_tier_threshold);
+
+            if(profile) {
+                executor.set_profiler(&profiler);
+            }
+        }
+
         void populate_verb_table()
         {
             verbs.add_verb("print", [](char const *s) {
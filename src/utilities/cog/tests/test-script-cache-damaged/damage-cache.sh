@@ -0,0 +1,10 @@
+#!/bin/sh
+# Replaces the last byte of program text in each cache entry with an invalid opcode. Scripts
+# used with this have no string immediates, so each entry ends with an empty relocation table.
+for entry in "$1"/*.cogc; do
+    size=$(wc -c < "$entry")
+    head -c $((size - 9)) "$entry" > "$entry.damaged"
+    printf '\377' >> "$entry.damaged"
+    tail -c 8 "$entry" >> "$entry.damaged"
+    mv "$entry.damaged" "$entry"
+done
@@ -15,6 +15,12 @@ gorc::cogcheck_compiler::cogcheck_compiler(cog::verb_table &verbs,
     return;
 }
 
+bool gorc::cogcheck_compiler::can_cache_scripts() const
+{
+    // Dumps and disassembly are produced by the hooks.
+    return false;
+}
+
 bool gorc::cogcheck_compiler::handle_parsed_ast(cog::ast::translation_unit &tu)
 {
     if(parse_only && dump_ast) {
@@ -10,6 +10,9 @@ namespace gorc {
         bool parse_only = false;
         bool disassemble = false;
 
+    protected:
+        virtual bool can_cache_scripts() const override;
+
     public:
         cogcheck_compiler(cog::verb_table &verbs,
                           cog::constant_table &constants,
@@ -27,6 +27,16 @@ void gorc::disassemble_code(cog::script &s, cog::verb_table &verbs)
         return addr;
     };
 
+    auto print_call_site = [&](size_t addr, std::ostream &os)
+    {
+        maybe_if(s.call_sites.get_range(addr), [&](diagnostic_context_location const *loc) {
+                os << " (" << loc->first_line;
+                os << ":" << loc->first_col;
+                os << "-" << loc->last_line;
+                os << ":" << loc->last_col << ")";
+            });
+    };
+
     memory_file::reader mfr(s.program);
     binary_input_stream r(mfr);
     while(!r.at_end()) {
@@ -78,18 +88,12 @@ void gorc::disassemble_code(cog::script &s, cog::verb_table &verbs)
         case cog::opcode::call:
             line << "call ";
             line << verbs.get_verb(verb_id(binary_deserialize<int>(r))).name;
-            line << " (" << binary_deserialize<int>(r);
-            line << ":" << binary_deserialize<int>(r);
-            line << "-" << binary_deserialize<int>(r);
-            line << ":" << binary_deserialize<int>(r) << ")";
+            print_call_site(line_addr, line);
             break;
         case cog::opcode::callv:
             line << "callv ";
             line << verbs.get_verb(verb_id(binary_deserialize<int>(r))).name;
-            line << " (" << binary_deserialize<int>(r);
-            line << ":" << binary_deserialize<int>(r);
-            line << "-" << binary_deserialize<int>(r);
-            line << ":" << binary_deserialize<int>(r) << ")";
+            print_call_site(line_addr, line);
             break;
         case cog::opcode::ret:
             line << "ret";
@@ -148,6 +152,12 @@ void gorc::disassemble_code(cog::script &s, cog::verb_table &verbs)
         case cog::opcode::le:
             line << "le";
             break;
+        // LCOV_EXCL_START
+        default:
+            // Fused instructions only exist in decoded programs
+            line << "invalid";
+            break;
+        // LCOV_EXCL_STOP
         }
 
         lines.emplace(line_addr, std::make_tuple(line.str(), printed_address));